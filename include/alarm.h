@@ -0,0 +1,132 @@
+#ifndef _ALARM_H_
+#define _ALARM_H_
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "tempstats.h"
+
+// ===================== 温度报警 ======================
+enum AlarmRuleType {
+    ALARM_RULE_HIGH = 0,    ///< ROI 最高温超过门限
+    ALARM_RULE_LOW = 1,     ///< ROI 最低温低于门限
+    ALARM_RULE_RISE = 2,    ///< ROI 最高温的温升速率超过门限
+};
+
+enum AlarmEventType {
+    ALARM_EVENT_RAISE = 0,
+    ALARM_EVENT_CLEAR = 1,
+};
+
+static const int kAlarmRiseSamples = 16;    // 温升速率历史采样数
+static const int kAlarmQueueSize = 256;     // 事件队列容量(2 的幂)
+
+/**
+* @brief 报警规则, 温度单位与 TempInfo_t 相同(kelvin*16)
+*
+* 满足条件连续 raise_frames 帧才报警; 报警后条件回落超过 hysteresis
+* 并连续 clear_frames 帧才解除, 避免在门限附近抖动。
+*/
+struct AlarmRule {
+    int roi;            ///< TempStatsEngine 中的 ROI 序号
+    int type;           ///< 见 AlarmRuleType
+    int threshold;      ///< HIGH/LOW: kelvin*16; RISE: kelvin*16 每秒
+    int hysteresis;     ///< 解除回差, 单位同 threshold
+    int raise_frames;   ///< 报警去抖帧数
+    int clear_frames;   ///< 解除去抖帧数
+    int window_ms;      ///< RISE: 计算温升速率的时间窗
+
+    bool active;        ///< 当前处于报警状态
+    int counter;        ///< 去抖计数
+    int rise_num;       ///< 温升历史采样数
+    int rise_head;
+    int64_t rise_ns[kAlarmRiseSamples];
+    int rise_value[kAlarmRiseSamples];
+
+    AlarmRule() :
+        roi(0),
+        type(ALARM_RULE_HIGH),
+        threshold(0),
+        hysteresis(16),
+        raise_frames(3),
+        clear_frames(5),
+        window_ms(1000),
+        active(false),
+        counter(0),
+        rise_num(0),
+        rise_head(0) {}
+};
+
+/**
+* @brief 报警事件
+*/
+struct AlarmEvent {
+    int rule;           ///< 规则序号
+    int roi;
+    int type;           ///< 见 AlarmRuleType
+    int event;          ///< 见 AlarmEventType
+    int value;          ///< 触发时的温度(kelvin*16)或温升速率(kelvin*16 每秒)
+    Dot_t cord;         ///< 触发时的最值坐标
+    int64_t frame_ns;   ///< 帧到达时间(steady_clock)
+    int64_t emit_ns;    ///< 事件入队时间
+};
+
+/**
+* @brief 单生产者单消费者无锁事件队列: 处理线程入队, UI/上报线程出队
+*/
+struct AlarmQueue {
+    AlarmEvent events[kAlarmQueueSize];
+    std::atomic<uint32_t> head;     ///< 下一个写入位置, 只由生产者修改
+    std::atomic<uint32_t> tail;     ///< 下一个读取位置, 只由消费者修改
+    std::atomic<uint32_t> dropped;  ///< 队列满时丢弃的事件数
+
+    AlarmQueue() : head(0), tail(0), dropped(0) {}
+};
+
+bool alarmQueuePush(AlarmQueue& queue, const AlarmEvent& event);
+bool alarmQueuePop(AlarmQueue& queue, AlarmEvent& event);
+
+/**
+* @brief 报警引擎, 规则表与测温统计在同一次遍历中求值
+*/
+struct AlarmEngine {
+    std::vector<AlarmRule> rules;
+    AlarmQueue queue;
+    int64_t latency_last_ns;    ///< 最近一帧从到达到完成报警判断的延迟
+    int64_t latency_max_ns;
+    int64_t latency_sum_ns;
+    uint32_t latency_count;
+
+    AlarmEngine() :
+        latency_last_ns(0),
+        latency_max_ns(0),
+        latency_sum_ns(0),
+        latency_count(0) {}
+};
+
+/**
+* @brief 添加规则, 返回规则序号
+*/
+int alarmAddRule(AlarmEngine& engine, const AlarmRule& rule);
+
+/**
+* @brief 添加整帧最高温报警, 在统计引擎中追加一个全帧 ROI
+*/
+int alarmAddFrameHigh(AlarmEngine& engine, TempStatsEngine& stats, int threshold);
+
+/**
+* @brief 统计所有 ROI 并求值全部规则, 状态变化时事件入队
+*
+* @param[in] temp 温度帧(CV_16UC1, kelvin*16)
+* @param[in] frame_ns 帧到达时间(std::chrono::steady_clock 纳秒), 用于温升速率和延迟统计
+*/
+void alarmEvaluate(AlarmEngine& engine, TempStatsEngine& stats, const cv::Mat& temp, int64_t frame_ns);
+
+/**
+* @brief 当前 steady_clock 时间(纳秒)
+*/
+int64_t alarmNowNs();
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef _ALGORITHM_H_
+#define _ALGORITHM_H_
+
+#include <opencv2/opencv.hpp>
+
+// ===================== 时域降噪 ======================
+/**
+* @brief 运动自适应递归时域降噪参数
+*
+* 当前帧权重 w 由逐像素帧差 d 决定(Q8, 256 = 1.0):
+* d <= motion_low 时 w = static_weight, d >= motion_high 时 w = 256(直接输出当前帧),
+* 中间线性过渡。
+*/
+struct TemporalDenoiseParams {
+    int motion_low;     ///< 静止判定帧差阈值
+    int motion_high;    ///< 运动判定帧差阈值
+    int static_weight;  ///< 静止像素的当前帧权重(Q8, 1~256)
+
+    TemporalDenoiseParams() :
+        motion_low(4),
+        motion_high(24),
+        static_weight(64) {}
+};
+
+/**
+* @brief 时域降噪状态，仅保存一帧 Q8 定点历史(CV_16U)，不引入额外帧延迟
+*/
+struct TemporalDenoiseState {
+    TemporalDenoiseParams params;
+    cv::Mat history;    ///< 递归滤波历史帧, 与输入同尺寸同通道数, 值为 像素<<8
+    bool valid;         ///< false 时下一帧直接作为历史帧重新开始
+
+    TemporalDenoiseState() : valid(false) {}
+};
+
+/**
+* @brief 丢弃时域历史(FFC/快门事件、算法切换时调用)
+*/
+void resetTemporalDenoise(TemporalDenoiseState& state);
+
+/**
+* @brief 运动自适应递归时域降噪, 单次融合遍历完成帧差、权重计算和混合
+*
+* @param[in] state 时域状态, 首帧或复位后输出等于输入
+* @param[in] src 8位输入图像(任意通道数)
+* @param[out] dst 8位输出图像, 可与 src 相同
+*/
+void temporalDenoise(TemporalDenoiseState& state, const cv::Mat& src, cv::Mat& dst);
+
+// ===================== 场景非均匀校正 ======================
+/**
+* @brief 基于场景的非均匀校正(SBNUC)参数
+*
+* 约束 LMS: 以校正后像素与其 4 邻域均值之差为误差, 只在场景运动且误差较小
+* (不是场景边缘)的像素上按 2^-lms_shift 步长更新偏移, 偏移幅度受限且整体均值保持为 0。
+*/
+struct SbnucParams {
+    bool enabled;           ///< 关闭时直接输出输入帧
+    int lms_shift;          ///< 学习率 2^-lms_shift, 5~12
+    int motion_threshold;   ///< 帧差大于该值的像素才更新
+    int edge_threshold;     ///< 误差绝对值小于该值(灰度)才更新, 避免把场景边缘学进偏移表
+    int max_offset;         ///< 偏移绝对值上限(灰度)
+    int min_motion_permille;///< 运动像素少于该千分比时整帧不更新(相机静止), 避免鬼影
+
+    SbnucParams() :
+        enabled(true),
+        lms_shift(6),
+        motion_threshold(4),
+        edge_threshold(16),
+        max_offset(24),
+        min_motion_permille(20) {}
+};
+
+/**
+* @brief SBNUC 状态, 偏移表放在 PipelineArena 中跨帧保存
+*/
+struct SbnucState {
+    SbnucParams params;
+    cv::Mat offset;     ///< 逐像素偏移(CV_16S, Q8), 输出 = 输入 - 偏移
+    cv::Mat gray;       ///< 当前帧灰度
+    cv::Mat prev;       ///< 上一帧灰度(未校正)
+    cv::Mat motion;     ///< 运动掩码
+    bool valid;         ///< false 时偏移表清零重新学习
+    bool updated;       ///< 上一帧是否更新了偏移表
+
+    SbnucState() : valid(false), updated(false) {}
+};
+
+/**
+* @brief 清空偏移表(快门 FFC 完成后调用, FFC 已消除漂移)
+*/
+void resetSbnuc(SbnucState& state);
+
+/**
+* @brief 场景非均匀校正: 按当前偏移表校正并在同一遍中更新偏移表
+*
+* 三通道输入按亮度估计偏移, 同一偏移作用于三个通道。
+*
+* @param[in] state SBNUC 状态
+* @param[in] src 8位 BGR 或单通道图像
+* @param[out] dst 校正结果, 可与 src 相同
+*/
+void sceneBasedNuc(SbnucState& state, const cv::Mat& src, cv::Mat& dst);
+
+/**
+* @brief 粗糙度指标 (sum|dx| + sum|dy|) / sum|I|, 残余固定图案噪声越小值越低
+*/
+double nucRoughness(const cv::Mat& img);
+
+// ===================== CLAHE 与边缘算子 ======================
+// 各模式 CLAHE 限制对比度参数, 块大小均为 1(即全局直方图)
+static const double kClaheClipDefault = 2;
+static const double kClaheClipSobelPrewitt = 3.5;
+static const double kClaheClipKirsch = 1.3;
+static const double kClaheClipFreiChen = 3;
+
+void do_CLAHE(cv::Mat& src, cv::Mat& dst);
+void do_CLAHE_sobelprewitt(cv::Mat& src, cv::Mat& dst);
+void do_CLAHE_edge(cv::Mat& src, cv::Mat& dst);
+void do_CLAHE_edge_Frei_Chen(cv::Mat& src, cv::Mat& dst);
+
+/**
+* @brief Sobel 与 Prewitt 梯度幅值的平均(浮点实现)
+*/
+cv::Mat SobelPrewitt(cv::Mat img);
+
+/**
+* @brief 8 方向 Kirsch 最大响应(浮点实现)
+*/
+cv::Mat Kirsch(cv::Mat img);
+
+// ===================== 非锐化掩模 ======================
+/**
+* @brief 定点可分离非锐化掩模, 输出 src + strength*(src - blur)
+*
+* 高斯模糊使用 Q8 整数系数, 竖直/水平两次卷积与锐化合并在同一次逐行遍历中完成,
+* 中间结果只保存在行缓冲内。常用 (ksize, sigma) 组合使用预计算系数表,
+* 核尺寸在编译期展开(支持 1~15)。边界按 BORDER_REPLICATE 处理。
+*
+* @param[in] src 8位单通道或多通道图像
+* @param[out] dst 输出图像, 与 src 同尺寸同类型
+* @param[in] sigma 高斯标准差, <=0 时按 OpenCV 规则由 ksize 推算
+* @param[in] strength 锐化强度, >=0
+* @param[in] ksize 高斯核尺寸, 奇数
+* @param[in] luma_only 对 BGR 输入只锐化亮度, 细节量同时叠加到三个通道
+*/
+void unsharpMaskFixed(const cv::Mat& src, cv::Mat& dst, double sigma, double strength,
+                      int ksize, bool luma_only = false);
+
+// ===================== Frei-Chen 边缘 ======================
+enum FreiChenMode {
+    FREI_CHEN_FAST = 0,     ///< 定点梯度幅值(默认, 单次遍历)
+    FREI_CHEN_EDGE = 1,     ///< 9 基完整投影, 边缘子空间 sqrt(M/S) (质量模式)
+    FREI_CHEN_LINE = 2,     ///< 9 基完整投影, 线子空间 sqrt(L/S) (质量模式)
+};
+
+/**
+* @brief 浮点 Frei-Chen 梯度幅值(filter2D + magnitude), 作为定点实现的参考
+*/
+cv::Mat Frei_Chen(cv::Mat img);
+
+/**
+* @brief 定点 Frei-Chen 边缘检测
+*
+* FREI_CHEN_FAST 模式下 sqrt(2) 由 1/sqrt(2) 的 Q15 常数经 mul_hi 得到, gx/gy 保持 Q4 精度的 16 位整数,
+* 幅值用两段线性 max/min 近似(误差约 ±1.2%), 一次遍历直接饱和输出 8 位结果。
+* 边界按 filter2D 默认的 BORDER_REFLECT_101 处理。
+*
+* @param[in] src 8位单通道图像
+* @param[out] dst 8位单通道边缘图
+* @param[in] mode 见 FreiChenMode
+*/
+void freiChenFixed(const cv::Mat& src, cv::Mat& dst, int mode = FREI_CHEN_FAST);
+
+// ===================== 融合流水线 ======================
+enum EdgeOperator {
+    EDGE_SOBEL_PREWITT = 0,
+    EDGE_KIRSCH = 1,
+    EDGE_FREI_CHEN = 2,
+};
+
+/**
+* @brief 边缘高亮叠加参数
+*
+* 输出 = (底图*(255-e) + color*e)/255, e 为边缘强度; e > threshold 时直接输出 color。
+* 底图为黑色(默认, 即原 SobelPrewitt 模式的绿色边缘图)或原始亮度。
+*/
+struct EdgeOverlayParams {
+    bool enabled;       ///< 由主循环按是否有彩色输出端设置(PipelineArena::color_sink), 关闭时只输出单通道边缘图
+    int threshold;      ///< 边缘强度高于该值的像素直接显示为高亮颜色
+    uchar color[3];     ///< 高亮颜色(BGR)
+    bool blend_luma;    ///< true: 叠加在原始亮度上; false: 黑底
+
+    EdgeOverlayParams() :
+        enabled(true),
+        threshold(70),
+        blend_luma(false) {
+        color[0] = 0;
+        color[1] = 255;
+        color[2] = 0;
+    }
+};
+
+/**
+* @brief 单独的边缘高亮叠加, 一次遍历写出 BGR 图像
+*
+* @param[in] edge 8位单通道边缘图
+* @param[in] luma 原始亮度(8位单通道), 仅 blend_luma 时使用
+* @param[out] dst BGR 输出
+* @param[in] params 叠加参数
+*/
+void edgeOverlay(const cv::Mat& edge, const cv::Mat& luma, cv::Mat& dst, const EdgeOverlayParams& params);
+
+/**
+* @brief 融合流水线跨帧缓冲(灰度帧), 放在 PipelineArena 中复用
+*/
+struct FusedEdgeState {
+    cv::Mat gray;
+};
+
+/**
+* @brief 由直方图计算块大小为 1 的 CLAHE 映射表, 与 cv::CLAHE 的裁剪/重分配规则一致
+*
+* @param[in] hist 256 级灰度直方图
+* @param[in] total 像素总数
+* @param[in] clip_limit 限制对比度参数(同 createCLAHE)
+* @param[out] lut 256 项映射表
+*/
+void claheGlobalLut(const int* hist, int total, double clip_limit, uchar* lut);
+
+/**
+* @brief 融合的 BGR2GRAY -> CLAHE -> 3x3 边缘算子流水线
+*
+* 第一遍按行带完成灰度转换与直方图统计, 第二遍按行带并行地查表、
+* 计算边缘并写出结果, 中间结果只在三行环形缓冲中(缓存内)流转。
+* Kirsch 为整数精确实现, 与浮点链路逐像素一致。
+*
+* @param[in] state 灰度帧缓冲
+* @param[in] frame BGR 或单通道 8 位输入
+* @param[out] dst 8 位单通道边缘图; 开启叠加时为 BGR 高亮图
+* @param[in] op 见 EdgeOperator
+* @param[in] clip_limit CLAHE 限制对比度参数
+* @param[in] overlay 非空且 enabled 时在同一遍中完成高亮着色
+*/
+void fusedClaheEdge(FusedEdgeState& state, const cv::Mat& frame, cv::Mat& dst, int op,
+                    double clip_limit, const EdgeOverlayParams* overlay = NULL);
+
+// ===================== 2 倍放大 ======================
+enum UpscaleMode {
+    UPSCALE_NEAREST = 0,    ///< 最近邻
+    UPSCALE_BILINEAR = 1,   ///< 双线性
+    UPSCALE_EDGE = 2,       ///< 边缘导向(默认)
+};
+
+/**
+* @brief 2 倍放大, 输出像素 (2y, 2x) 与输入 (y, x) 对齐
+*
+* UPSCALE_EDGE 下水平/竖直半像素点用 4 点三次插值 (-1, 9, 9, -1)/16,
+* 中心点沿差值较小的对角线插值(两条对角线相近时取四点平均), 避免斜边锯齿和模糊。
+* 按行带并行, 每行带只保留四行带边界扩展的输入行。边界按 BORDER_REPLICATE 处理。
+*
+* @param[in] src 8位单通道或三通道图像
+* @param[out] dst 2 倍尺寸输出, 可与 src 相同
+* @param[in] mode 见 UpscaleMode
+*/
+void upscale2x(const cv::Mat& src, cv::Mat& dst, int mode = UPSCALE_EDGE);
+
+#endif
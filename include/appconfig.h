@@ -0,0 +1,119 @@
+#ifndef _APPCONFIG_H_
+#define _APPCONFIG_H_
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#include "algorithm.h"
+
+// ===================== 运行配置 ======================
+/**
+* @brief 设备配置, 只在启动时读取(修改后需重启)
+*/
+struct DeviceConfig {
+    std::string device;
+    int width;
+    int height;
+    int info_height;            ///< 图像后附加的 info 行行数, 0 为不解析, -1 为按设备支持的帧尺寸自动识别
+    std::string dpc_map_path;
+    int usb_vid;                ///< 命令通道的 USB VID/PID, 0 为从 sysfs 读取 device 所属 USB 设备
+    int usb_pid;
+    std::string palette_dir;    ///< 设备伪彩在本地没有同名色表时, 从该目录加载 <名称>.pal
+    int temp_frame;             ///< 1 为图像后紧跟同尺寸的 16 位 NUC 帧(测温数据), 在 info 行之前
+    std::string nuc_table_path; ///< NUC_T 表文件, 为空或加载失败时不做温度换算
+
+    DeviceConfig() :
+        device("/dev/video0"),
+        width(384),
+        height(288),
+        info_height(-1),
+        dpc_map_path("./dpc_map.txt"),
+        usb_vid(0),
+        usb_pid(0),
+        palette_dir("./palettes"),
+        temp_frame(0) {}
+};
+
+/**
+* @brief 可热更新的调参块, 发布后只读, 更新时整块替换
+*/
+struct TuningParams {
+    double clip_default;        ///< 各算法的 CLAHE 限制对比度参数
+    double clip_sobel_prewitt;
+    double clip_kirsch;
+    double clip_frei_chen;
+    int tile_size;              ///< 默认算法的 CLAHE 块大小(融合边缘流水线固定为 1)
+    double unsharp_sigma;
+    double unsharp_strength;
+    int unsharp_ksize;
+    int edge_threshold;         ///< SobelPrewitt 高亮阈值, 见 EdgeOverlayParams
+    double display_factor;      ///< 显示放大倍数
+    std::string screenshot_path;    ///< 截图目录, 不存在时保存截图前创建
+    uint32_t version;           ///< 每次成功加载加一
+
+    TuningParams() :
+        clip_default(kClaheClipDefault),
+        clip_sobel_prewitt(kClaheClipSobelPrewitt),
+        clip_kirsch(kClaheClipKirsch),
+        clip_frei_chen(kClaheClipFreiChen),
+        tile_size(1),
+        unsharp_sigma(1.5),
+        unsharp_strength(1.0),
+        unsharp_ksize(5),
+        edge_threshold(70),
+        display_factor(2),
+        screenshot_path("./fig"),
+        version(0) {}
+};
+
+/**
+* @brief 配置文件与当前生效的参数块
+*
+* 调参块通过 std::atomic_load/atomic_store 发布: 读取方取得的块在其持有期间不会被修改或释放,
+* 主循环每帧开始时取一次, 整帧使用同一组参数。
+*/
+struct AppConfig {
+    std::string path;
+    DeviceConfig device;
+    std::shared_ptr<const TuningParams> tuning;
+    int inotify_fd;             ///< 监视配置文件所在目录, -1 为未监视
+    uint32_t reloads;
+    uint32_t errors;            ///< 解析或校验失败次数(失败时保留原参数)
+
+    AppConfig();
+    ~AppConfig();
+};
+
+/**
+* @brief 解析 JSON 配置, 缺少的项取默认值
+*
+* @return 语法错误或取值超出范围时返回 false, 并输出原因
+*/
+bool appConfigParse(const std::string& text, DeviceConfig& device, TuningParams& tuning);
+
+/**
+* @brief 启动时加载; 文件不存在时使用默认值并返回 true
+*/
+bool appConfigLoad(AppConfig& config, const std::string& path);
+
+/**
+* @brief 用 inotify 监视配置文件(监视所在目录, 编辑器以改名方式保存时同样生效)
+*/
+bool appConfigWatch(AppConfig& config);
+
+/**
+* @brief 在帧边界调用: 不阻塞地读取 inotify 事件, 配置文件有变化时重新加载并发布新的调参块
+*
+* 设备配置的变化只提示需要重启, 不生效。
+*
+* @return 是否发布了新的调参块
+*/
+bool appConfigPoll(AppConfig& config);
+
+/**
+* @brief 当前生效的调参块
+*/
+std::shared_ptr<const TuningParams> appConfigTuning(const AppConfig& config);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+/**
+* @brief 离线基准与容差检查(sample --bench), 不需要连接相机
+*
+* 在合成帧上对比定点/融合实现与原浮点实现的输出差异, 并打印
+* 384x288(传感器分辨率) 与 768x576(2 倍显示分辨率) 下的单帧耗时。
+*
+* @return 0 全部在容差内, 1 存在超出容差的项
+*/
+int runBenchmarks();
+
+#endif
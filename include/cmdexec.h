@@ -0,0 +1,160 @@
+#ifndef _CMDEXEC_H_
+#define _CMDEXEC_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "libircmd.h"
+
+// ===================== 命令通道执行器 ======================
+enum CmdPriority {
+    CMD_PRIORITY_URGENT = 0,    ///< FFC/快门
+    CMD_PRIORITY_READ = 1,      ///< 报警、测温等读取
+    CMD_PRIORITY_UI = 2,        ///< 界面参数调整
+    CMD_PRIORITY_NUM = 3,
+};
+
+/**
+* @brief 合并键, 队列中已有相同键且未开始执行的命令时合并为一条
+*/
+enum CmdKey {
+    CMD_KEY_NONE = 0,           ///< 不合并
+    CMD_KEY_FFC,
+    CMD_KEY_PALETTE,
+    CMD_KEY_CONTRAST,
+    CMD_KEY_BRIGHTNESS,
+    CMD_KEY_FRAME_TEMP,
+    CMD_KEY_DEV_PARAM_LOAD,
+    CMD_KEY_DEV_PARAM = 64,     ///< 设备参数缓存写入, 加 DevParamId
+    CMD_KEY_USER = 256,         ///< 调用者自定义键从这里开始
+};
+
+static const int kCmdQueueSize = 64;    // 等待执行的命令上限(各优先级合计)
+
+/**
+* @brief 命令执行结果, 读取类命令的输出写入对应字段
+*/
+struct CmdResult {
+    IrlibError_e error;
+    int value;                      ///< 整型读取结果
+    uint32_t data;                  ///< 32 位读取结果(如实时状态)
+    float temperature;              ///< 摄氏度读取结果(如机芯温度)
+    MaxMinTempInfo_t frame_temp;    ///< basic_frame_temp_info_get
+
+    CmdResult() :
+        error(IRLIB_SUCCESS),
+        value(0),
+        data(0),
+        temperature(0) {}
+};
+
+typedef std::function<IrlibError_e(IrcmdHandle_t*, CmdResult&)> CmdFunc;
+typedef std::function<void(const CmdResult&)> CmdCallback;
+
+/**
+* @brief 等待执行的命令
+*
+* 合并时 replace 为 true(设置类)用新命令替换旧命令, 只写入最后一次的值;
+* 为 false(读取类、FFC)保留旧命令, 新调用者共享同一次执行结果。
+* 两种方式下所有调用者的回调都会被调用。
+*/
+struct CmdRequest {
+    int priority;
+    int key;
+    bool replace;
+    CmdFunc func;
+    std::vector<CmdCallback> callbacks;
+    int64_t submit_ns;              ///< 首次提交时间(steady_clock)
+};
+
+/**
+* @brief 命令执行器: 独占 IrcmdHandle_t, 在单独线程中按优先级串行执行命令
+*
+* 提交只在队列上加锁, 不等待总线传输, 可在采集线程中调用。
+* 回调在执行器线程中调用, 不应阻塞。
+*/
+struct CmdExecutor {
+    IrcmdHandle_t* handle;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<CmdRequest> queues[CMD_PRIORITY_NUM];
+    int pending;                    ///< 各队列命令数合计
+    bool running;
+
+    // 统计(加锁访问)
+    uint32_t submitted;
+    uint32_t coalesced;             ///< 被合并的提交数
+    uint32_t executed;
+    uint32_t rejected;              ///< 队列满或未启动时拒绝的提交数
+    uint32_t failed;                ///< 执行返回错误的命令数
+    int64_t busy_ns;                ///< 命令通道占用时间合计
+    int64_t start_ns;               ///< 执行器启动时间
+    int64_t wait_max_ns[CMD_PRIORITY_NUM];  ///< 各优先级从提交到开始执行的最大等待
+
+    CmdExecutor() :
+        handle(NULL),
+        pending(0),
+        running(false),
+        submitted(0),
+        coalesced(0),
+        executed(0),
+        rejected(0),
+        failed(0),
+        busy_ns(0),
+        start_ns(0)
+    {
+        for (int i = 0; i < CMD_PRIORITY_NUM; i++) {
+            wait_max_ns[i] = 0;
+        }
+    }
+    ~CmdExecutor();     ///< 仍在运行时先停止
+};
+
+/**
+* @brief 启动执行器线程, 之后 handle 只能由执行器使用
+*/
+void cmdExecStart(CmdExecutor& exec, IrcmdHandle_t* handle);
+
+/**
+* @brief 等待正在执行的命令完成后停止线程, 未执行的命令以 IRCMD_CMD_EXECUTE_FAILED 回调
+*
+* 不能在命令回调中调用
+*/
+void cmdExecStop(CmdExecutor& exec);
+
+/**
+* @brief 提交命令
+*
+* @param[in] key 见 CmdKey, CMD_KEY_NONE 不合并
+* @param[in] replace 合并方式, 见 CmdRequest
+*
+* @return 队列满或执行器未启动时返回 false, 此时不调用回调
+*/
+bool cmdExecSubmit(CmdExecutor& exec, int priority, int key, bool replace,
+                   const CmdFunc& func, const CmdCallback& callback = CmdCallback());
+
+/**
+* @brief 提交命令并返回 future, 提交被拒绝时立即返回 IRCMD_CMD_EXECUTE_FAILED
+*/
+std::future<CmdResult> cmdExecCall(CmdExecutor& exec, int priority, int key, bool replace, const CmdFunc& func);
+
+/**
+* @brief 命令通道占用率(0-1): 启动以来执行命令的时间占比
+*/
+double cmdExecOccupancy(CmdExecutor& exec);
+
+// 常用命令
+std::future<CmdResult> cmdExecFfcUpdate(CmdExecutor& exec);
+bool cmdExecSetPalette(CmdExecutor& exec, int index, const CmdCallback& callback = CmdCallback());
+bool cmdExecSetContrast(CmdExecutor& exec, int level, const CmdCallback& callback = CmdCallback());
+bool cmdExecSetBrightness(CmdExecutor& exec, int level, const CmdCallback& callback = CmdCallback());
+bool cmdExecGetFrameTemp(CmdExecutor& exec, const CmdCallback& callback);
+
+#endif
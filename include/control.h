@@ -0,0 +1,50 @@
+#ifndef _CONTROL_H_
+#define _CONTROL_H_
+
+#include <string>
+
+#include "appconfig.h"
+#include "libircam.h"
+#include "libircmd.h"
+#include "libiruvc.h"
+
+// ===================== 命令通道 ======================
+/**
+* @brief 与视频流并行的 USB 命令通道(libiruvc + libircmd)
+*
+* 视频走 V4L2, 命令走同一设备的 USB 控制端点; 打开后 cmd 可交给 CmdExecutor 独占使用。
+*/
+struct ControlChannel {
+    IrControlHandle_t* control;
+    IruvcHandle_t* uvc;
+    IrcmdHandle_t* cmd;         ///< NULL 表示未打开
+    UvcConDevParam_t con_param;
+
+    ControlChannel() :
+        control(NULL),
+        uvc(NULL),
+        cmd(NULL),
+        con_param() {}
+};
+
+/**
+* @brief 从 sysfs 读取 V4L2 设备节点所属 USB 设备的 VID/PID
+* @param video_dev 设备节点, 如 /dev/video0(可为符号链接)
+* @return 读取成功返回 true
+*/
+bool controlUsbIds(const std::string& video_dev, unsigned& vid, unsigned& pid);
+
+/**
+* @brief 打开命令通道
+*
+* VID/PID 取 dev.usb_vid/usb_pid, 为 0 时按 dev.device 从 sysfs 读取。
+* @return 失败时打印原因并释放已创建的句柄, 返回 false
+*/
+bool controlOpen(ControlChannel& channel, const DeviceConfig& dev);
+
+/**
+* @brief 关闭命令通道, 未打开时无操作
+*/
+void controlClose(ControlChannel& channel);
+
+#endif
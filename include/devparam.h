@@ -0,0 +1,134 @@
+#ifndef _DEVPARAM_H_
+#define _DEVPARAM_H_
+
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#include "cmdexec.h"
+
+// ===================== 设备参数缓存 ======================
+enum DevParamId {
+    DEV_PARAM_GAIN = 0,
+    DEV_PARAM_PALETTE,
+    DEV_PARAM_BRIGHTNESS,
+    DEV_PARAM_CONTRAST,
+    DEV_PARAM_DETAIL,
+    DEV_PARAM_NOISE_REDUCTION,
+    DEV_PARAM_AGC,
+    DEV_PARAM_SCENE_MODE,
+    DEV_PARAM_MIRROR_FLIP,
+    DEV_PARAM_AUTO_FFC,
+    DEV_PARAM_NUM,
+};
+
+typedef IrlibError_e (*DevParamGetter)(IrcmdHandle_t* handle, int* value);
+typedef IrlibError_e (*DevParamSetter)(IrcmdHandle_t* handle, int value);
+typedef IrlibError_e (*DevParamRestore)(IrcmdHandle_t* handle, int type);
+
+/**
+* @brief 参数对应的读写命令
+*/
+struct DevParamDesc {
+    const char* name;
+    DevParamGetter get;
+    DevParamSetter set;
+};
+
+extern const DevParamDesc kDevParamTable[DEV_PARAM_NUM];
+
+struct DevParamEntry {
+    int value;
+    bool valid;             ///< 已从设备读取或写入成功
+    int pending;            ///< 已提交未完成的写入数
+    int pending_value;      ///< 最近一次提交的写入值
+    uint32_t version;       ///< 值每变化一次加 1
+};
+
+/**
+* @brief 参数变化通知, 在命令执行器线程中调用
+*/
+typedef std::function<void(int id, int value)> DevParamListener;
+
+struct DevParamSub {
+    int token;
+    int id;                         ///< -1 订阅全部参数
+    DevParamListener listener;
+};
+
+/**
+* @brief 设备参数缓存
+*
+* 启动时一次批量读取全部参数, 之后读取直接返回缓存值; 写入经命令执行器
+* 写到设备, 设备确认后更新缓存并通知订阅者。恢复默认值或设备复位后
+* 需调用 devParamInvalidate 并重新加载。
+*/
+struct DevParamCache {
+    CmdExecutor* exec;
+    const DevParamDesc* table;      ///< 读写命令表, 默认 kDevParamTable
+    DevParamRestore restore;        ///< 默认 basic_restore_default_data
+    std::mutex mutex;
+    DevParamEntry entries[DEV_PARAM_NUM];
+    std::vector<DevParamSub> subs;
+
+    // 统计(加锁访问)
+    uint32_t hits;                  ///< 由缓存返回的读取数
+    uint32_t misses;                ///< 缓存无效时的读取数
+    uint32_t device_reads;          ///< 实际发往设备的读取命令数
+    uint32_t device_writes;         ///< 实际发往设备的写入命令数
+    uint32_t write_errors;
+    int next_token;
+
+    DevParamCache();
+};
+
+const char* devParamName(int id);
+
+/**
+* @brief 关联命令执行器, 加载前调用
+*/
+void devParamAttach(DevParamCache& cache, CmdExecutor* exec);
+
+/**
+* @brief 在执行器上一次连续读取全部参数(读取优先级), 读取失败的参数保持无效
+*
+* @return future 的 value 为成功读取的参数数
+*/
+std::future<CmdResult> devParamLoad(DevParamCache& cache);
+
+/**
+* @brief 读取缓存值, 不访问设备
+*
+* @return 缓存无效(未加载或已失效)时返回 false
+*/
+bool devParamGet(DevParamCache& cache, int id, int& value);
+
+/**
+* @brief 写入设备(界面优先级, 同一参数的连续写入合并为最后一次)
+*
+* 与缓存值相同且没有未完成的写入时不发送命令, 直接在调用线程中回调。
+* 设备确认后更新缓存。
+*/
+bool devParamSet(DevParamCache& cache, int id, int value, const CmdCallback& callback = CmdCallback());
+
+/**
+* @brief 所有参数置为无效(设备复位后调用), 之后需重新加载
+*/
+void devParamInvalidate(DevParamCache& cache);
+
+/**
+* @brief 恢复默认值(basic_restore_type_e)并重新加载参数, 两步在同一条命令中完成
+*/
+std::future<CmdResult> devParamRestoreDefault(DevParamCache& cache, int type);
+
+/**
+* @brief 订阅参数变化, id 为 -1 时订阅全部参数
+*
+* @return 用于取消订阅的标识
+*/
+int devParamSubscribe(DevParamCache& cache, int id, const DevParamListener& listener);
+void devParamUnsubscribe(DevParamCache& cache, int token);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef _DPC_H_
+#define _DPC_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// ===================== 坏点校正 ======================
+/**
+* @brief 坏点检测参数
+*
+* 标定窗口内逐帧比较每个像素与 8 邻域中第二大/第二小值的差, 超过 threshold 记一次命中;
+* 用第二极值而非最大/最小值, 使相邻成对的坏点也能检出, 同时不把物体角点判为坏点。
+*/
+struct DpcParams {
+    int calib_frames;   ///< 标定窗口帧数
+    int threshold;      ///< 偏离邻域的灰度阈值
+    int min_hits;       ///< 命中次数达到该值判为(闪烁)坏点
+    int stuck_hits;     ///< 命中次数达到该值判为常亮/常暗坏点
+
+    DpcParams() :
+        calib_frames(32),
+        threshold(24),
+        min_hits(4),
+        stuck_hits(29) {}
+};
+
+enum DpcDefectType {
+    DPC_STUCK = 0,      ///< 常亮/常暗
+    DPC_BLINKING = 1,   ///< 闪烁
+};
+
+/**
+* @brief 坏点, 按 index 升序保存
+*/
+struct DpcDefect {
+    uint32_t index;     ///< y * width + x
+    uint8_t neighbours; ///< 可用于校正的邻域(在图内且不是坏点), bit k 对应 8 邻域第 k 个(左上起顺时针)
+    uint8_t type;       ///< 见 DpcDefectType
+};
+
+/**
+* @brief 坏点表与标定状态, 放在 PipelineArena 中跨帧保存
+*/
+struct DpcState {
+    DpcParams params;
+    int width;
+    int height;
+    std::vector<DpcDefect> defects;     ///< 坏点表, 校正时逐个处理
+
+    int calib_remaining;    ///< 标定剩余帧数, 0 表示未在标定
+    cv::Mat hits;           ///< 标定命中计数(CV_16U)
+    cv::Mat gray;           ///< 标定用灰度缓冲
+
+    DpcState() :
+        width(0),
+        height(0),
+        calib_remaining(0) {}
+};
+
+/**
+* @brief 开始统计标定, 之后 calib_frames 帧内调用 dpcAccumulate
+*
+* 标定时相机应对准均匀场景(或保持场景运动), 避免细小静止目标被判为坏点。
+*/
+void dpcStartCalibration(DpcState& state);
+
+/**
+* @brief 累积一帧标定数据, 最后一帧完成后生成坏点表
+*
+* @param[in] frame 未经校正的 8 位 BGR 或单通道帧
+* @return 本帧完成标定时返回 true
+*/
+bool dpcAccumulate(DpcState& state, const cv::Mat& frame);
+
+/**
+* @brief 坏点原地替换为可用邻域的中值, 开销只与坏点数有关
+*
+* 帧尺寸与坏点表不一致时不做处理。
+*/
+void dpcCorrect(const DpcState& state, cv::Mat& frame);
+
+/**
+* @brief 保存/加载坏点表, 文本格式: 首行 "DPC 宽 高 个数", 之后每行 "x y 类型"
+*
+* 个数超过像素数或类型不是 DpcDefectType 时加载失败, 不修改 state; 越界坐标跳过。
+*/
+bool dpcSave(const DpcState& state, const std::string& path);
+bool dpcLoad(DpcState& state, const std::string& path);
+
+#endif
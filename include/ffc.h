@@ -0,0 +1,80 @@
+#ifndef _FFC_H_
+#define _FFC_H_
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "framemeta.h"
+#include "libircmd.h"
+
+// ===================== FFC/快门检测 ======================
+/**
+* @brief FFC 阶段
+*/
+enum FfcPhase {
+    FFC_IDLE = 0,       ///< 正常出图
+    FFC_ACTIVE = 1,     ///< 快门闭合或相机冻结输出
+    FFC_SETTLING = 2,   ///< 快门刚打开, 等待图像稳定
+};
+
+/**
+* @brief FFC 检测参数
+*/
+struct FfcGuardParams {
+    int settle_frames;      ///< 快门打开后继续跳过的帧数
+    int max_hold_frames;    ///< 连续判为 FFC 的最大帧数, 超过后强制恢复(静止测试图等误判时不会一直冻结)
+
+    FfcGuardParams() :
+        settle_frames(2),
+        max_hold_frames(50) {}
+};
+
+/**
+* @brief FFC 检测状态, 放在 PipelineArena 中
+*
+* 三个来源任一成立即判为 FFC:
+* info 行帧类型为 FREEZE_IMAGE; 轮询线程写入的快门状态为闭合;
+* 原始帧与上一帧逐字节相同(相机在 FFC 期间重复输出冻结帧, 有时域噪声的实时帧不会完全相同)。
+*/
+struct FfcGuard {
+    FfcGuardParams params;
+    std::atomic<int> shutter;   ///< adv_shutter_status_get 的结果(adv_shutter_status_e), 由轮询线程写入
+    int phase;                  ///< 见 FfcPhase
+    int settle_remaining;       ///< SETTLING 阶段剩余帧数
+    int hold_frames;            ///< 本次 FFC 已持续的帧数
+    bool finished;              ///< 本帧结束了一次 FFC(调用方据此清空 SBNUC 偏移表等)
+    int ffc_count;              ///< 检测到的 FFC 次数
+    uint64_t frame_hash;        ///< 上一帧原始数据哈希
+    bool hash_valid;
+    cv::Mat last_output;        ///< 最近一帧正常的显示输出(不含 UI), FFC 期间重复显示
+
+    FfcGuard() :
+        shutter(ADV_SHUTTER_STATUS_INVALID),
+        phase(FFC_IDLE),
+        settle_remaining(0),
+        hold_frames(0),
+        finished(false),
+        ffc_count(0),
+        frame_hash(0),
+        hash_valid(false) {}
+};
+
+/**
+* @brief 更新快门状态, 可在轮询线程中调用(热路径外 adv_shutter_status_get)
+*/
+void ffcGuardSetShutter(FfcGuard& guard, int status);
+
+/**
+* @brief 每帧调用一次, 判断当前帧是否处于 FFC
+*
+* @param[in] raw 原始帧数据(YUYV 图像部分, 不含 info 行)
+* @param[in] size 原始帧字节数
+* @param[in] meta 本帧元数据, 有 info 行时读取帧类型
+* @return 见 FfcPhase, 非 FFC_IDLE 时调用方应跳过增强并重复显示 last_output,
+*         且不更新任何跨帧状态(时域降噪、SBNUC、坏点标定)
+*/
+int ffcGuardUpdate(FfcGuard& guard, const uchar* raw, size_t size, FrameMeta& meta);
+
+#endif
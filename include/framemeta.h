@@ -0,0 +1,53 @@
+#ifndef _FRAMEMETA_H_
+#define _FRAMEMETA_H_
+
+#include <stdint.h>
+
+#include "libir_infoparse.h"
+
+// ===================== 帧元数据 ======================
+/**
+* @brief info 行解析分组, 与 libir_infoparse 的三个解析函数对应
+*/
+enum FrameMetaGroup {
+    FRAME_META_STATUS = 1 << 0,     ///< 帧/图像/TPD/快门/设备状态
+    FRAME_META_TEST = 1 << 1,       ///< KBC/AF/SNR/AGC 信息
+    FRAME_META_FUNC = 1 << 2,       ///< 设备信息与 TPD 测温结果
+};
+
+/**
+* @brief 随帧传递的元数据
+*
+* 只保存 info 行原始数据指针, 各分组在第一次访问时才解析并缓存,
+* 同一帧内 FFC、AGC、测温统计等阶段共享解析结果, 不重复解析。
+* info 行数据需在本帧处理结束前保持有效(V4L2 缓冲区重新入队前)。
+*/
+struct FrameMeta {
+    uint8_t* info;      ///< info 行原始数据, NULL 表示没有 info 行
+    unsigned decoded;   ///< 已解析的分组(FrameMetaGroup)
+    unsigned failed;    ///< 解析失败的分组, 不再重试
+    IrinfoStatusInfo_t status;
+    IrinfoTestInfo_t test;
+    IrinfoFuncInfo_t func;
+
+    FrameMeta() :
+        info(NULL),
+        decoded(0),
+        failed(0) {}
+};
+
+/**
+* @brief 绑定新一帧的 info 行, 清空上一帧的解析结果
+*/
+void frameMetaAttach(FrameMeta& meta, uint8_t* info);
+
+/**
+* @brief 按需解析并返回各字段, 没有 info 行或解析失败时返回 NULL
+*/
+const IrinfoStatusInfo_t* frameMetaStatus(FrameMeta& meta);
+const IrinfoFrameSta_t* frameMetaFrame(FrameMeta& meta);
+const IrinfoShutterSta_t* frameMetaShutter(FrameMeta& meta);
+const IrinfoAGCInfo_t* frameMetaAgc(FrameMeta& meta);
+const IrinfoTpdInfo_t* frameMetaTpd(FrameMeta& meta);
+
+#endif
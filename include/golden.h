@@ -0,0 +1,32 @@
+#ifndef _GOLDEN_H_
+#define _GOLDEN_H_
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// ===================== 黄金图像回归 ======================
+/**
+* @brief 与黄金输出的差异
+*/
+struct GoldenMetrics {
+    double max_diff;    ///< 最大绝对差
+    double psnr;        ///< 完全相同时为 cv::PSNR 的上限值
+    double ssim;        ///< 11x11 高斯窗(sigma 1.5) 平均 SSIM
+};
+
+void goldenCompare(const cv::Mat& ref, const cv::Mat& out, GoldenMetrics& metrics);
+
+/**
+* @brief 黄金图像回归(sample --golden <目录> [--update]), 不需要连接相机
+*
+* 对 <目录>/corpus 下的语料帧(PNG, 按灰度读取; 含合成场景与录制帧)运行各增强算法,
+* 与 <目录> 下保存的黄金输出比较最大绝对差、PSNR 和 SSIM, 超出该算法的容差时
+* 打印差异热图并将彩色差异图保存到 <目录>/diff。同时打印当前实现与参考实现的
+* 单帧耗时及加速比。黄金输出只由参考实现(优化前的浮点实现; 定点核为逐位定义的
+* 定点参考)生成: --update 补写缺少的合成场景语料, 并用参考实现重新生成黄金输出。
+*
+* @return 0 全部在容差内, 1 存在超差、缺少黄金输出或语料为空
+*/
+int runGolden(const std::string& dir, bool update);
+
+#endif
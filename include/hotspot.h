@@ -0,0 +1,113 @@
+#ifndef _HOTSPOT_H_
+#define _HOTSPOT_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <vector>
+
+// ===================== 热点检测与跟踪 ======================
+static const int kHotspotMaxRuns = 8192;    // 每帧最多的行程数, 超出后本帧其余像素不再标记
+static const int kHotspotMaxBlobs = 64;     // 每帧最多输出的热点数(按峰值取前若干个)
+static const int kHotspotMaxTracks = 32;    // 同时跟踪的热点数
+
+/**
+* @brief 热点检测与跟踪参数
+*/
+struct HotspotParams {
+    int threshold;      ///< 高于该值的像素为热点(与输入同单位, 如 kelvin*16 或 8 位灰度)
+    int min_area;       ///< 面积小于该值的连通域忽略
+    float gate;         ///< 帧间关联的最大质心距离(像素)
+    int confirm_frames; ///< 连续出现该帧数后确认为热点并输出 APPEAR 事件
+    int max_missed;     ///< 连续丢失超过该帧数删除跟踪并输出 LOST 事件
+
+    HotspotParams() :
+        threshold(230),
+        min_area(4),
+        gate(24.0f),
+        confirm_frames(2),
+        max_missed(3) {}
+};
+
+/**
+* @brief 连通域(8 邻域)统计结果
+*/
+struct HotspotBlob {
+    int area;
+    int peak;               ///< 峰值
+    cv::Point peak_pos;     ///< 峰值位置(行优先第一次出现)
+    cv::Point2f centroid;
+    cv::Rect bbox;
+};
+
+struct HotspotTrack {
+    int id;
+    HotspotBlob blob;       ///< 最近一次关联到的连通域
+    int age;                ///< 已关联的帧数
+    int missed;             ///< 连续未关联的帧数
+    bool confirmed;
+};
+
+enum HotspotEventType {
+    HOTSPOT_APPEAR = 0,
+    HOTSPOT_LOST = 1,
+};
+
+struct HotspotEvent {
+    int type;               ///< 见 HotspotEventType
+    int id;
+    HotspotBlob blob;
+};
+
+/**
+* @brief 一行中连续的热点像素 [x0, x1]
+*/
+struct HotspotRun {
+    int y;
+    int x0;
+    int x1;
+};
+
+/**
+* @brief 连通域累加量, 每个行程建立时计算, 合并时按根累加
+*/
+struct HotspotAcc {
+    int area;
+    int peak;
+    cv::Point peak_pos;
+    int64_t sum_x;
+    int64_t sum_y;
+    int x0, y0, x1, y1;     ///< 外接框(含端点)
+};
+
+/**
+* @brief 热点检测跟踪状态, 缓冲区构造时按上限一次分配
+*/
+struct HotspotState {
+    HotspotParams params;
+    std::vector<HotspotRun> runs;
+    std::vector<int> parent;            ///< 行程的并查集
+    std::vector<HotspotAcc> acc;        ///< 每个行程(合并后为根)的统计
+    std::vector<HotspotBlob> blobs;     ///< 本帧的热点
+    std::vector<HotspotTrack> tracks;
+    std::vector<HotspotEvent> events;   ///< 本帧产生的事件, 下一帧清空
+    int next_id;
+    bool overflow;                      ///< 本帧行程数超过上限
+
+    HotspotState();
+};
+
+/**
+* @brief 阈值化 + 单遍并查集连通域标记(统计量在标记时累加) + 帧间跟踪
+*
+* @param[in] src CV_8UC1 或 CV_16UC1(温度/Y14)
+*/
+void hotspotUpdate(HotspotState& state, const cv::Mat& src);
+
+/**
+* @brief 绘制已确认的热点: 外接框、峰值十字与编号
+*
+* @param[in] scale 显示图相对检测输入的放大倍数
+*/
+void hotspotDraw(const HotspotState& state, cv::Mat& display, double scale);
+
+#endif
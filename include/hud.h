@@ -0,0 +1,65 @@
+#ifndef _HUD_H_
+#define _HUD_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+
+#include "pipestats.h"
+
+// ===================== 性能 HUD ======================
+static const int kHudSparkline = 64;    // 帧间隔曲线显示的最近帧数
+
+/**
+* @brief HUD 参数
+*/
+struct HudParams {
+    int period_ms;      ///< 数值刷新周期, 期间只拷贝缓存的叠加层
+    int width;          ///< 叠加层宽度(显示像素)
+    int spark_height;   ///< 帧间隔曲线高度(显示像素)
+
+    HudParams() :
+        period_ms(250),
+        width(200),
+        spark_height(24) {}
+};
+
+/**
+* @brief 量化后的显示值, 与上次不同才重新绘制叠加层
+*/
+struct HudValues {
+    int fps10;                          ///< 帧率 x10
+    uint32_t drops;
+    int p50[STAGE_NUM];                 ///< 阶段耗时中位数, 单位 0.1 ms
+    int p99[STAGE_NUM];
+    int spark_scale;                    ///< 曲线满量程(ms), 10 ms 取整
+    int spark_num;
+    uint8_t spark[kHudSparkline];       ///< 曲线各点高度(像素)
+};
+
+/**
+* @brief HUD 状态, 叠加层缓存在 overlay 中
+*/
+struct HudState {
+    HudParams params;
+    HudValues shown;        ///< 叠加层当前显示的值
+    cv::Mat overlay;        ///< 不透明底的叠加层(BGR)
+    int64_t next_ns;        ///< 下次读取统计的时间
+    uint32_t renders;       ///< 重新绘制次数
+
+    HudState();
+};
+
+/**
+* @brief 按刷新周期读取统计, 量化值变化时重新绘制叠加层
+*
+* @param[in] now_ns 当前时间(steady_clock)
+* @return 是否重新绘制
+*/
+bool hudUpdate(HudState& hud, const PipelineStats& stats, int64_t now_ns);
+
+/**
+* @brief 把缓存的叠加层拷贝到显示帧右上角, 尚未绘制或显示帧过小时不绘制
+*/
+void hudDraw(const HudState& hud, cv::Mat& display);
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <functional>
+#include <linux/videodev2.h>
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "pipestats.h"
+
+// ===================== 采集到呈现延迟 ======================
+static const int kLatencyMaxSamples = 1 << 20;  // 每个序列最多保留的样本数, 超出后不再记录
+
+/**
+* @brief 一种算法、一种缓冲数设置下的延迟样本
+*/
+struct LatencySeries {
+    std::string algorithm;
+    int buffers;                        ///< 驱动缓冲数(REQBUFS)
+    std::vector<int64_t> total_ns;      ///< 采集 -> 呈现
+    int64_t mark_sum_ns[STAGE_NUM];     ///< 采集到各阶段结束的累计时间
+    int mark_frames[STAGE_NUM];         ///< 各阶段在多少帧中执行过
+    int64_t total_sum_ns;               ///< 采集到呈现的累计时间(不受样本上限影响)
+    int frames;
+};
+
+struct LatencyRecorder {
+    std::vector<LatencySeries> series;
+};
+
+/**
+* @brief v4l2_buffer 的采集时间戳(steady_clock), 不是单调时钟时间戳时返回 fallback_ns
+*/
+int64_t latencyCaptureNs(const v4l2_buffer& buf, int64_t fallback_ns);
+
+/**
+* @brief 记录一帧: 各阶段结束时间取自 stats.stage_end_ns, 本帧没有执行的阶段不计入
+*
+* @param[in] capture_ns 采集时间
+* @param[in] present_ns 呈现时间(图像已交给显示)
+*/
+void latencyRecord(LatencyRecorder& rec, const PipelineStats& stats, const std::string& algorithm, int buffers,
+                   int64_t capture_ns, int64_t present_ns);
+
+/**
+* @brief 序列中采集到呈现延迟的百分位(0-1), 没有样本时返回 0
+*/
+int64_t latencyPercentile(const LatencySeries& series, double p);
+
+/**
+* @brief 打印各序列的延迟分布与各阶段平均时刻, path 非空时按 CSV 追加(多次运行不同缓冲数可汇总)
+*/
+bool latencyReport(const LatencyRecorder& rec, const std::string& path);
+
+// ===================== 闪烁自测 ======================
+/**
+* @brief 自测使用的处理流程: 输入 YUYV(CV_8UC2, 不含 info 行), 输出显示图像
+*/
+struct LatencyAlgorithm {
+    std::string name;
+    std::function<void(const cv::Mat& yuyv, cv::Mat& out)> process;
+};
+
+struct LatencyTestParams {
+    std::vector<int> buffers;   ///< 依次测试的驱动缓冲数
+    int frames;                 ///< 每种配置处理的帧数
+    double fps;
+    int blink_period;           ///< 闪烁周期(帧)
+    int blink_frames;           ///< 每周期中图案出现的帧数
+    int load_ms;                ///< 每帧附加的处理耗时, 模拟处理慢于帧率的情况
+
+    LatencyTestParams() :
+        frames(125),
+        fps(25),
+        blink_period(16),
+        blink_frames(4),
+        load_ms(0)
+    {
+        buffers.push_back(2);
+        buffers.push_back(3);
+        buffers.push_back(4);
+        buffers.push_back(6);
+    }
+};
+
+struct LatencyTestResult {
+    std::string algorithm;
+    int buffers;
+    int cycles;                 ///< 取到了至少一帧图案帧的闪烁周期数
+    int detected;               ///< 在输出端检测到的闪烁次数
+    int disagree;               ///< 图案延迟与时间戳延迟之差超出图案持续时间的检测次数
+    int64_t blink_p50_ns;       ///< 图案出现到输出端检测到的延迟中位数
+    int64_t stamp_p50_ns;       ///< 同一批帧按采集时间戳计算的延迟中位数
+};
+
+/**
+* @brief 不需要光电管的端到端自测
+*
+* 模拟相机按 V4L2 缓冲队列出帧, 周期性地在画面右下角叠加条纹图案(相邻周期条纹方向不同);
+* 在输出端按局部对比度检测图案,
+* 以模拟相机的场景时钟为准计算"图案出现 -> 输出端看到"的延迟, 与按采集时间戳计算的延迟对照:
+* 每次检测两者之差应在 [0, (blink_frames - 1) 帧] 内(容差 1 ms), 否则判为失败。
+* 所有帧同时记录到 rec。
+*/
+bool latencySelfTest(const LatencyTestParams& params, const std::vector<LatencyAlgorithm>& algorithms,
+                     LatencyRecorder& rec, std::vector<LatencyTestResult>& results);
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef _MOCKCAM_H_
+#define _MOCKCAM_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "libircam.h"
+#include "scenegen.h"
+
+// ===================== 模拟相机 ======================
+enum MockChannel {
+    MOCK_VIDEO = 0,
+    MOCK_CONTROL = 1,
+    MOCK_CHANNEL_NUM = 2,
+};
+
+/**
+* @brief 生成第 index 帧的数据(YUYV, 含 info 行)
+*/
+typedef std::function<void(int64_t index, uint8_t* data, int len)> MockFrameSource;
+
+/**
+* @brief 控制通道事务处理, 返回值作为 ir_control_read/write 的返回值
+*
+* libircmd 的命令协议不公开, 模拟相机不解析 cmd_param, 读取默认返回全零;
+* 需要特定应答时由测试代码提供。
+*/
+typedef std::function<int(bool write, void* cmd_param, uint8_t* data, uint32_t len)> MockControlHandler;
+
+/**
+* @brief 模拟相机参数
+*/
+struct MockCamParams {
+    int width;
+    int height;
+    int info_lines;             ///< 图像下方的 info 行数
+    double fps;
+    int buffers;                ///< 驱动缓冲数(同 V4L2 REQBUFS), 0 为只返回最新帧
+    int cmd_latency_us;         ///< 每次控制事务的固定耗时
+    int cmd_ns_per_byte;        ///< 控制事务每字节附加耗时
+    float cmd_error_rate;       ///< 控制事务随机失败概率
+    float frame_error_rate;     ///< 取帧随机失败概率
+    int ffc_interval_frames;    ///< 每隔多少帧自动 FFC, 0 为不自动
+    int ffc_frames;             ///< 每次 FFC 冻结的帧数
+    uint64_t seed;              ///< 随机错误的种子, 视频通道在开始取流时、控制通道在挂接句柄时按当前值播种
+
+    MockCamParams() :
+        width(384),
+        height(288),
+        info_lines(0),
+        fps(25),
+        buffers(0),
+        cmd_latency_us(3000),
+        cmd_ns_per_byte(100),
+        cmd_error_rate(0),
+        frame_error_rate(0),
+        ffc_interval_frames(0),
+        ffc_frames(8),
+        seed(20250610) {}
+};
+
+struct MockCamStats {
+    std::atomic<uint32_t> frames;           ///< 成功返回的帧数
+    std::atomic<uint32_t> dropped;          ///< 调用方取帧过慢而被覆盖的帧数
+    std::atomic<uint32_t> frame_errors;
+    std::atomic<uint32_t> ffc_frames;       ///< FFC 期间返回的冻结帧数
+    std::atomic<uint32_t> commands;
+    std::atomic<uint32_t> command_errors;
+    std::atomic<uint64_t> command_bytes;
+    std::atomic<int64_t> command_busy_ns;
+
+    MockCamStats() :
+        frames(0), dropped(0), frame_errors(0), ffc_frames(0),
+        commands(0), command_errors(0), command_bytes(0), command_busy_ns(0) {}
+};
+
+/**
+* @brief 进程内模拟相机, 实现 IrVideoHandle_t/IrControlHandle_t 的函数表
+*
+* 视频通道按 fps 节拍出帧, 调用方取帧过慢时与真实相机一样丢弃过期帧只返回最新帧;
+* 设置 buffers 时按 V4L2 缓冲队列出帧: 按采集顺序返回最旧的帧, 队列满时丢弃新帧。
+* 控制通道串行执行, 每次事务按参数模拟耗时。两个通道都可注入卡顿与错误,
+* 视频通道可注入 FFC(连续返回相同的冻结帧)。
+*/
+struct MockCamera {
+    MockCamParams params;
+    MockFrameSource source;             ///< 为空时使用录制帧或合成场景
+    MockControlHandler control;         ///< 为空时写入成功、读取返回全零
+    std::vector<std::vector<uint8_t> > recording;
+
+    std::mutex video_mutex;
+    std::mutex control_mutex;           ///< 控制事务串行, 与真实总线一致
+    bool streaming;
+    int64_t stream_start_ns;
+    int64_t next_index;                 ///< 下一个要返回(buffers > 0 时为要采集)的帧序号
+    std::deque<int64_t> ready;          ///< buffers > 0 时已采集、等待取走的帧序号
+    int64_t capture_ns;                 ///< 最近返回的帧的采集时间(steady_clock)
+    int ffc_remaining;
+    std::vector<uint8_t> frozen;        ///< FFC 期间重复返回的帧
+    SceneGen scene;                     ///< 默认帧源, 尺寸随 params 同步
+    cv::RNG rng;                        ///< 视频通道使用
+    cv::RNG control_rng;                ///< 控制通道使用
+
+    std::atomic<int> stall_ms[MOCK_CHANNEL_NUM];    ///< 下一次调用额外卡顿的时间
+    std::atomic<int> errors[MOCK_CHANNEL_NUM];      ///< 接下来连续失败的调用数
+    std::atomic<int> ffc_request;
+    MockCamStats stats;
+
+    MockCamera();
+};
+
+int mockCamFrameSize(const MockCamera& cam);
+
+/**
+* @brief 填充视频/控制句柄的函数表, 句柄的设备指针指向 cam
+*/
+void mockCamAttachVideo(MockCamera& cam, IrVideoHandle_t& handle);
+void mockCamAttachControl(MockCamera& cam, IrControlHandle_t& handle);
+
+/**
+* @brief 最近一次取到的帧的采集时间, 相当于 v4l2_buffer.timestamp
+*/
+int64_t mockCamCaptureNs(MockCamera& cam);
+
+/**
+* @brief 载入录制的原始帧文件(连续的 YUYV 帧), 循环播放
+*/
+bool mockCamLoadRecording(MockCamera& cam, const std::string& path);
+
+/**
+* @brief 故障注入: 下一次调用卡顿 ms 毫秒
+*/
+void mockCamInjectStall(MockCamera& cam, int channel, int ms);
+
+/**
+* @brief 故障注入: 接下来 count 次调用返回 USB 错误
+*/
+void mockCamInjectErrors(MockCamera& cam, int channel, int count);
+
+/**
+* @brief 故障注入: 从下一帧开始进行一次 FFC
+*/
+void mockCamTriggerFfc(MockCamera& cam);
+
+#endif
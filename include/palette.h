@@ -0,0 +1,109 @@
+#ifndef _PALETTE_H_
+#define _PALETTE_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "libircmd.h"
+
+// ===================== 伪彩引擎 ======================
+/**
+* @brief 伪彩输出格式
+*/
+enum PaletteFormat {
+    PALETTE_FMT_BGR = 0,    ///< CV_8UC3, 显示用
+    PALETTE_FMT_BGRA = 1,   ///< CV_8UC4
+    PALETTE_FMT_NV12 = 2,   ///< CV_8UC1, 高度为 1.5 倍(Y 平面 + UV 交织平面), 编码器输入
+};
+
+/**
+* @brief 内置伪彩, 用户加载的伪彩序号从 PALETTE_BUILTIN_NUM 开始
+*/
+enum PaletteBuiltin {
+    PALETTE_WHITE_HOT = 0,
+    PALETTE_BLACK_HOT = 1,
+    PALETTE_IRONBOW = 2,
+    PALETTE_RAINBOW = 3,
+    PALETTE_BUILTIN_NUM
+};
+
+static const int kPaletteMaxNum = 16;       // 最多注册的伪彩数(内置 + 用户)
+static const int kPaletteNameLen = 16;      // 伪彩名长度, 设备名如 "YP0500"
+static const int kPaletteY14Size = 16384;   // Y14 查找表项数
+
+/**
+* @brief 伪彩引擎
+*
+* 每个伪彩保存 256 级 BGR 色表; 当前伪彩另外展开为 8 位与 Y14 两组打包查找表
+* (BGRA 与 YUV, 每项 32 位), 构造时一次分配, 切换伪彩或修改 Y14 区间只重写表内容。
+*/
+struct PaletteEngine {
+    int num;                                        ///< 已注册伪彩数
+    char names[kPaletteMaxNum][kPaletteNameLen];    ///< 伪彩名
+    uchar colors[kPaletteMaxNum][256 * 3];          ///< 各伪彩 256 级 BGR 色表
+    int active;                                     ///< 当前伪彩序号
+    int y14_low;                                    ///< Y14 映射区间下限, 映射到色表首项
+    int y14_high;                                   ///< Y14 映射区间上限, 映射到色表末项
+    int device_num;                                 ///< 设备伪彩数, 0 表示未与设备同步
+    int device_map[kPaletteMaxNum];                 ///< 设备伪彩序号 -> 本地序号, -1 表示无对应
+
+    std::vector<uint32_t> lut8_bgra;    ///< 当前伪彩 256 项, B | G<<8 | R<<16 | 0xFF<<24
+    std::vector<uint32_t> lut8_yuv;     ///< 当前伪彩 256 项, Y | U<<8 | V<<16 (BT.601 全范围)
+    std::vector<uint32_t> lut14_bgra;   ///< 当前伪彩 16384 项, 按 y14_low/high 线性插值
+    std::vector<uint32_t> lut14_yuv;
+
+    PaletteEngine();
+};
+
+/**
+* @brief 从文件加载用户伪彩, 同名伪彩会被覆盖
+*
+* 文件为 768(或 772, Adobe ACT)字节的 RGB 二进制色表, 或 256 行 "R G B" 文本。
+*
+* @return 伪彩序号, 失败返回 -1
+*/
+int paletteLoad(PaletteEngine& engine, const std::string& path, const char* name);
+
+/**
+* @brief 按名字查找伪彩, 未找到返回 -1
+*/
+int paletteFind(const PaletteEngine& engine, const char* name);
+
+/**
+* @brief 切换当前伪彩, 不分配内存
+*/
+bool paletteSelect(PaletteEngine& engine, int index);
+
+/**
+* @brief 设置 Y14 映射区间并重建 Y14 查找表, 不分配内存
+*/
+void paletteSetY14Range(PaletteEngine& engine, int low, int high);
+
+/**
+* @brief 按 basic_palette_num_get/basic_palette_name_get 同步设备伪彩列表
+*
+* 设备伪彩按名字对应本地伪彩, 本地没有时尝试加载 dir/<name>.pal。
+*
+* @return 设备伪彩数, 命令失败返回 -1
+*/
+int paletteSyncDevice(PaletteEngine& engine, IrcmdHandle_t* handle, const std::string& dir);
+
+/**
+* @brief 按设备伪彩序号切换, 与相机端 basic_palette_idx_set 使用同一序号
+*/
+bool paletteSelectDevice(PaletteEngine& engine, int device_index);
+
+/**
+* @brief 查表上色, 直接写入显示或编码缓冲
+*
+* @param[in] engine 伪彩引擎(当前伪彩)
+* @param[in] src 8 位单通道, 或 CV_16UC1 的 Y14 数据
+* @param[out] dst 输出, 格式见 PaletteFormat; 尺寸类型一致时直接写入(可为外部缓冲)
+* @param[in] format 见 PaletteFormat, NV12 要求宽高为偶数
+*/
+void applyPalette(const PaletteEngine& engine, const cv::Mat& src, cv::Mat& dst,
+                  int format = PALETTE_FMT_BGR);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include "algorithm.h"
+#include "dpc.h"
+#include "ffc.h"
+#include "hotspot.h"
+#include "hud.h"
+#include "palette.h"
+#include "pipestats.h"
+#include "tempmap.h"
+
+/**
+* @brief 流水线跨帧状态区
+*
+* 各处理阶段需要跨帧保留的缓冲区统一放在这里, 由主循环持有,
+* 帧尺寸不变时不会重新分配。
+*/
+struct PipelineArena {
+    DpcState dpc;               ///< 坏点表(持久保存, 状态复位时保留)
+    FfcGuard ffc;               ///< FFC/快门检测与 FFC 期间重复显示的输出
+    SbnucState nuc;             ///< 场景非均匀校正偏移表(算法切换时保留, FFC 后清空)
+    TemporalDenoiseState tnr;   ///< 时域降噪历史帧
+    FusedEdgeState edge;        ///< 融合边缘流水线的灰度帧
+    EdgeOverlayParams overlay;  ///< SobelPrewitt 模式边缘高亮参数
+    PaletteEngine palette;      ///< 伪彩查找表(切换伪彩不重新分配)
+    HotspotState hotspot;       ///< 热点检测与跟踪(算法切换时保留)
+    TempMapState tempmap;       ///< NUC -> 温度查找表(加载 NUC_T 表后启用)
+    cv::Mat temp;               ///< 本帧温度图(kelvin*16), 本帧没有温度数据时为空
+    PipelineStats stats;        ///< 各阶段耗时与帧率(算法切换时保留)
+    HudState hud;               ///< 性能 HUD 缓存的叠加层
+    int upscale_mode;           ///< 显示放大方式, 见 UpscaleMode
+    int last_algorithm;         ///< 上一帧使用的算法, 用于检测算法切换
+    bool color_sink;            ///< 是否有消费彩色输出的输出端(显示窗口); 无头运行时为 false, 边缘高亮着色跳过
+
+    PipelineArena() :
+        upscale_mode(UPSCALE_EDGE),
+        last_algorithm(-1),
+        color_sink(true) {}
+};
+
+/**
+* @brief 使所有跨帧状态失效(算法切换时调用)
+*
+* FFC 期间各状态冻结而不是复位, FFC 结束后只清空 SBNUC 偏移表, 见 FfcGuard。
+*/
+void resetPipelineState(PipelineArena& arena);
+
+#endif
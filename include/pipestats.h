@@ -0,0 +1,92 @@
+#ifndef _PIPESTATS_H_
+#define _PIPESTATS_H_
+
+#include <stdint.h>
+
+#include "trace.h"
+
+// ===================== 流水线统计 ======================
+enum PipelineStage {
+    STAGE_CAPTURE = 0,      ///< DQBUF 等待
+    STAGE_CONVERT,          ///< yuyv_to_mat
+    STAGE_PREPROCESS,       ///< 坏点/非均匀校正/时域降噪
+    STAGE_UPSCALE,
+    STAGE_ALGORITHM,
+    STAGE_DISPLAY,          ///< showFrameWithUI(含 imshow)
+    STAGE_NUM,
+};
+
+static const int kStatsWindow = 128;    // 百分位与帧率统计的最近帧数
+
+extern const char* const kStageNames[STAGE_NUM];
+
+/**
+* @brief 各阶段耗时与帧率统计, 只在采集线程中访问
+*/
+struct PipelineStats {
+    int64_t stage_ns[STAGE_NUM][kStatsWindow];  ///< 各阶段最近的耗时
+    int stage_count[STAGE_NUM];                 ///< 各阶段累计记录数
+    int64_t stage_end_ns[STAGE_NUM];            ///< 各阶段最近一次结束的时间, 用于单帧延迟分解
+    int64_t frame_ns[kStatsWindow];             ///< 最近的帧间隔
+    int frame_count;                            ///< 累计帧间隔数
+    int64_t last_frame_ns;
+    uint32_t last_sequence;                     ///< 上一帧的 V4L2 序号
+    uint32_t frames;
+    uint32_t drops;                             ///< 由 V4L2 序号间隔推算的丢帧数
+
+    PipelineStats();
+};
+
+void statsReset(PipelineStats& stats);
+
+void statsStage(PipelineStats& stats, int stage, int64_t ns);
+
+/**
+* @brief 阶段结束: 记录从 begin_ns 到现在的耗时, 开启跟踪时同时记录跟踪事件
+*/
+void statsStageEnd(PipelineStats& stats, int stage, int64_t begin_ns);
+
+/**
+* @brief 每帧取到时调用一次
+*
+* @param[in] now_ns 取到帧的时间(steady_clock)
+* @param[in] sequence v4l2_buffer.sequence, 用于统计丢帧
+*/
+void statsFrame(PipelineStats& stats, int64_t now_ns, uint32_t sequence);
+
+/**
+* @brief 最近 kStatsWindow 帧的平均帧率
+*/
+double statsFps(const PipelineStats& stats);
+
+/**
+* @brief 阶段耗时的百分位(0-1), 没有记录时返回 0
+*/
+int64_t statsPercentile(const PipelineStats& stats, int stage, double p);
+
+/**
+* @brief 复制最近的帧间隔, 按时间从旧到新
+*
+* @return 复制的个数
+*/
+int statsFrameHistory(const PipelineStats& stats, int64_t* out, int max);
+
+/**
+* @brief 阶段计时作用域, 析构时调用 statsStageEnd
+*/
+struct StageScope {
+    PipelineStats& stats;
+    int stage;
+    int64_t begin_ns;
+
+    StageScope(PipelineStats& s, int st) :
+        stats(s),
+        stage(st),
+        begin_ns(traceNowNs()) {}
+    ~StageScope()
+    {
+        statsStageEnd(stats, stage, begin_ns);
+    }
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef _SCENEGEN_H_
+#define _SCENEGEN_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <vector>
+
+// ===================== 合成热像场景 ======================
+enum SceneFormat {
+    SCENE_Y14 = 0,      ///< CV_16UC1, 0-16383
+    SCENE_Y16 = 1,      ///< CV_16UC1, Y14 左移 2 位
+    SCENE_YUYV = 2,     ///< CV_8UC2, Y 为 Y14 按 agc_low/agc_high 线性拉伸, UV 固定 128
+};
+
+static const int kSceneMaxValue = 16383;
+static const int kSceneNoiseTable = 65536;  // 时域噪声表项数, 每行从随机位置取用
+
+/**
+* @brief 场景中的圆形目标, 按速度匀速运动, 碰到边界反弹
+*/
+struct SceneObject {
+    cv::Point2f pos;        ///< 第 0 帧的圆心
+    cv::Point2f velocity;   ///< 像素/帧
+    float radius;
+    int value;              ///< Y14 值
+
+    SceneObject() : radius(10), value(12000) {}
+    SceneObject(cv::Point2f p, cv::Point2f v, float r, int val) : pos(p), velocity(v), radius(r), value(val) {}
+};
+
+/**
+* @brief 场景参数, 数值单位均为 Y14
+*/
+struct SceneParams {
+    cv::Size size;
+    int background_low;         ///< 背景渐变的最低值
+    int background_high;        ///< 背景渐变的最高值
+    float gradient_angle;       ///< 渐变方向(度), 0 为从左到右升高
+    std::vector<SceneObject> objects;
+    float fpn_sigma;            ///< 逐像素固定图案噪声
+    float column_fpn_sigma;     ///< 列条纹固定图案噪声
+    float temporal_sigma;       ///< 时域噪声
+    float dead_ratio;           ///< 坏点比例, 坏点交替固定为 0 和 kSceneMaxValue
+    int shutter_interval;       ///< 每隔多少帧快门闭合一次, 0 为不闭合
+    int shutter_frames;         ///< 每次快门闭合的帧数
+    int shutter_value;          ///< 快门挡片的 Y14 值
+    int agc_low;                ///< YUYV 输出的拉伸下限
+    int agc_high;               ///< YUYV 输出的拉伸上限
+    int info_lines;             ///< YUYV 输出附加的 info 行数(置零)
+    uint64_t seed;
+
+    SceneParams() :
+        size(384, 288),
+        background_low(7000),
+        background_high(8000),
+        gradient_angle(20),
+        fpn_sigma(12),
+        column_fpn_sigma(8),
+        temporal_sigma(6),
+        dead_ratio(0.0005f),
+        shutter_interval(0),
+        shutter_frames(6),
+        shutter_value(7600),
+        agc_low(6800),
+        agc_high(12200),
+        info_lines(0),
+        seed(20250612)
+    {
+        objects.push_back(SceneObject(cv::Point2f(96, 144), cv::Point2f(2.5f, 1.0f), 18, 11500));
+        objects.push_back(SceneObject(cv::Point2f(280, 80), cv::Point2f(-1.0f, 1.5f), 10, 9500));
+    }
+};
+
+/**
+* @brief 场景生成器
+*
+* 背景、固定图案噪声和坏点在 sceneGenReset 时生成一次; 每帧只叠加目标与时域噪声。
+* 第 index 帧的内容只由参数、种子和 index 决定, 与生成顺序无关。
+*/
+struct SceneGen {
+    SceneParams params;
+    cv::Mat base;                   ///< CV_16SC1, 背景 + 固定图案噪声
+    cv::Mat fpn;                    ///< CV_16SC1, 固定图案噪声(目标与快门帧上同样叠加)
+    std::vector<int16_t> noise;     ///< 时域噪声表, 多出一行供行内连续读取
+    std::vector<int> dead;          ///< 坏点下标(y * width + x)
+    std::vector<uchar> agc_lut;     ///< Y14 -> YUYV 的 Y
+    cv::Mat y14;                    ///< YUYV 输出时的中间帧
+    int64_t frame;                  ///< sceneGenNext 的下一帧序号
+    bool shutter;                   ///< 最近生成的一帧为快门帧
+    bool built;
+
+    SceneGen() :
+        frame(0),
+        shutter(false),
+        built(false) {}
+};
+
+/**
+* @brief 按当前参数重新生成静态部分, 修改参数后调用
+*/
+void sceneGenReset(SceneGen& gen);
+
+bool sceneGenIsShutter(const SceneGen& gen, int64_t index);
+
+/**
+* @brief 生成第 index 帧
+*
+* @param[out] dst 格式见 SceneFormat, YUYV 时包含 info_lines 行
+*/
+void sceneGenRender(SceneGen& gen, int64_t index, int format, cv::Mat& dst);
+
+/**
+* @brief 按顺序生成下一帧
+*/
+void sceneGenNext(SceneGen& gen, int format, cv::Mat& dst);
+
+/**
+* @brief 生成第 index 帧 YUYV 到外部缓冲区(可作为 MockFrameSource), len 不足时不写入
+*/
+void sceneGenYuyv(SceneGen& gen, int64_t index, uint8_t* data, int len);
+
+#endif
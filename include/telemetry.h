@@ -0,0 +1,136 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "cmdexec.h"
+#include "ffc.h"
+
+// ===================== 遥测轮询 ======================
+enum TelemetryMetric {
+    TELEM_DEVICE_TEMP = 0,      ///< basic_device_temp_get, temperature
+    TELEM_POWERED_TIME,         ///< adv_powered_time_get, value
+    TELEM_REALTIME_STATUS,      ///< adv_device_realtime_status_get, data
+    TELEM_FRAME_TEMP,           ///< basic_frame_temp_info_get, frame_temp
+    TELEM_SHUTTER,              ///< adv_shutter_status_get, value
+    TELEM_NUM,
+};
+
+static const int kTelemetryHistory = 64;    // 每项指标保留的历史采样数
+
+/**
+* @brief 读取一项指标, 结果写入 CmdResult 对应字段
+*/
+typedef IrlibError_e (*TelemetryReader)(IrcmdHandle_t* handle, int status_type, CmdResult& result);
+
+extern const TelemetryReader kTelemetryReaders[TELEM_NUM];
+
+/**
+* @brief 轮询参数
+*/
+struct TelemetryParams {
+    int period_ms[TELEM_NUM];   ///< 各指标轮询周期, 0 为不轮询
+    int jitter_ms;              ///< 每次到期时间的随机抖动范围 ±jitter_ms, 避免与 FFC 周期对齐
+    int ffc_holdoff_ms;         ///< FFC(快门闭合或主动触发)后暂停轮询的时间
+    int burst_window_ms;        ///< 到期时间在该窗口内的指标合并为一次连续读取
+    float max_occupancy;        ///< 遥测占用命令通道时间的上限(0-1)
+    int realtime_status_type;   ///< adv_realtime_status_type_e
+
+    TelemetryParams() :
+        jitter_ms(20),
+        ffc_holdoff_ms(500),
+        burst_window_ms(50),
+        max_occupancy(0.1f),
+        realtime_status_type(0)
+    {
+        period_ms[TELEM_DEVICE_TEMP] = 2000;
+        period_ms[TELEM_POWERED_TIME] = 60000;
+        period_ms[TELEM_REALTIME_STATUS] = 1000;
+        period_ms[TELEM_FRAME_TEMP] = 500;
+        period_ms[TELEM_SHUTTER] = 200;
+    }
+};
+
+struct TelemetrySample {
+    int64_t t_ns;               ///< 读取完成时间(steady_clock)
+    CmdResult result;
+};
+
+/**
+* @brief 对外发布的快照, 各指标最近一次成功读取的结果
+*/
+struct TelemetrySnapshot {
+    TelemetrySample latest[TELEM_NUM];
+    bool valid[TELEM_NUM];
+    uint32_t samples[TELEM_NUM];    ///< 成功读取次数
+    uint32_t errors[TELEM_NUM];
+    uint32_t bursts;                ///< 提交的连续读取次数
+    uint32_t deferred;              ///< 因占用上限或 FFC 推迟的次数
+    double occupancy;               ///< 遥测占用命令通道的时间比例
+    double channel_occupancy;       ///< 命令通道总占用比例(含其他命令)
+};
+
+/**
+* @brief 遥测调度器
+*
+* 调度线程只负责计算到期时间, 读取在命令执行器线程中以读取优先级执行;
+* 同一窗口内到期的指标打包为一条命令连续读取, 减少每次调用的轮询等待开销。
+* 遥测占用时间按令牌桶限制在 max_occupancy 以内。
+*/
+struct TelemetryState {
+    TelemetryParams params;
+    const TelemetryReader* readers;     ///< 默认 kTelemetryReaders
+    CmdExecutor* exec;
+    FfcGuard* ffc;                      ///< 非空时用快门状态驱动 ffcGuardSetShutter
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool running;
+    bool in_flight;                     ///< 已提交的读取尚未完成
+    cv::RNG rng;
+
+    int64_t next_due[TELEM_NUM];
+    int64_t budget_ns;                  ///< 令牌桶余量
+    int64_t budget_ns_at;               ///< 令牌桶上次补充时间
+    int64_t read_cost_ns;               ///< 单次读取耗时估计, 用于判断额度是否足够
+    std::atomic<int64_t> ffc_ns;        ///< 最近一次 FFC 时间
+    int64_t start_ns;
+    int64_t busy_ns;                    ///< 遥测读取耗时合计
+
+    TelemetrySample history[TELEM_NUM][kTelemetryHistory];
+    int history_head[TELEM_NUM];
+    TelemetrySnapshot snapshot;
+
+    TelemetryState();
+    ~TelemetryState();      ///< 仍在运行时先停止
+};
+
+/**
+* @brief 启动调度线程, exec 需已启动
+*/
+void telemetryStart(TelemetryState& state, CmdExecutor* exec);
+void telemetryStop(TelemetryState& state);
+
+/**
+* @brief 通知主动触发了 FFC(如 cmdExecFfcUpdate), 之后 ffc_holdoff_ms 内不轮询
+*/
+void telemetryNotifyFfc(TelemetryState& state);
+
+/**
+* @brief 复制当前快照
+*/
+void telemetrySnapshot(TelemetryState& state, TelemetrySnapshot& snapshot);
+
+/**
+* @brief 复制一项指标的历史, 按时间从旧到新
+*/
+void telemetryHistory(TelemetryState& state, int metric, std::vector<TelemetrySample>& samples);
+
+#endif
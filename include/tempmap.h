@@ -0,0 +1,103 @@
+#ifndef _TEMPMAP_H_
+#define _TEMPMAP_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "libirtemp.h"
+
+// ===================== 温度图 ======================
+static const int kTempMapSize = 16384;  // 查找表项数, 覆盖 14 位 NUC 值
+
+/**
+* @brief 温度换算参数
+*/
+struct TempMapParams {
+    EnvParam_t env;     ///< 发射率/透过率/大气温度/反射温度(设备单位), 计算 K_E/B_E
+    uint8_t gain;       ///< HIGH_GAIN 或 LOW_GAIN
+    bool correct;       ///< 是否再用 temp_correct 做环境修正
+    float ems;          ///< temp_correct 的发射率(0-1)
+    uint16_t tau;       ///< temp_correct 的大气透过率(0-16384)
+    float ta;           ///< temp_correct 的大气温度(摄氏度)
+
+    TempMapParams() :
+        gain(HIGH_GAIN),
+        correct(false),
+        ems(1.0f),
+        tau(16384),
+        ta(25.0f)
+    {
+        env.EMS = EMS_MAX;
+        env.TAU = TAU_MAX;
+        env.Ta = 298;
+        env.Tu = 298;
+    }
+};
+
+/**
+* @brief 温度图状态
+*
+* NUC 值到温度的换算用 SDK 逐值计算, 分三级查找表缓存, 参数变化时只重建受影响的级:
+* remap(NUC_T 表: nuc_cal -> kelvin*16) -> lut_env(K_E/B_E: nuc_org -> kelvin*16)
+* -> lut/lut_celsius(temp_correct)。每帧只做一次查表。
+* 查表结果与逐像素调用 SDK 的一致性由 --bench 检查, 只有链接真实 libirtemp(HAVE_LIBIRTEMP)时才判定 PASS。
+*/
+struct TempMapState {
+    TempMapParams params;               ///< 当前参数, 修改后下次 tempMapApply 时生效
+    std::vector<uint16_t> nuc_table;    ///< NUC_T 表
+
+    std::vector<uint16_t> remap;        ///< nuc_cal -> kelvin*16
+    std::vector<uint16_t> lut_env;      ///< nuc_org -> kelvin*16, 已做 K_E/B_E 修正
+    std::vector<unsigned> lut;          ///< nuc_org -> kelvin*16, 最终结果
+    std::vector<float> lut_celsius;     ///< nuc_org -> 摄氏度, 最终结果
+
+    bool table_dirty;           ///< NUC_T 表已更新
+    bool built;                 ///< 查找表有效
+    TempMapParams built_params; ///< 当前查找表对应的参数
+    EnvFactor_t env_factor;     ///< 当前查找表对应的 K_E/B_E
+    int builds[3];              ///< 各级重建次数
+
+    TempMapState() :
+        table_dirty(false),
+        built(false)
+    {
+        env_factor.K_E = 0;
+        env_factor.B_E = 0;
+        builds[0] = builds[1] = builds[2] = 0;
+    }
+};
+
+/**
+* @brief 设置 NUC_T 表(相机读出或 generate_high_gain_nuc_t/generate_low_gain_nuc_t 生成)
+*/
+void tempMapSetNucTable(TempMapState& state, const uint16_t* table, int len);
+
+/**
+* @brief 从文件加载 NUC_T 表: NUC_T_SIZE 个 uint16, 小端字节序, 无文件头
+*
+* @return 文件不存在或长度不符时返回 false, 不修改 state
+*/
+bool tempMapLoadNucTable(TempMapState& state, const std::string& path);
+
+/**
+* @brief 按当前参数重建需要更新的查找表级, 参数未变化时不做任何计算
+*
+* @return SDK 计算失败返回 false, 此时保留原查找表
+*/
+bool tempMapUpdate(TempMapState& state);
+
+/**
+* @brief 整帧 NUC 值换算为温度, 一次查表遍历
+*
+* @param[in] nuc CV_16UC1 NUC 帧(超过 14 位的值按 16383 处理)
+* @param[out] dst CV_16U 为 kelvin*16(与 TempInfo_t 相同单位), CV_32F 为摄氏度
+* @param[in] depth CV_16U 或 CV_32F
+*
+* @return 没有可用的查找表(NUC_T 表未设置或首次计算失败)时返回 false, 不修改 dst, 调用者跳过本帧测温;
+*         重建失败但已有查找表时沿用原表
+*/
+bool tempMapApply(TempMapState& state, const cv::Mat& nuc, cv::Mat& dst, int depth = CV_16U);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef _TEMPSTATS_H_
+#define _TEMPSTATS_H_
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <vector>
+
+#include "libirtemp.h"
+
+// ===================== 多 ROI 测温统计 ======================
+enum TempRoiType {
+    TEMP_ROI_POINT = 0,
+    TEMP_ROI_LINE = 1,
+    TEMP_ROI_RECT = 2,
+};
+
+/**
+* @brief 测温区域, 坐标从 0 开始, 与 get_point_temp/get_line_temp/get_rect_temp 的参数一致
+*
+* 线段按 Bresenham 取点、矩形含起点共 width x height 个像素; 与 SDK 取点方式一致由 --bench 的 temp stats 项
+* 对照 get_*_temp 检查, 只在链接真实 libirtemp(HAVE_LIBIRTEMP)时判定 PASS。
+*/
+struct TempRoi {
+    int type;       ///< 见 TempRoiType
+    Dot_t point;
+    Line_t line;
+    Area_t rect;
+};
+
+/**
+* @brief ROI 在某一行上覆盖的连续像素 [x0, x1]
+*/
+struct TempSpan {
+    int roi;
+    int x0;
+    int x1;
+};
+
+/**
+* @brief 多 ROI 测温引擎
+*
+* 添加/删除 ROI 后把所有 ROI 编译为按行排序的像素区间表,
+* 每帧只按行顺序遍历一次温度帧, 同一行上的所有区间依次统计, 重叠区域不会重复读取整帧。
+*/
+struct TempStatsEngine {
+    int width;
+    int height;
+    std::vector<TempRoi> rois;
+    std::vector<TempSpan> spans;    ///< 按行排序的区间
+    std::vector<int> row_start;     ///< 第 y 行的区间为 spans[row_start[y], row_start[y + 1])
+    std::vector<TempInfo_t> results;///< 与 rois 一一对应, 点的最大/最小/平均值均为该点温度
+    bool dirty;                     ///< ROI 有变化, 下次统计前重新编译
+
+    TempStatsEngine() :
+        width(0),
+        height(0),
+        dirty(true) {}
+};
+
+/**
+* @brief 添加 ROI, 返回 ROI 序号; 坐标超出 tempStatsSetSize 设置的帧尺寸时返回 -1
+*/
+int tempStatsAddPoint(TempStatsEngine& engine, Dot_t point);
+int tempStatsAddLine(TempStatsEngine& engine, Line_t line);
+int tempStatsAddRect(TempStatsEngine& engine, Area_t rect);
+
+/**
+* @brief 设置温度帧尺寸并清空 ROI
+*/
+void tempStatsSetSize(TempStatsEngine& engine, int width, int height);
+
+/**
+* @brief 一次遍历计算所有 ROI 的最大/最小/平均温度及坐标, 结果写入 engine.results
+*
+* @param[in] temp 温度帧(CV_16UC1, 单位 kelvin*16), 尺寸与 tempStatsSetSize 一致
+*/
+void tempStatsCompute(TempStatsEngine& engine, const cv::Mat& temp);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+// ===================== 阶段跟踪 ======================
+static const int kTraceRingSize = 8192;     // 每个线程保留的最近事件数(2 的幂)
+
+/**
+* @brief 一次阶段执行, name 须为字符串常量(只保存指针)
+*/
+struct TraceEvent {
+    const char* name;
+    int64_t begin_ns;
+    int64_t end_ns;
+    int64_t frame;      ///< 所在帧序号(traceFrame 设置), -1 为不属于某帧
+};
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool traceEnabled()
+{
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t traceNowNs();
+
+/**
+* @brief 开关跟踪; 关闭时每个跟踪点只有一次原子读和一次分支
+*/
+void traceEnable(bool on);
+
+/**
+* @brief 清空所有线程已记录的事件, 调用时其他线程不应正在记录
+*/
+void traceClear();
+
+/**
+* @brief 设置当前线程在跟踪中显示的名字, name 须为字符串常量
+*/
+void traceSetThreadName(const char* name);
+
+/**
+* @brief 设置当前线程之后记录的事件所属的帧序号
+*/
+void traceFrame(int64_t frame);
+
+/**
+* @brief 记录一次阶段执行到当前线程的环形缓冲, 缓冲满时覆盖最旧的事件
+*/
+void traceRecord(const char* name, int64_t begin_ns, int64_t end_ns);
+
+/**
+* @brief 不便用作用域包住的阶段: traceBegin 与 traceEnd 成对使用, 开始时未开启跟踪则不记录
+*/
+inline int64_t traceBegin()
+{
+    return traceEnabled() ? traceNowNs() : 0;
+}
+
+inline void traceEnd(const char* name, int64_t begin_ns)
+{
+    if (begin_ns != 0) {
+        traceRecord(name, begin_ns, traceNowNs());
+    }
+}
+
+/**
+* @brief 作用域跟踪点, 析构时记录
+*/
+struct TraceScope {
+    const char* name;
+    int64_t begin_ns;
+
+    explicit TraceScope(const char* n) :
+        name(n),
+        begin_ns(traceBegin()) {}
+    ~TraceScope()
+    {
+        traceEnd(name, begin_ns);
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+/**
+* @brief 导出所有线程的事件为 Chrome trace JSON(可用 Perfetto/chrome://tracing 打开)
+*
+* 可在记录线程仍在运行时调用, 导出期间被覆盖的事件会被丢弃。
+*/
+bool traceDump(const std::string& path);
+
+/**
+* @brief 收到信号 sig 时导出到 path
+*
+* 信号处理函数只置位标志, 实际导出在下一次 tracePoll 中完成(信号处理中不能做文件 IO)。
+*/
+void traceDumpOnSignal(int sig, const std::string& path);
+
+/**
+* @brief 程序正常退出(exit 或 main 返回)时导出到 path
+*/
+void traceDumpAtExit(const std::string& path);
+
+/**
+* @brief 在帧边界调用, 处理待完成的信号导出
+*/
+void tracePoll();
+
+#endif
@@ -0,0 +1,130 @@
+#include "alarm.h"
+
+#include <algorithm>
+#include <chrono>
+
+int64_t alarmNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool alarmQueuePush(AlarmQueue& queue, const AlarmEvent& event)
+{
+    uint32_t head = queue.head.load(std::memory_order_relaxed);
+    uint32_t tail = queue.tail.load(std::memory_order_acquire);
+    if (head - tail >= (uint32_t)kAlarmQueueSize) {
+        queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    queue.events[head & (kAlarmQueueSize - 1)] = event;
+    queue.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool alarmQueuePop(AlarmQueue& queue, AlarmEvent& event)
+{
+    uint32_t tail = queue.tail.load(std::memory_order_relaxed);
+    uint32_t head = queue.head.load(std::memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    event = queue.events[tail & (kAlarmQueueSize - 1)];
+    queue.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+int alarmAddRule(AlarmEngine& engine, const AlarmRule& rule)
+{
+    CV_Assert(rule.type >= ALARM_RULE_HIGH && rule.type <= ALARM_RULE_RISE);
+    CV_Assert(rule.raise_frames > 0 && rule.clear_frames > 0 && rule.window_ms > 0);
+    engine.rules.push_back(rule);
+    return (int)engine.rules.size() - 1;
+}
+
+int alarmAddFrameHigh(AlarmEngine& engine, TempStatsEngine& stats, int threshold)
+{
+    Area_t full = {0, 0, stats.width, stats.height};
+    AlarmRule rule;
+    rule.roi = tempStatsAddRect(stats, full);
+    CV_Assert(rule.roi >= 0);
+    rule.type = ALARM_RULE_HIGH;
+    rule.threshold = threshold;
+    return alarmAddRule(engine, rule);
+}
+
+// 温升速率(kelvin*16 每秒): 与时间窗内最早的采样比较, 采样间隔为 window/kAlarmRiseSamples
+static bool alarmRiseRate(AlarmRule& rule, int value, int64_t now_ns, int& rate)
+{
+    const int64_t window_ns = (int64_t)rule.window_ms * 1000000;
+    int newest = (rule.rise_head + kAlarmRiseSamples - 1) % kAlarmRiseSamples;
+    if (rule.rise_num == 0 || now_ns - rule.rise_ns[newest] >= window_ns / kAlarmRiseSamples) {
+        rule.rise_ns[rule.rise_head] = now_ns;
+        rule.rise_value[rule.rise_head] = value;
+        rule.rise_head = (rule.rise_head + 1) % kAlarmRiseSamples;
+        rule.rise_num = std::min(rule.rise_num + 1, kAlarmRiseSamples);
+    }
+    int oldest = (rule.rise_head + kAlarmRiseSamples - rule.rise_num) % kAlarmRiseSamples;
+    int64_t dt = now_ns - rule.rise_ns[oldest];
+    // 历史不足半个时间窗时不判断, 避免短间隔上的噪声
+    if (dt < window_ns / 2) {
+        return false;
+    }
+    rate = (int)((int64_t)(value - rule.rise_value[oldest]) * 1000000000 / dt);
+    return true;
+}
+
+void alarmEvaluate(AlarmEngine& engine, TempStatsEngine& stats, const cv::Mat& temp, int64_t frame_ns)
+{
+    tempStatsCompute(stats, temp);
+
+    for (size_t i = 0; i < engine.rules.size(); i++) {
+        AlarmRule& rule = engine.rules[i];
+        CV_Assert(rule.roi >= 0 && rule.roi < (int)stats.results.size());
+        const TempInfo_t& info = stats.results[rule.roi];
+        int value;
+        Dot_t cord;
+        bool raise, clear;
+        if (rule.type == ALARM_RULE_LOW) {
+            value = info.min_temp;
+            cord = info.min_cord;
+            raise = value < rule.threshold;
+            clear = value > rule.threshold + rule.hysteresis;
+        }
+        else {
+            value = info.max_temp;
+            cord = info.max_cord;
+            if (rule.type == ALARM_RULE_RISE && !alarmRiseRate(rule, value, frame_ns, value)) {
+                continue;
+            }
+            raise = value > rule.threshold;
+            clear = value < rule.threshold - rule.hysteresis;
+        }
+
+        // 去抖: 条件需连续满足, 中断则重新计数
+        bool cond = rule.active ? clear : raise;
+        rule.counter = cond ? rule.counter + 1 : 0;
+        if (rule.counter < (rule.active ? rule.clear_frames : rule.raise_frames)) {
+            continue;
+        }
+        rule.active = !rule.active;
+        rule.counter = 0;
+
+        AlarmEvent event;
+        event.rule = (int)i;
+        event.roi = rule.roi;
+        event.type = rule.type;
+        event.event = rule.active ? ALARM_EVENT_RAISE : ALARM_EVENT_CLEAR;
+        event.value = value;
+        event.cord = cord;
+        event.frame_ns = frame_ns;
+        event.emit_ns = alarmNowNs();
+        alarmQueuePush(engine.queue, event);
+    }
+
+    int64_t latency = alarmNowNs() - frame_ns;
+    engine.latency_last_ns = latency;
+    engine.latency_max_ns = std::max(engine.latency_max_ns, latency);
+    engine.latency_sum_ns += latency;
+    engine.latency_count++;
+}
@@ -0,0 +1,1388 @@
+#include "algorithm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+// ===================== 时域降噪 ======================
+void resetTemporalDenoise(TemporalDenoiseState& state)
+{
+    state.valid = false;
+}
+
+// 单行递归滤波: h' = h*(256-w)/256 + cur*w, 输出 (h'+128)>>8
+static void temporalDenoiseRow(const uchar* cur, ushort* hist, uchar* out, int len,
+                               int motion_low, int slope, int static_weight)
+{
+    int x = 0;
+#if CV_SIMD128
+    const cv::v_uint16x8 v_low = cv::v_setall_u16((ushort)motion_low);
+    const cv::v_uint16x8 v_slope = cv::v_setall_u16((ushort)slope);
+    const cv::v_uint16x8 v_wmin = cv::v_setall_u16((ushort)static_weight);
+    const cv::v_uint16x8 v_one = cv::v_setall_u16(256);
+    for (; x <= len - 16; x += 16) {
+        cv::v_uint16x8 c0, c1;
+        cv::v_expand(cv::v_load(cur + x), c0, c1);
+        cv::v_uint16x8 h0 = cv::v_load(hist + x);
+        cv::v_uint16x8 h1 = cv::v_load(hist + x + 8);
+
+        // 运动量: 当前帧与历史帧(取整到8位)的绝对差
+        cv::v_uint16x8 p0 = (h0 + cv::v_setall_u16(128)) >> 8;
+        cv::v_uint16x8 p1 = (h1 + cv::v_setall_u16(128)) >> 8;
+        // 16位无符号加减乘均为饱和运算, 无需额外钳位下界
+        cv::v_uint16x8 w0 = cv::v_min((cv::v_absdiff(c0, p0) - v_low) * v_slope + v_wmin, v_one);
+        cv::v_uint16x8 w1 = cv::v_min((cv::v_absdiff(c1, p1) - v_low) * v_slope + v_wmin, v_one);
+
+        h0 = cv::v_mul_hi(h0, (v_one - w0) << 8) + cv::v_mul_wrap(c0, w0);
+        h1 = cv::v_mul_hi(h1, (v_one - w1) << 8) + cv::v_mul_wrap(c1, w1);
+        cv::v_store(hist + x, h0);
+        cv::v_store(hist + x + 8, h1);
+        cv::v_store(out + x, cv::v_rshr_pack<8>(h0, h1));
+    }
+#endif
+    for (; x < len; x++) {
+        int c = cur[x];
+        int h = hist[x];
+        int d = std::abs(c - std::min((h + 128) >> 8, 255));
+        int w = std::min(std::max(d - motion_low, 0) * slope + static_weight, 256);
+        h = ((h * (256 - w)) >> 8) + c * w;
+        h = std::min(h, 65535);
+        hist[x] = (ushort)h;
+        out[x] = (uchar)std::min((h + 128) >> 8, 255);
+    }
+}
+
+void temporalDenoise(TemporalDenoiseState& state, const cv::Mat& src, cv::Mat& dst)
+{
+    CV_Assert(src.depth() == CV_8U);
+    const TemporalDenoiseParams& p = state.params;
+    CV_Assert(p.motion_high > p.motion_low && p.static_weight > 0 && p.static_weight <= 256);
+
+    int cn = src.channels();
+    int len = src.cols * cn;
+    dst.create(src.size(), src.type());
+
+    // 尺寸或格式变化时历史帧失效, 与复位同样处理
+    if (!state.valid || state.history.size() != src.size() ||
+        state.history.type() != CV_MAKETYPE(CV_16U, cn)) {
+        state.history.create(src.size(), CV_MAKETYPE(CV_16U, cn));
+        for (int y = 0; y < src.rows; y++) {
+            const uchar* s = src.ptr<uchar>(y);
+            ushort* h = state.history.ptr<ushort>(y);
+            for (int x = 0; x < len; x++) {
+                h[x] = (ushort)(s[x] << 8);
+            }
+        }
+        if (dst.data != src.data) {
+            src.copyTo(dst);
+        }
+        state.valid = true;
+        return;
+    }
+
+    int slope = std::max(1, (256 - p.static_weight + (p.motion_high - p.motion_low) / 2) /
+                            (p.motion_high - p.motion_low));
+    for (int y = 0; y < src.rows; y++) {
+        temporalDenoiseRow(src.ptr<uchar>(y), state.history.ptr<ushort>(y), dst.ptr<uchar>(y),
+                           len, p.motion_low, slope, p.static_weight);
+    }
+}
+
+// ===================== 场景非均匀校正 ======================
+void resetSbnuc(SbnucState& state)
+{
+    state.valid = false;
+}
+
+// 校正后亮度(Q4): (g << 4) - round(o / 16), 左右各扩展 1 个元素
+static void sbnucLumaRow(const uchar* g, const short* o, short* yrow, int width)
+{
+    int x = 0;
+#if CV_SIMD128
+    const cv::v_int16x8 v_8 = cv::v_setall_s16(8);
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint16x8 g0, g1;
+        cv::v_expand(cv::v_load(g + x), g0, g1);
+        cv::v_int16x8 o0 = (cv::v_load(o + x) + v_8) >> 4;
+        cv::v_int16x8 o1 = (cv::v_load(o + x + 8) + v_8) >> 4;
+        cv::v_store(yrow + x, (cv::v_reinterpret_as_s16(g0) << 4) - o0);
+        cv::v_store(yrow + x + 8, (cv::v_reinterpret_as_s16(g1) << 4) - o1);
+    }
+#endif
+    for (; x < width; x++) {
+        yrow[x] = (short)((g[x] << 4) - ((o[x] + 8) >> 4));
+    }
+    yrow[-1] = yrow[0];
+    yrow[width] = yrow[width - 1];
+}
+
+// 输出校正结果(更新前的偏移), 再按约束 LMS 更新偏移, 返回本行偏移之和
+template<int CN>
+static int64_t sbnucRow(const short* up, const short* mid, const short* down, const uchar* motion,
+                        const uchar* src, uchar* dst, short* o, int width, bool update,
+                        int shift, int edge_q4, int max_q8)
+{
+    int x = 0;
+    int64_t sum = 0;
+#if CV_SIMD128
+    const cv::v_int16x8 v_2 = cv::v_setall_s16(2), v_8 = cv::v_setall_s16(8);
+    const cv::v_int16x8 v_rnd = cv::v_setall_s16((short)(1 << (shift - 1)));
+    const cv::v_uint16x8 v_edge = cv::v_setall_u16((ushort)edge_q4);
+    const cv::v_int16x8 v_max = cv::v_setall_s16((short)max_q8), v_min = cv::v_setall_s16((short)-max_q8);
+    const cv::v_int16x8 v_zero = cv::v_setzero_s16();
+    cv::v_int32x4 v_sum = cv::v_setzero_s32();
+    for (; x <= width - 16; x += 16) {
+        cv::v_int16x8 m[2] = {cv::v_load(mid + x), cv::v_load(mid + x + 8)};
+        cv::v_int16x8 ov[2] = {cv::v_load(o + x), cv::v_load(o + x + 8)};
+        if (CN == 1) {
+            cv::v_store(dst + x, cv::v_rshr_pack_u<4>(m[0], m[1]));
+        }
+        else {
+            cv::v_int16x8 oq[2] = {(ov[0] + v_8) >> 4, (ov[1] + v_8) >> 4};
+            cv::v_uint8x16 c[3];
+            cv::v_load_deinterleave(src + x * 3, c[0], c[1], c[2]);
+            for (int k = 0; k < 3; k++) {
+                cv::v_uint16x8 c0, c1;
+                cv::v_expand(c[k], c0, c1);
+                c[k] = cv::v_rshr_pack_u<4>((cv::v_reinterpret_as_s16(c0) << 4) - oq[0],
+                                            (cv::v_reinterpret_as_s16(c1) << 4) - oq[1]);
+            }
+            cv::v_store_interleave(dst + x * 3, c[0], c[1], c[2]);
+        }
+        if (!update) {
+            continue;
+        }
+        cv::v_uint16x8 mo[2];
+        cv::v_expand(cv::v_load(motion + x), mo[0], mo[1]);
+        for (int k = 0; k < 2; k++) {
+            const int i = x + k * 8;
+            cv::v_int16x8 nb = cv::v_load(up + i) + cv::v_load(down + i) +
+                               cv::v_load(mid + i - 1) + cv::v_load(mid + i + 1);
+            cv::v_int16x8 e = m[k] - ((nb + v_2) >> 2);
+            cv::v_int16x8 mask = (cv::v_reinterpret_as_s16(mo[k]) > v_zero) &
+                                 cv::v_reinterpret_as_s16(cv::v_abs(e) < v_edge);
+            cv::v_int16x8 on = ov[k] + (((e + v_rnd) >> shift) & mask);
+            on = cv::v_max(cv::v_min(on, v_max), v_min);
+            cv::v_store(o + i, on);
+            cv::v_int32x4 s0, s1;
+            cv::v_expand(on, s0, s1);
+            v_sum += s0 + s1;
+        }
+    }
+    sum = cv::v_reduce_sum(v_sum);
+#endif
+    for (; x < width; x++) {
+        int oq = (o[x] + 8) >> 4;
+        if (CN == 1) {
+            dst[x] = cv::saturate_cast<uchar>((mid[x] + 8) >> 4);
+        }
+        else {
+            for (int k = 0; k < 3; k++) {
+                dst[x * 3 + k] = cv::saturate_cast<uchar>(((src[x * 3 + k] << 4) - oq + 8) >> 4);
+            }
+        }
+        if (!update) {
+            continue;
+        }
+        int e = mid[x] - ((up[x] + down[x] + mid[x - 1] + mid[x + 1] + 2) >> 2);
+        int on = o[x];
+        if (motion[x] && std::abs(e) < edge_q4) {
+            on += (e + (1 << (shift - 1))) >> shift;
+        }
+        on = std::min(std::max(on, -max_q8), max_q8);
+        o[x] = (short)on;
+        sum += on;
+    }
+    return sum;
+}
+
+void sceneBasedNuc(SbnucState& state, const cv::Mat& src, cv::Mat& dst)
+{
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+    const SbnucParams& p = state.params;
+    if (!p.enabled) {
+        if (dst.data != src.data) {
+            src.copyTo(dst);
+        }
+        return;
+    }
+    CV_Assert(p.lms_shift >= 5 && p.lms_shift <= 12);
+    CV_Assert(p.max_offset > 0 && p.max_offset < 128);
+
+    const int rows = src.rows, width = src.cols, cn = src.channels();
+    if (cn == 3) {
+        cv::cvtColor(src, state.gray, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        src.copyTo(state.gray);
+    }
+    // 首帧或尺寸变化时偏移表清零, 以当前帧作为上一帧(本帧不更新)
+    if (!state.valid || state.offset.size() != src.size()) {
+        state.offset = cv::Mat::zeros(src.size(), CV_16SC1);
+        state.gray.copyTo(state.prev);
+        state.valid = true;
+    }
+
+    // 运动掩码, 运动像素过少时整帧只校正不更新
+    cv::absdiff(state.gray, state.prev, state.motion);
+    cv::threshold(state.motion, state.motion, p.motion_threshold, 255, cv::THRESH_BINARY);
+    int moving = cv::countNonZero(state.motion);
+    bool update = (int64_t)moving * 1000 >= (int64_t)p.min_motion_permille * rows * width;
+
+    dst.create(src.size(), src.type());
+    std::vector<short> ring(3 * (size_t)(width + 2));
+    int ring_row[3] = {-1, -1, -1};
+    int64_t sum = 0;
+    for (int y = 0; y < rows; y++) {
+        // 上下边界按 BORDER_REPLICATE, 环形缓冲中的行均用更新前的偏移计算
+        const short* r[3];
+        for (int k = 0; k < 3; k++) {
+            int yy = std::min(std::max(y - 1 + k, 0), rows - 1);
+            short* slot = &ring[(yy % 3) * (size_t)(width + 2)] + 1;
+            if (ring_row[yy % 3] != yy) {
+                sbnucLumaRow(state.gray.ptr<uchar>(yy), state.offset.ptr<short>(yy), slot, width);
+                ring_row[yy % 3] = yy;
+            }
+            r[k] = slot;
+        }
+        if (cn == 1) {
+            sum += sbnucRow<1>(r[0], r[1], r[2], state.motion.ptr<uchar>(y), src.ptr<uchar>(y),
+                               dst.ptr<uchar>(y), state.offset.ptr<short>(y), width, update,
+                               p.lms_shift - 4, p.edge_threshold * 16, p.max_offset * 256);
+        }
+        else {
+            sum += sbnucRow<3>(r[0], r[1], r[2], state.motion.ptr<uchar>(y), src.ptr<uchar>(y),
+                               dst.ptr<uchar>(y), state.offset.ptr<short>(y), width, update,
+                               p.lms_shift - 4, p.edge_threshold * 16, p.max_offset * 256);
+        }
+    }
+
+    // 约束: 偏移整体均值保持为 0, 不改变画面平均亮度
+    if (update) {
+        int mean = (int)(sum / ((int64_t)rows * width));
+        if (std::abs(mean) >= 16) {
+            cv::subtract(state.offset, cv::Scalar(mean), state.offset);
+        }
+    }
+    state.updated = update;
+    std::swap(state.gray, state.prev);
+}
+
+double nucRoughness(const cv::Mat& img)
+{
+    cv::Mat gray = img;
+    if (img.channels() == 3) {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    double grad = 0, total = 0;
+    for (int y = 0; y < gray.rows; y++) {
+        const uchar* g = gray.ptr<uchar>(y);
+        const uchar* n = gray.ptr<uchar>(std::min(y + 1, gray.rows - 1));
+        for (int x = 0; x < gray.cols; x++) {
+            grad += std::abs(g[std::min(x + 1, gray.cols - 1)] - g[x]) + std::abs(n[x] - g[x]);
+            total += g[x];
+        }
+    }
+    return total > 0 ? grad / total : 0;
+}
+
+// ===================== CLAHE 与边缘算子 ======================
+void do_CLAHE(cv::Mat& src,cv::Mat& dst){
+    //int clip_limit = 3; // 定义限制对比度的参数  best_config
+//    int clip_limit = 4.5; // 定义限制对比度的参数
+    double clip_limit = kClaheClipDefault; // 定义限制对比度的参数
+    int tile_size = 1; // 定义块的大小
+
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
+    clahe->apply(src, dst); // 应用CLAHE算法
+}
+
+void do_CLAHE_sobelprewitt(cv::Mat& src,cv::Mat& dst){
+    //int clip_limit = 3; // 定义限制对比度的参数  best_config
+//    int clip_limit = 4.5; // 定义限制对比度的参数
+    double clip_limit = kClaheClipSobelPrewitt; // 定义限制对比度的参数
+    int tile_size = 1; // 定义块的大小
+
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
+    clahe->apply(src, dst); // 应用CLAHE算法
+}
+
+void do_CLAHE_edge(cv::Mat& src,cv::Mat& dst){
+    double clip_limit = kClaheClipKirsch; // 定义限制对比度的参数
+    //int tile_size = 8; // 定义块的大小
+    int tile_size = 1; // 定义块的大小
+
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
+    clahe->apply(src, dst); // 应用CLAHE算法
+}
+
+
+void do_CLAHE_edge_Frei_Chen(cv::Mat& src,cv::Mat& dst){
+    double clip_limit = kClaheClipFreiChen; // 定义限制对比度的参数
+    //int tile_size = 8; // 定义块的大小
+    int tile_size = 1; // 定义块的大小
+
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
+    clahe->apply(src, dst); // 应用CLAHE算法
+}
+
+
+cv::Mat SobelPrewitt(cv::Mat img) {
+    // ---------------- Sobel 边缘检测 ----------------
+    cv::Mat sobel_x, sobel_y, sobel_magnitude;
+    cv::Sobel(img, sobel_x, CV_64F, 1, 0, 3);
+    cv::Sobel(img, sobel_y, CV_64F, 0, 1, 3);
+    cv::magnitude(sobel_x, sobel_y, sobel_magnitude);
+
+    // ---------------- Prewitt 边缘检测 ----------------
+    cv::Mat prewitt_x, prewitt_y, prewitt_magnitude;
+    cv::Mat kernel_prewitt_x = (cv::Mat_<float>(3,3) << -1, 0, 1,
+                                                        -1, 0, 1,
+                                                        -1, 0, 1);
+    cv::Mat kernel_prewitt_y = (cv::Mat_<float>(3,3) <<  1,  1,  1,
+                                                         0,  0,  0,
+                                                        -1, -1, -1);
+    cv::filter2D(img, prewitt_x, CV_64F, kernel_prewitt_x);
+    cv::filter2D(img, prewitt_y, CV_64F, kernel_prewitt_y);
+    cv::magnitude(prewitt_x, prewitt_y, prewitt_magnitude);
+
+    // ---------------- 综合两者 ----------------
+    cv::Mat combined_magnitude_64F;
+    cv::addWeighted(sobel_magnitude, 0.5, prewitt_magnitude, 0.5, 0, combined_magnitude_64F);
+
+    // 将最终结果转换为 CV_8U 以便显示或保存
+    cv::Mat combined_magnitude_8U;
+    combined_magnitude_64F.convertTo(combined_magnitude_8U, CV_8U);
+
+    return combined_magnitude_8U;
+}
+
+
+cv::Mat Kirsch(cv::Mat img){
+   // 定义 8 个 Kirsch 卷积核
+   std::vector<cv::Mat> kirsch_kernels = {
+       (cv::Mat_<float>(3,3) <<  5,  5,  5,
+                                -3,  0, -3,
+                                -3, -3, -3), // N
+
+       (cv::Mat_<float>(3,3) <<  5,  5, -3,
+                                 5,  0, -3,
+                                -3, -3, -3), // NE
+
+       (cv::Mat_<float>(3,3) <<  5, -3, -3,
+                                 5,  0, -3,
+                                 5, -3, -3), // E
+
+       (cv::Mat_<float>(3,3) << -3, -3, -3,
+                                 5,  0, -3,
+                                 5,  5, -3), // SE
+
+       (cv::Mat_<float>(3,3) << -3, -3, -3,
+                                -3,  0, -3,
+                                 5,  5,  5), // S
+
+       (cv::Mat_<float>(3,3) << -3, -3, -3,
+                                -3,  0,  5,
+                                -3,  5,  5), // SW
+
+       (cv::Mat_<float>(3,3) << -3, -3,  5,
+                                -3,  0,  5,
+                                -3, -3,  5), // W
+
+       (cv::Mat_<float>(3,3) << -3,  5,  5,
+                                -3,  0,  5,
+                                -3, -3, -3)  // NW
+   };
+
+   // 初始化最大响应图
+   cv::Mat max_response = cv::Mat::zeros(img.size(), CV_32F);
+
+   // 对每个方向卷积并保留最大值
+   for (const auto& kernel : kirsch_kernels) {
+       cv::Mat response;
+       cv::filter2D(img, response, CV_32F, kernel);
+       cv::max(max_response, response, max_response);
+   }
+
+   // 转换为 8 位图像以便显示
+   cv::Mat kirsch_edge;
+   max_response.convertTo(kirsch_edge, CV_8U);
+
+   return kirsch_edge;
+}
+
+// ===================== 非锐化掩模 ======================
+// 常用 (ksize, sigma) 的 Q8 高斯系数, 每组和为 256
+struct UsmCoefTable {
+    int ksize;
+    double sigma;
+    ushort coef[7];
+};
+
+static const UsmCoefTable kUsmCoefTables[] = {
+    {3, 0.8, {61, 134, 61}},
+    {3, 1.0, {70, 116, 70}},
+    {5, 1.0, {14, 63, 102, 63, 14}},
+    {5, 1.5, {31, 60, 74, 60, 31}},
+    {7, 1.5, {9, 28, 55, 72, 55, 28, 9}},
+    {7, 2.0, {18, 34, 49, 54, 49, 34, 18}},
+};
+
+// 查表或现场计算 Q8 系数, 中心系数吸收舍入误差
+static void usmGaussianCoef(int ksize, double sigma, ushort* coef)
+{
+    for (size_t i = 0; i < sizeof(kUsmCoefTables) / sizeof(kUsmCoefTables[0]); i++) {
+        const UsmCoefTable& t = kUsmCoefTables[i];
+        if (t.ksize == ksize && std::abs(t.sigma - sigma) < 1e-6) {
+            std::copy(t.coef, t.coef + ksize, coef);
+            return;
+        }
+    }
+
+    int r = ksize / 2;
+    double g[15];
+    double total = 0;
+    for (int i = 0; i < ksize; i++) {
+        g[i] = std::exp(-(double)((i - r) * (i - r)) / (2 * sigma * sigma));
+        total += g[i];
+    }
+    int sum = 0;
+    for (int i = 0; i < ksize; i++) {
+        coef[i] = (ushort)cvRound(g[i] / total * 256);
+        sum += coef[i];
+    }
+    coef[r] = (ushort)(coef[r] + 256 - sum);
+}
+
+// 竖直卷积: rows 为 KSIZE 个源行, 结果为 Q8 定点(最大 255*256, 不会溢出16位)
+template<int KSIZE>
+static void usmVerticalRow(const uchar* const* rows, const ushort* coef, ushort* vrow, int len)
+{
+    int x = 0;
+#if CV_SIMD128
+    cv::v_uint16x8 vc[KSIZE];
+    for (int k = 0; k < KSIZE; k++) {
+        vc[k] = cv::v_setall_u16(coef[k]);
+    }
+    for (; x <= len - 16; x += 16) {
+        cv::v_uint16x8 acc0 = cv::v_setzero_u16(), acc1 = cv::v_setzero_u16();
+        for (int k = 0; k < KSIZE; k++) {
+            cv::v_uint16x8 p0, p1;
+            cv::v_expand(cv::v_load(rows[k] + x), p0, p1);
+            acc0 += cv::v_mul_wrap(p0, vc[k]);
+            acc1 += cv::v_mul_wrap(p1, vc[k]);
+        }
+        cv::v_store(vrow + x, acc0);
+        cv::v_store(vrow + x + 8, acc1);
+    }
+#endif
+    for (; x < len; x++) {
+        int acc = 0;
+        for (int k = 0; k < KSIZE; k++) {
+            acc += rows[k][x] * coef[k];
+        }
+        vrow[x] = (ushort)acc;
+    }
+}
+
+// 水平卷积: vrow 左右各带 KSIZE/2*cn 的复制边界, 输出取整后的 8 位模糊行
+template<int KSIZE>
+static void usmHorizontalRow(const ushort* vrow, const ushort* coef, uchar* blur, int len, int cn)
+{
+    const int r = KSIZE / 2;
+    int x = 0;
+#if CV_SIMD128
+    // mul_hi(v, c<<8) = v*c>>8, 结果保持 Q8 且全程 16 位
+    cv::v_uint16x8 vc[KSIZE];
+    for (int k = 0; k < KSIZE; k++) {
+        vc[k] = cv::v_setall_u16((ushort)(coef[k] << 8));
+    }
+    for (; x <= len - 16; x += 16) {
+        cv::v_uint16x8 acc0 = cv::v_setzero_u16(), acc1 = cv::v_setzero_u16();
+        for (int k = 0; k < KSIZE; k++) {
+            const ushort* p = vrow + x + (k - r) * cn;
+            acc0 += cv::v_mul_hi(cv::v_load(p), vc[k]);
+            acc1 += cv::v_mul_hi(cv::v_load(p + 8), vc[k]);
+        }
+        cv::v_store(blur + x, cv::v_rshr_pack<8>(acc0, acc1));
+    }
+#endif
+    for (; x < len; x++) {
+        int acc = 0;
+        for (int k = 0; k < KSIZE; k++) {
+            acc += (vrow[x + (k - r) * cn] * coef[k]) >> 8;
+        }
+        blur[x] = (uchar)std::min((acc + 128) >> 8, 255);
+    }
+}
+
+// out = src + (strength*(src - blur) + 128) >> 8, 饱和到 8 位
+static void usmCombineRow(const uchar* src, const uchar* blur, uchar* out, int len, short strength)
+{
+    int x = 0;
+#if CV_SIMD128
+    const cv::v_int16x8 vs = cv::v_setall_s16(strength);
+    for (; x <= len - 16; x += 16) {
+        cv::v_uint16x8 s0, s1, b0, b1;
+        cv::v_expand(cv::v_load(src + x), s0, s1);
+        cv::v_expand(cv::v_load(blur + x), b0, b1);
+        cv::v_int16x8 i0 = cv::v_reinterpret_as_s16(s0), i1 = cv::v_reinterpret_as_s16(s1);
+        cv::v_int32x4 d0, d1, d2, d3;
+        cv::v_mul_expand(i0 - cv::v_reinterpret_as_s16(b0), vs, d0, d1);
+        cv::v_mul_expand(i1 - cv::v_reinterpret_as_s16(b1), vs, d2, d3);
+        cv::v_int16x8 o0 = i0 + cv::v_rshr_pack<8>(d0, d1);
+        cv::v_int16x8 o1 = i1 + cv::v_rshr_pack<8>(d2, d3);
+        cv::v_store(out + x, cv::v_pack_u(o0, o1));
+    }
+#endif
+    for (; x < len; x++) {
+        int d = (src[x] - blur[x]) * strength;
+        out[x] = cv::saturate_cast<uchar>(src[x] + ((d + 128) >> 8));
+    }
+}
+
+// 亮度模式: 细节量由亮度行计算, 叠加到 BGR 三个通道
+static void usmCombineLumaRow(const uchar* bgr, const uchar* luma, const uchar* blur, uchar* out,
+                              int width, short strength)
+{
+    int x = 0;
+#if CV_SIMD128
+    const cv::v_int16x8 vs = cv::v_setall_s16(strength);
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint16x8 y0, y1, b0, b1;
+        cv::v_expand(cv::v_load(luma + x), y0, y1);
+        cv::v_expand(cv::v_load(blur + x), b0, b1);
+        cv::v_int32x4 d0, d1, d2, d3;
+        cv::v_mul_expand(cv::v_reinterpret_as_s16(y0) - cv::v_reinterpret_as_s16(b0), vs, d0, d1);
+        cv::v_mul_expand(cv::v_reinterpret_as_s16(y1) - cv::v_reinterpret_as_s16(b1), vs, d2, d3);
+        cv::v_int16x8 t0 = cv::v_rshr_pack<8>(d0, d1);
+        cv::v_int16x8 t1 = cv::v_rshr_pack<8>(d2, d3);
+
+        cv::v_uint8x16 c[3];
+        cv::v_load_deinterleave(bgr + x * 3, c[0], c[1], c[2]);
+        for (int i = 0; i < 3; i++) {
+            cv::v_uint16x8 c0, c1;
+            cv::v_expand(c[i], c0, c1);
+            c[i] = cv::v_pack_u(cv::v_reinterpret_as_s16(c0) + t0, cv::v_reinterpret_as_s16(c1) + t1);
+        }
+        cv::v_store_interleave(out + x * 3, c[0], c[1], c[2]);
+    }
+#endif
+    for (; x < width; x++) {
+        int t = ((luma[x] - blur[x]) * strength + 128) >> 8;
+        for (int i = 0; i < 3; i++) {
+            out[x * 3 + i] = cv::saturate_cast<uchar>(bgr[x * 3 + i] + t);
+        }
+    }
+}
+
+template<int KSIZE>
+static void unsharpMaskRows(const cv::Mat& src, cv::Mat& dst, const ushort* coef, short strength,
+                            bool luma_only)
+{
+    const int r = KSIZE / 2;
+    const int rows = src.rows;
+    const int width = src.cols;
+    const int cn = luma_only ? 1 : src.channels();
+    const int len = width * cn;
+    const int pad = r * cn;
+
+    std::vector<ushort> vbuf(len + 2 * pad);
+    std::vector<uchar> blur(len);
+    ushort* vrow = &vbuf[pad];
+
+    // 亮度模式下用 KSIZE 行环形缓冲保存灰度行, 每行只转换一次
+    std::vector<uchar> ring;
+    cv::Mat ring_mat;
+    if (luma_only) {
+        ring.resize((size_t)KSIZE * width);
+        ring_mat = cv::Mat(KSIZE, width, CV_8UC1, &ring[0]);
+    }
+    int next_luma = 0;
+
+    const uchar* row_ptr[KSIZE];
+    for (int y = 0; y < rows; y++) {
+        if (luma_only) {
+            for (; next_luma <= std::min(y + r, rows - 1); next_luma++) {
+                cv::Mat bgr_row(1, width, src.type(), (void*)src.ptr<uchar>(next_luma));
+                cv::Mat gray_row = ring_mat.row(next_luma % KSIZE);
+                cv::cvtColor(bgr_row, gray_row, cv::COLOR_BGR2GRAY);
+            }
+        }
+        for (int k = 0; k < KSIZE; k++) {
+            int sy = std::min(std::max(y + k - r, 0), rows - 1);
+            row_ptr[k] = luma_only ? &ring[(size_t)(sy % KSIZE) * width] : src.ptr<uchar>(sy);
+        }
+
+        usmVerticalRow<KSIZE>(row_ptr, coef, vrow, len);
+        for (int i = 0; i < pad; i++) {
+            vrow[i - pad] = vrow[i % cn];
+            vrow[len + i] = vrow[len - cn + i % cn];
+        }
+        usmHorizontalRow<KSIZE>(vrow, coef, &blur[0], len, cn);
+
+        if (luma_only) {
+            usmCombineLumaRow(src.ptr<uchar>(y), row_ptr[r], &blur[0], dst.ptr<uchar>(y), width, strength);
+        }
+        else {
+            usmCombineRow(src.ptr<uchar>(y), &blur[0], dst.ptr<uchar>(y), len, strength);
+        }
+    }
+}
+
+void unsharpMaskFixed(const cv::Mat& src, cv::Mat& dst, double sigma, double strength,
+                      int ksize, bool luma_only)
+{
+    CV_Assert(src.depth() == CV_8U);
+    CV_Assert(ksize > 0 && ksize % 2 == 1 && ksize <= 15);
+    CV_Assert(strength >= 0 && strength < 128);
+
+    if (sigma <= 0) {
+        sigma = 0.3 * ((ksize - 1) * 0.5 - 1) + 0.8;
+    }
+    ushort coef[15];
+    usmGaussianCoef(ksize, sigma, coef);
+
+    // 核退化为单点(ksize=1 或 sigma 过小)时模糊图等于原图, 无锐化效果
+    if (coef[ksize / 2] >= 256) {
+        src.copyTo(dst);
+        return;
+    }
+
+    // 逐行处理需要读取已输出行的上方邻域, 原地调用时写入新缓冲
+    cv::Mat out;
+    if (dst.data == src.data) {
+        out.create(src.size(), src.type());
+    }
+    else {
+        dst.create(src.size(), src.type());
+        out = dst;
+    }
+
+    luma_only = luma_only && src.channels() == 3;
+    short s = (short)cvRound(strength * 256);
+    switch (ksize) {
+    case 3:  unsharpMaskRows<3>(src, out, coef, s, luma_only); break;
+    case 5:  unsharpMaskRows<5>(src, out, coef, s, luma_only); break;
+    case 7:  unsharpMaskRows<7>(src, out, coef, s, luma_only); break;
+    case 9:  unsharpMaskRows<9>(src, out, coef, s, luma_only); break;
+    case 11: unsharpMaskRows<11>(src, out, coef, s, luma_only); break;
+    case 13: unsharpMaskRows<13>(src, out, coef, s, luma_only); break;
+    default: unsharpMaskRows<15>(src, out, coef, s, luma_only); break;
+    }
+    dst = out;
+}
+
+// ===================== Frei-Chen 边缘 ======================
+cv::Mat Frei_Chen(cv::Mat img) {
+    // 定义 sqrt(2)
+    float sqrt2 = std::sqrt(2.0f);
+
+    // Frei-Chen X方向卷积核
+    cv::Mat kernel_x = (cv::Mat_<float>(3, 3) <<
+        1,      sqrt2,  1,
+        0,      0,      0,
+       -1,     -sqrt2, -1);
+
+    // Frei-Chen Y方向卷积核
+    cv::Mat kernel_y = (cv::Mat_<float>(3, 3) <<
+         1,     0,    -1,
+         sqrt2, 0, -sqrt2,
+         1,     0,    -1);
+
+    // 进行卷积运算
+    cv::Mat frei_x, frei_y;
+    cv::filter2D(img, frei_x, CV_32F, kernel_x);
+    cv::filter2D(img, frei_y, CV_32F, kernel_y);
+
+    // 计算幅值图
+    cv::Mat magnitude;
+    cv::magnitude(frei_x, frei_y, magnitude);
+
+    // 转换为 8 位图像
+    cv::Mat edge_output;
+    magnitude.convertTo(edge_output, CV_8U);
+
+    return edge_output;
+}
+
+// 1/sqrt(2) 的 Q15 表示(32768/sqrt(2)); 与 B<<6 做 mul_hi(右移 16 位): B*64*23170/65536 = 16*sqrt(2)*B,
+// 即 Q4 的 sqrt(2)*B
+static const int kFreiChenInvSqrt2Q15 = 23170;
+// 幅值近似 max(hi + 0.155*lo, 0.845*hi + 0.555*lo) 的 Q16 系数
+static const int kMagB1 = 10158;
+static const int kMagA2 = 55378;
+static const int kMagB2 = 36372;
+
+static inline int freiChenFastPixel(int tl, int tc, int tr, int ml, int mr, int bl, int bc, int br)
+{
+    int gx = ((tl + tr - bl - br) << 4) + (((tc - bc) * 64 * kFreiChenInvSqrt2Q15) >> 16);
+    int gy = ((tl + bl - tr - br) << 4) + (((ml - mr) * 64 * kFreiChenInvSqrt2Q15) >> 16);
+    int ax = std::abs(gx), ay = std::abs(gy);
+    int hi = std::max(ax, ay), lo = std::min(ax, ay);
+    int mag = std::max(hi + ((lo * kMagB1) >> 16), ((hi * kMagA2) >> 16) + ((lo * kMagB2) >> 16));
+    return std::min((mag + 8) >> 4, 255);
+}
+
+#if CV_SIMD128
+// 8 个像素的 Q4 幅值, t/m/b 指向上/中/下三行的 x-1 处
+static inline cv::v_uint16x8 freiChenFastVec(const uchar* t, const uchar* m, const uchar* b)
+{
+    cv::v_int16x8 tl = cv::v_reinterpret_as_s16(cv::v_load_expand(t));
+    cv::v_int16x8 tc = cv::v_reinterpret_as_s16(cv::v_load_expand(t + 1));
+    cv::v_int16x8 tr = cv::v_reinterpret_as_s16(cv::v_load_expand(t + 2));
+    cv::v_int16x8 ml = cv::v_reinterpret_as_s16(cv::v_load_expand(m));
+    cv::v_int16x8 mr = cv::v_reinterpret_as_s16(cv::v_load_expand(m + 2));
+    cv::v_int16x8 bl = cv::v_reinterpret_as_s16(cv::v_load_expand(b));
+    cv::v_int16x8 bc = cv::v_reinterpret_as_s16(cv::v_load_expand(b + 1));
+    cv::v_int16x8 br = cv::v_reinterpret_as_s16(cv::v_load_expand(b + 2));
+    const cv::v_int16x8 k = cv::v_setall_s16((short)kFreiChenInvSqrt2Q15);
+
+    cv::v_int16x8 gx = ((tl + tr - bl - br) << 4) + cv::v_mul_hi((tc - bc) << 6, k);
+    cv::v_int16x8 gy = ((tl + bl - tr - br) << 4) + cv::v_mul_hi((ml - mr) << 6, k);
+    cv::v_uint16x8 ax = cv::v_abs(gx), ay = cv::v_abs(gy);
+    cv::v_uint16x8 hi = cv::v_max(ax, ay), lo = cv::v_min(ax, ay);
+    cv::v_uint16x8 m1 = hi + cv::v_mul_hi(lo, cv::v_setall_u16((ushort)kMagB1));
+    cv::v_uint16x8 m2 = cv::v_mul_hi(hi, cv::v_setall_u16((ushort)kMagA2)) +
+                        cv::v_mul_hi(lo, cv::v_setall_u16((ushort)kMagB2));
+    return cv::v_max(m1, m2);
+}
+#endif
+
+// 按 BORDER_REFLECT_101 取邻点计算单个像素
+static inline void freiChenFastAt(const uchar* t, const uchar* m, const uchar* b, uchar* out,
+                                  int x, int width)
+{
+    int xl = x > 0 ? x - 1 : std::min(1, width - 1);
+    int xr = x + 1 < width ? x + 1 : std::max(width - 2, 0);
+    out[x] = (uchar)freiChenFastPixel(t[xl], t[x], t[xr], m[xl], m[xr], b[xl], b[x], b[xr]);
+}
+
+static void freiChenFastRow(const uchar* t, const uchar* m, const uchar* b, uchar* out, int width)
+{
+    freiChenFastAt(t, m, b, out, 0, width);
+    int x = 1;
+#if CV_SIMD128
+    for (; x <= width - 17; x += 16) {
+        cv::v_uint16x8 m0 = freiChenFastVec(t + x - 1, m + x - 1, b + x - 1);
+        cv::v_uint16x8 m1 = freiChenFastVec(t + x + 7, m + x + 7, b + x + 7);
+        cv::v_store(out + x, cv::v_rshr_pack<4>(m0, m1));
+    }
+#endif
+    for (; x < width; x++) {
+        freiChenFastAt(t, m, b, out, x, width);
+    }
+}
+
+// 9 基完整投影(质量模式): 返回 255*sqrt(子空间能量/总能量)
+static void freiChenProjectionRow(const uchar* t, const uchar* m, const uchar* b, uchar* out,
+                                  int width, int mode)
+{
+    const float s2 = 1.41421356f;
+    const float k14 = 1.0f / (2.0f * s2);
+    for (int x = 0; x < width; x++) {
+        int xl = x > 0 ? x - 1 : std::min(1, width - 1);
+        int xr = x + 1 < width ? x + 1 : std::max(width - 2, 0);
+        float p0 = t[xl], p1 = t[x], p2 = t[xr];
+        float p3 = m[xl], p4 = m[x], p5 = m[xr];
+        float p6 = b[xl], p7 = b[x], p8 = b[xr];
+
+        // 正交基下 9 个投影的平方和等于邻域像素平方和
+        float total = p0 * p0 + p1 * p1 + p2 * p2 + p3 * p3 + p4 * p4 +
+                      p5 * p5 + p6 * p6 + p7 * p7 + p8 * p8;
+        float energy;
+        if (mode == FREI_CHEN_EDGE) {
+            float g1 = k14 * (p0 + s2 * p1 + p2 - p6 - s2 * p7 - p8);
+            float g2 = k14 * (p0 + s2 * p3 + p6 - p2 - s2 * p5 - p8);
+            float g3 = k14 * (-p1 + s2 * p2 + p3 - p5 - s2 * p6 + p7);
+            float g4 = k14 * (s2 * p0 - p1 - p3 + p5 + p7 - s2 * p8);
+            energy = g1 * g1 + g2 * g2 + g3 * g3 + g4 * g4;
+        }
+        else {
+            float g5 = 0.5f * (p1 - p3 - p5 + p7);
+            float g6 = 0.5f * (-p0 + p2 + p6 - p8);
+            float g7 = (1.0f / 6.0f) * (p0 - 2 * p1 + p2 - 2 * p3 + 4 * p4 - 2 * p5 + p6 - 2 * p7 + p8);
+            float g8 = (1.0f / 6.0f) * (-2 * p0 + p1 - 2 * p2 + p3 + 4 * p4 + p5 - 2 * p6 + p7 - 2 * p8);
+            energy = g5 * g5 + g6 * g6 + g7 * g7 + g8 * g8;
+        }
+        out[x] = total > 0 ? cv::saturate_cast<uchar>(255.0f * std::sqrt(energy / total)) : 0;
+    }
+}
+
+void freiChenFixed(const cv::Mat& src, cv::Mat& dst, int mode)
+{
+    CV_Assert(src.type() == CV_8UC1);
+
+    cv::Mat out;
+    if (dst.data == src.data) {
+        out.create(src.size(), CV_8UC1);
+    }
+    else {
+        dst.create(src.size(), CV_8UC1);
+        out = dst;
+    }
+
+    int rows = src.rows;
+    for (int y = 0; y < rows; y++) {
+        int yt = y > 0 ? y - 1 : std::min(1, rows - 1);
+        int yb = y + 1 < rows ? y + 1 : std::max(rows - 2, 0);
+        if (mode == FREI_CHEN_FAST) {
+            freiChenFastRow(src.ptr<uchar>(yt), src.ptr<uchar>(y), src.ptr<uchar>(yb),
+                            out.ptr<uchar>(y), src.cols);
+        }
+        else {
+            freiChenProjectionRow(src.ptr<uchar>(yt), src.ptr<uchar>(y), src.ptr<uchar>(yb),
+                                  out.ptr<uchar>(y), src.cols, mode);
+        }
+    }
+    dst = out;
+}
+
+// ===================== 融合流水线 ======================
+void claheGlobalLut(const int* hist, int total, double clip_limit, uchar* lut)
+{
+    const int hist_size = 256;
+    int h[256];
+    std::copy(hist, hist + hist_size, h);
+
+    // 与 cv::CLAHE 相同: 裁剪超出部分, 均匀重分配, 余数按步长补到前面的灰度级
+    if (clip_limit > 0.0) {
+        int limit = std::max(static_cast<int>(clip_limit * total / hist_size), 1);
+        int clipped = 0;
+        for (int i = 0; i < hist_size; i++) {
+            if (h[i] > limit) {
+                clipped += h[i] - limit;
+                h[i] = limit;
+            }
+        }
+        int redist_batch = clipped / hist_size;
+        int residual = clipped - redist_batch * hist_size;
+        for (int i = 0; i < hist_size; i++) {
+            h[i] += redist_batch;
+        }
+        if (residual != 0) {
+            int residual_step = std::max(hist_size / residual, 1);
+            for (int i = 0; i < hist_size && residual > 0; i += residual_step, residual--) {
+                h[i]++;
+            }
+        }
+    }
+
+    float lut_scale = static_cast<float>(hist_size - 1) / total;
+    int sum = 0;
+    for (int i = 0; i < hist_size; i++) {
+        sum += h[i];
+        lut[i] = cv::saturate_cast<uchar>(sum * lut_scale);
+    }
+}
+
+// Kirsch: 每个方向核 = 5*(相邻三点和) - 3*(其余五点和) = 8*三点和 - 3*八邻域和,
+// 最大响应只需取三点和的最大值; 负响应截为 0, 与浮点链路一致
+static inline int kirschPixel(const int* n)
+{
+    int total = 0, best = 0;
+    for (int i = 0; i < 8; i++) {
+        total += n[i];
+        best = std::max(best, n[i] + n[(i + 1) & 7] + n[(i + 2) & 7]);
+    }
+    return std::min(std::max(best * 8 - total * 3, 0), 255);
+}
+
+static inline int sobelPrewittPixel(int tl, int tc, int tr, int ml, int mr, int bl, int bc, int br)
+{
+    float sx = (float)(tr - tl + 2 * (mr - ml) + br - bl);
+    float sy = (float)(bl + 2 * bc + br - tl - 2 * tc - tr);
+    float px = (float)(tr - tl + mr - ml + br - bl);
+    float py = (float)(tl + tc + tr - bl - bc - br);
+    float mag = 0.5f * (std::sqrt(sx * sx + sy * sy) + std::sqrt(px * px + py * py));
+    return std::min(cvRound(mag), 255);
+}
+
+// 按 BORDER_REFLECT_101 取邻点计算单个像素
+static void edgePixelAt(const uchar* t, const uchar* m, const uchar* b, uchar* out,
+                        int x, int width, int op)
+{
+    int xl = x > 0 ? x - 1 : std::min(1, width - 1);
+    int xr = x + 1 < width ? x + 1 : std::max(width - 2, 0);
+    if (op == EDGE_KIRSCH) {
+        // 顺时针: 左上 上 右上 右 右下 下 左下 左
+        int n[8] = {t[xl], t[x], t[xr], m[xr], b[xr], b[x], b[xl], m[xl]};
+        out[x] = (uchar)kirschPixel(n);
+    }
+    else {
+        out[x] = (uchar)sobelPrewittPixel(t[xl], t[x], t[xr], m[xl], m[xr], b[xl], b[x], b[xr]);
+    }
+}
+
+#if CV_SIMD128
+// 8 个像素的 Kirsch 响应(16 位有符号), t/m/b 指向上/中/下三行的 x-1 处
+static inline cv::v_int16x8 kirschVec(const uchar* t, const uchar* m, const uchar* b)
+{
+    cv::v_uint16x8 n[8] = {
+        cv::v_load_expand(t), cv::v_load_expand(t + 1), cv::v_load_expand(t + 2),
+        cv::v_load_expand(m + 2), cv::v_load_expand(b + 2), cv::v_load_expand(b + 1),
+        cv::v_load_expand(b), cv::v_load_expand(m)
+    };
+    cv::v_uint16x8 total = n[0];
+    cv::v_uint16x8 best = n[0] + n[1] + n[2];
+    for (int i = 1; i < 8; i++) {
+        total += n[i];
+        best = cv::v_max(best, n[i] + n[(i + 1) & 7] + n[(i + 2) & 7]);
+    }
+    return cv::v_reinterpret_as_s16(best << 3) - cv::v_reinterpret_as_s16(total * cv::v_setall_u16(3));
+}
+
+// 4 个像素的 Sobel/Prewitt 平均幅值, 输入为 32 位差分
+static inline cv::v_int32x4 sobelPrewittVec(const cv::v_int32x4& sx, const cv::v_int32x4& sy,
+                                            const cv::v_int32x4& px, const cv::v_int32x4& py)
+{
+    cv::v_float32x4 fsx = cv::v_cvt_f32(sx), fsy = cv::v_cvt_f32(sy);
+    cv::v_float32x4 fpx = cv::v_cvt_f32(px), fpy = cv::v_cvt_f32(py);
+    cv::v_float32x4 mag = cv::v_sqrt(fsx * fsx + fsy * fsy) + cv::v_sqrt(fpx * fpx + fpy * fpy);
+    return cv::v_round(mag * cv::v_setall_f32(0.5f));
+}
+
+static inline cv::v_int16x8 sobelPrewittVec(const uchar* t, const uchar* m, const uchar* b)
+{
+    cv::v_int16x8 tl = cv::v_reinterpret_as_s16(cv::v_load_expand(t));
+    cv::v_int16x8 tc = cv::v_reinterpret_as_s16(cv::v_load_expand(t + 1));
+    cv::v_int16x8 tr = cv::v_reinterpret_as_s16(cv::v_load_expand(t + 2));
+    cv::v_int16x8 ml = cv::v_reinterpret_as_s16(cv::v_load_expand(m));
+    cv::v_int16x8 mr = cv::v_reinterpret_as_s16(cv::v_load_expand(m + 2));
+    cv::v_int16x8 bl = cv::v_reinterpret_as_s16(cv::v_load_expand(b));
+    cv::v_int16x8 bc = cv::v_reinterpret_as_s16(cv::v_load_expand(b + 1));
+    cv::v_int16x8 br = cv::v_reinterpret_as_s16(cv::v_load_expand(b + 2));
+
+    cv::v_int16x8 px = tr - tl + mr - ml + br - bl;
+    cv::v_int16x8 py = tl + tc + tr - bl - bc - br;
+    cv::v_int16x8 sx = px + mr - ml;
+    cv::v_int16x8 sy = bl + bc + bc + br - tl - tc - tc - tr;
+
+    cv::v_int32x4 sx0, sx1, sy0, sy1, px0, px1, py0, py1;
+    cv::v_expand(sx, sx0, sx1);
+    cv::v_expand(sy, sy0, sy1);
+    cv::v_expand(px, px0, px1);
+    cv::v_expand(py, py0, py1);
+    return cv::v_pack(sobelPrewittVec(sx0, sy0, px0, py0), sobelPrewittVec(sx1, sy1, px1, py1));
+}
+#endif
+
+static void edgeRow(const uchar* t, const uchar* m, const uchar* b, uchar* out, int width, int op)
+{
+    if (op == EDGE_FREI_CHEN) {
+        freiChenFastRow(t, m, b, out, width);
+        return;
+    }
+
+    edgePixelAt(t, m, b, out, 0, width, op);
+    int x = 1;
+#if CV_SIMD128
+    for (; x <= width - 17; x += 16) {
+        cv::v_int16x8 r0, r1;
+        if (op == EDGE_KIRSCH) {
+            r0 = kirschVec(t + x - 1, m + x - 1, b + x - 1);
+            r1 = kirschVec(t + x + 7, m + x + 7, b + x + 7);
+        }
+        else {
+            r0 = sobelPrewittVec(t + x - 1, m + x - 1, b + x - 1);
+            r1 = sobelPrewittVec(t + x + 7, m + x + 7, b + x + 7);
+        }
+        cv::v_store(out + x, cv::v_pack_u(r0, r1));
+    }
+#endif
+    for (; x < width; x++) {
+        edgePixelAt(t, m, b, out, x, width, op);
+    }
+}
+
+// x/255 四舍五入, x <= 255*255
+#if CV_SIMD128
+static inline cv::v_uint16x8 div255Vec(const cv::v_uint16x8& x)
+{
+    cv::v_uint16x8 t = x + cv::v_setall_u16(128);
+    return (t + (t >> 8)) >> 8;
+}
+#endif
+
+// 单行高亮叠加: luma 为空时底图为黑色
+static void edgeOverlayRow(const uchar* edge, const uchar* luma, uchar* out, int width,
+                           const EdgeOverlayParams& params)
+{
+    int x = 0;
+#if CV_SIMD128
+    const cv::v_uint8x16 v_thr = cv::v_setall_u8((uchar)std::min(std::max(params.threshold, 0), 255));
+    const cv::v_uint8x16 v_255 = cv::v_setall_u8(255);
+    cv::v_uint16x8 v_col[3];
+    cv::v_uint8x16 v_col8[3];
+    for (int c = 0; c < 3; c++) {
+        v_col[c] = cv::v_setall_u16(params.color[c]);
+        v_col8[c] = cv::v_setall_u8(params.color[c]);
+    }
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint8x16 e = cv::v_load(edge + x);
+        cv::v_uint8x16 mask = e > v_thr;
+        cv::v_uint16x8 e0, e1, ie0, ie1, b0, b1;
+        cv::v_expand(e, e0, e1);
+        cv::v_uint8x16 res[3];
+        if (luma) {
+            cv::v_expand(cv::v_load(luma + x), b0, b1);
+            cv::v_expand(v_255 - e, ie0, ie1);
+            b0 = cv::v_mul_wrap(b0, ie0);
+            b1 = cv::v_mul_wrap(b1, ie1);
+        }
+        else {
+            b0 = b1 = cv::v_setzero_u16();
+        }
+        for (int c = 0; c < 3; c++) {
+            cv::v_uint16x8 r0 = div255Vec(b0 + cv::v_mul_wrap(v_col[c], e0));
+            cv::v_uint16x8 r1 = div255Vec(b1 + cv::v_mul_wrap(v_col[c], e1));
+            res[c] = cv::v_select(mask, v_col8[c], cv::v_pack(r0, r1));
+        }
+        cv::v_store_interleave(out + x * 3, res[0], res[1], res[2]);
+    }
+#endif
+    for (; x < width; x++) {
+        int e = edge[x];
+        int base = luma ? luma[x] * (255 - e) : 0;
+        for (int c = 0; c < 3; c++) {
+            int v = base + params.color[c] * e + 128;
+            out[x * 3 + c] = e > params.threshold ? params.color[c] : (uchar)((v + (v >> 8)) >> 8);
+        }
+    }
+}
+
+void edgeOverlay(const cv::Mat& edge, const cv::Mat& luma, cv::Mat& dst, const EdgeOverlayParams& params)
+{
+    CV_Assert(edge.type() == CV_8UC1);
+    CV_Assert(!params.blend_luma || (luma.type() == CV_8UC1 && luma.size() == edge.size()));
+    dst.create(edge.size(), CV_8UC3);
+    for (int y = 0; y < edge.rows; y++) {
+        edgeOverlayRow(edge.ptr<uchar>(y), params.blend_luma ? luma.ptr<uchar>(y) : NULL,
+                       dst.ptr<uchar>(y), edge.cols, params);
+    }
+}
+
+// 第一遍每次转换的行数, 转换结果在缓存中时立即统计直方图
+static const int kFusedBandRows = 16;
+
+void fusedClaheEdge(FusedEdgeState& state, const cv::Mat& frame, cv::Mat& dst, int op,
+                    double clip_limit, const EdgeOverlayParams* overlay)
+{
+    CV_Assert(frame.depth() == CV_8U && (frame.channels() == 3 || frame.channels() == 1));
+    const int rows = frame.rows, width = frame.cols;
+
+    // 第一遍: BGR2GRAY + 直方图(4 路子直方图减少相邻相同灰度的写冲突)
+    cv::Mat gray;
+    if (frame.channels() == 1) {
+        gray = frame;
+    }
+    else {
+        state.gray.create(frame.size(), CV_8UC1);
+        gray = state.gray;
+    }
+    int hist4[4][256] = {{0}};
+    for (int y0 = 0; y0 < rows; y0 += kFusedBandRows) {
+        int y1 = std::min(y0 + kFusedBandRows, rows);
+        if (frame.channels() == 3) {
+            cv::Mat band = gray.rowRange(y0, y1);
+            cv::cvtColor(frame.rowRange(y0, y1), band, cv::COLOR_BGR2GRAY);
+        }
+        for (int y = y0; y < y1; y++) {
+            const uchar* g = gray.ptr<uchar>(y);
+            int x = 0;
+            for (; x <= width - 4; x += 4) {
+                hist4[0][g[x]]++;
+                hist4[1][g[x + 1]]++;
+                hist4[2][g[x + 2]]++;
+                hist4[3][g[x + 3]]++;
+            }
+            for (; x < width; x++) {
+                hist4[0][g[x]]++;
+            }
+        }
+    }
+    int hist[256];
+    for (int i = 0; i < 256; i++) {
+        hist[i] = hist4[0][i] + hist4[1][i] + hist4[2][i] + hist4[3][i];
+    }
+    uchar lut[256];
+    claheGlobalLut(hist, rows * width, clip_limit, lut);
+
+    // 第二遍: 按行带并行, 每个行带维护三行查表结果的环形缓冲
+    // 单通道输入原地调用时第二遍仍需读取原灰度, 写入新缓冲
+    bool colorize = overlay && overlay->enabled;
+    int out_type = colorize ? CV_8UC3 : CV_8UC1;
+    cv::Mat out;
+    if (dst.data == frame.data) {
+        out.create(frame.size(), out_type);
+    }
+    else {
+        dst.create(frame.size(), out_type);
+        out = dst;
+    }
+    int nbands = std::max(1, std::min(cv::getNumThreads() * 4, rows / kFusedBandRows));
+    cv::parallel_for_(cv::Range(0, nbands), [&](const cv::Range& range) {
+        std::vector<uchar> ring(3 * (size_t)width);
+        std::vector<uchar> edge_row(colorize ? width : 0);
+        int ring_row[3] = {-1, -1, -1};
+        for (int band = range.start; band < range.end; band++) {
+            int y0 = rows * band / nbands, y1 = rows * (band + 1) / nbands;
+            for (int y = y0; y < y1; y++) {
+                int yy[3] = {y > 0 ? y - 1 : std::min(1, rows - 1), y,
+                             y + 1 < rows ? y + 1 : std::max(rows - 2, 0)};
+                const uchar* p[3];
+                for (int k = 0; k < 3; k++) {
+                    uchar* slot = &ring[(size_t)(yy[k] % 3) * width];
+                    if (ring_row[yy[k] % 3] != yy[k]) {
+                        const uchar* g = gray.ptr<uchar>(yy[k]);
+                        for (int x = 0; x < width; x++) {
+                            slot[x] = lut[g[x]];
+                        }
+                        ring_row[yy[k] % 3] = yy[k];
+                    }
+                    p[k] = slot;
+                }
+                if (colorize) {
+                    // 边缘行留在缓存中, 直接着色写入 BGR 输出
+                    edgeRow(p[0], p[1], p[2], &edge_row[0], width, op);
+                    edgeOverlayRow(&edge_row[0], overlay->blend_luma ? gray.ptr<uchar>(y) : NULL,
+                                   out.ptr<uchar>(y), width, *overlay);
+                }
+                else {
+                    edgeRow(p[0], p[1], p[2], out.ptr<uchar>(y), width, op);
+                }
+            }
+        }
+    });
+    dst = out;
+}
+
+// ===================== 2 倍放大 ======================
+// 对角线差值需小于另一条对角线减去该阈值才沿其插值, 抑制噪声导致的方向抖动
+static const int kUpscaleDiagThreshold = 8;
+// 每个行带的最少输入行数
+static const int kUpscaleBandRows = 16;
+
+// 4 点三次插值求中点
+static inline uchar upscaleCubic(int p0, int p1, int p2, int p3)
+{
+    return cv::saturate_cast<uchar>((9 * (p1 + p2) - p0 - p3 + 8) >> 4);
+}
+
+// 中心点: 沿差值较小的对角线插值
+static inline uchar upscaleDiag(int a, int b, int c, int d)
+{
+    int d1 = std::min(std::abs(a - d) + kUpscaleDiagThreshold, 255);
+    int d2 = std::min(std::abs(b - c) + kUpscaleDiagThreshold, 255);
+    if (d1 < std::abs(b - c)) {
+        return (uchar)((a + d + 1) >> 1);
+    }
+    if (d2 < std::abs(a - d)) {
+        return (uchar)((b + c + 1) >> 1);
+    }
+    return (uchar)((a + b + c + d + 2) >> 2);
+}
+
+#if CV_SIMD128
+// 按通道拆分加载 16 个像素, 以及将偶/奇两组像素交织写出 32 个像素
+template<int CN> struct UpscaleIO;
+
+template<> struct UpscaleIO<1> {
+    static inline void load(const uchar* p, cv::v_uint8x16* v)
+    {
+        v[0] = cv::v_load(p);
+    }
+    static inline void store(uchar* p, const cv::v_uint8x16* even, const cv::v_uint8x16* odd)
+    {
+        cv::v_store_interleave(p, even[0], odd[0]);
+    }
+};
+
+template<> struct UpscaleIO<3> {
+    static inline void load(const uchar* p, cv::v_uint8x16* v)
+    {
+        cv::v_load_deinterleave(p, v[0], v[1], v[2]);
+    }
+    static inline void store(uchar* p, const cv::v_uint8x16* even, const cv::v_uint8x16* odd)
+    {
+        cv::v_uint8x16 lo[3], hi[3];
+        for (int c = 0; c < 3; c++) {
+            cv::v_zip(even[c], odd[c], lo[c], hi[c]);
+        }
+        cv::v_store_interleave(p, lo[0], lo[1], lo[2]);
+        cv::v_store_interleave(p + 48, hi[0], hi[1], hi[2]);
+    }
+};
+
+static inline cv::v_uint8x16 upscaleCubicVec(const cv::v_uint8x16& p0, const cv::v_uint8x16& p1,
+                                             const cv::v_uint8x16& p2, const cv::v_uint8x16& p3)
+{
+    cv::v_uint16x8 a0, a1, b0, b1, c0, c1, d0, d1;
+    cv::v_expand(p0, a0, a1);
+    cv::v_expand(p1, b0, b1);
+    cv::v_expand(p2, c0, c1);
+    cv::v_expand(p3, d0, d1);
+    const cv::v_int16x8 v_9 = cv::v_setall_s16(9);
+    cv::v_int16x8 t0 = cv::v_reinterpret_as_s16(b0 + c0) * v_9 - cv::v_reinterpret_as_s16(a0 + d0);
+    cv::v_int16x8 t1 = cv::v_reinterpret_as_s16(b1 + c1) * v_9 - cv::v_reinterpret_as_s16(a1 + d1);
+    return cv::v_rshr_pack_u<4>(t0, t1);
+}
+
+static inline cv::v_uint8x16 upscaleAvg4Vec(const cv::v_uint8x16& a, const cv::v_uint8x16& b,
+                                            const cv::v_uint8x16& c, const cv::v_uint8x16& d)
+{
+    cv::v_uint16x8 a0, a1, b0, b1, c0, c1, d0, d1;
+    cv::v_expand(a, a0, a1);
+    cv::v_expand(b, b0, b1);
+    cv::v_expand(c, c0, c1);
+    cv::v_expand(d, d0, d1);
+    return cv::v_rshr_pack<2>(a0 + b0 + c0 + d0, a1 + b1 + c1 + d1);
+}
+
+static inline cv::v_uint8x16 upscaleDiagVec(const cv::v_uint8x16& a, const cv::v_uint8x16& b,
+                                            const cv::v_uint8x16& c, const cv::v_uint8x16& d)
+{
+    const cv::v_uint8x16 v_thr = cv::v_setall_u8((uchar)kUpscaleDiagThreshold);
+    cv::v_uint8x16 d1 = cv::v_absdiff(a, d), d2 = cv::v_absdiff(b, c);
+    cv::v_uint8x16 main_diag = (d1 + v_thr) < d2;
+    cv::v_uint8x16 anti_diag = (d2 + v_thr) < d1;
+    return cv::v_select(main_diag, cv::v_avg(a, d),
+                        cv::v_select(anti_diag, cv::v_avg(b, c), upscaleAvg4Vec(a, b, c, d)));
+}
+#endif
+
+// 输入行 y 生成输出行 2y(even)与 2y+1(odd); rm1/r0/r1/r2 为 y-1..y+2 行,
+// 左右各扩展 1/2 个像素, 指针指向第 0 个像素
+template<int CN, int MODE>
+static void upscaleRow(const uchar* rm1, const uchar* r0, const uchar* r1, const uchar* r2,
+                       uchar* even, uchar* odd, int width)
+{
+    int x = 0;
+#if CV_SIMD128
+    for (; x <= width - 16; x += 16) {
+        const int o = x * CN;
+        cv::v_uint8x16 s0[CN], s0r[CN], s1[CN], s1r[CN];
+        cv::v_uint8x16 e_odd[CN], o_even[CN], o_odd[CN];
+        UpscaleIO<CN>::load(r0 + o, s0);
+        if (MODE == UPSCALE_NEAREST) {
+            UpscaleIO<CN>::store(even + o * 2, s0, s0);
+            UpscaleIO<CN>::store(odd + o * 2, s0, s0);
+            continue;
+        }
+        UpscaleIO<CN>::load(r0 + o + CN, s0r);
+        UpscaleIO<CN>::load(r1 + o, s1);
+        UpscaleIO<CN>::load(r1 + o + CN, s1r);
+        if (MODE == UPSCALE_BILINEAR) {
+            for (int c = 0; c < CN; c++) {
+                e_odd[c] = cv::v_avg(s0[c], s0r[c]);
+                o_even[c] = cv::v_avg(s0[c], s1[c]);
+                o_odd[c] = upscaleAvg4Vec(s0[c], s0r[c], s1[c], s1r[c]);
+            }
+        }
+        else {
+            cv::v_uint8x16 s0l[CN], s0rr[CN], sm1[CN], s2[CN];
+            UpscaleIO<CN>::load(r0 + o - CN, s0l);
+            UpscaleIO<CN>::load(r0 + o + 2 * CN, s0rr);
+            UpscaleIO<CN>::load(rm1 + o, sm1);
+            UpscaleIO<CN>::load(r2 + o, s2);
+            for (int c = 0; c < CN; c++) {
+                e_odd[c] = upscaleCubicVec(s0l[c], s0[c], s0r[c], s0rr[c]);
+                o_even[c] = upscaleCubicVec(sm1[c], s0[c], s1[c], s2[c]);
+                o_odd[c] = upscaleDiagVec(s0[c], s0r[c], s1[c], s1r[c]);
+            }
+        }
+        UpscaleIO<CN>::store(even + o * 2, s0, e_odd);
+        UpscaleIO<CN>::store(odd + o * 2, o_even, o_odd);
+    }
+#endif
+    for (; x < width; x++) {
+        for (int c = 0; c < CN; c++) {
+            const int i = x * CN + c;
+            int s0 = r0[i], s0r = r0[i + CN], s1 = r1[i], s1r = r1[i + CN];
+            uchar e_odd, o_even, o_odd;
+            if (MODE == UPSCALE_NEAREST) {
+                e_odd = o_even = o_odd = (uchar)s0;
+            }
+            else if (MODE == UPSCALE_BILINEAR) {
+                e_odd = (uchar)((s0 + s0r + 1) >> 1);
+                o_even = (uchar)((s0 + s1 + 1) >> 1);
+                o_odd = (uchar)((s0 + s0r + s1 + s1r + 2) >> 2);
+            }
+            else {
+                e_odd = upscaleCubic(r0[i - CN], s0, s0r, r0[i + 2 * CN]);
+                o_even = upscaleCubic(rm1[i], s0, s1, r2[i]);
+                o_odd = upscaleDiag(s0, s0r, s1, s1r);
+            }
+            even[x * 2 * CN + c] = (uchar)s0;
+            even[x * 2 * CN + CN + c] = e_odd;
+            odd[x * 2 * CN + c] = o_even;
+            odd[x * 2 * CN + CN + c] = o_odd;
+        }
+    }
+}
+
+template<int CN, int MODE>
+static void upscaleRows(const cv::Mat& src, cv::Mat& dst)
+{
+    const int rows = src.rows, width = src.cols;
+    // 扩展后的行: 左 1 个像素, 右 2 个像素
+    const int padded = (width + 3) * CN;
+    int nbands = std::max(1, std::min(cv::getNumThreads() * 4, rows / kUpscaleBandRows));
+    cv::parallel_for_(cv::Range(0, nbands), [&](const cv::Range& range) {
+        std::vector<uchar> ring(4 * (size_t)padded);
+        int ring_row[4] = {-1, -1, -1, -1};
+        for (int band = range.start; band < range.end; band++) {
+            int y0 = rows * band / nbands, y1 = rows * (band + 1) / nbands;
+            for (int y = y0; y < y1; y++) {
+                const uchar* p[4];
+                for (int k = 0; k < 4; k++) {
+                    int yy = std::min(std::max(y - 1 + k, 0), rows - 1);
+                    uchar* slot = &ring[(yy % 4) * (size_t)padded];
+                    if (ring_row[yy % 4] != yy) {
+                        const uchar* s = src.ptr<uchar>(yy);
+                        memcpy(slot + CN, s, (size_t)width * CN);
+                        for (int c = 0; c < CN; c++) {
+                            slot[c] = s[c];
+                            slot[(width + 1) * CN + c] = s[(width - 1) * CN + c];
+                            slot[(width + 2) * CN + c] = s[(width - 1) * CN + c];
+                        }
+                        ring_row[yy % 4] = yy;
+                    }
+                    p[k] = slot + CN;
+                }
+                upscaleRow<CN, MODE>(p[0], p[1], p[2], p[3], dst.ptr<uchar>(2 * y),
+                                     dst.ptr<uchar>(2 * y + 1), width);
+            }
+        }
+    });
+}
+
+template<int CN>
+static void upscaleDispatch(const cv::Mat& src, cv::Mat& dst, int mode)
+{
+    if (mode == UPSCALE_NEAREST) {
+        upscaleRows<CN, UPSCALE_NEAREST>(src, dst);
+    }
+    else if (mode == UPSCALE_BILINEAR) {
+        upscaleRows<CN, UPSCALE_BILINEAR>(src, dst);
+    }
+    else {
+        upscaleRows<CN, UPSCALE_EDGE>(src, dst);
+    }
+}
+
+void upscale2x(const cv::Mat& src, cv::Mat& dst, int mode)
+{
+    CV_Assert(src.type() == CV_8UC1 || src.type() == CV_8UC3);
+    CV_Assert(mode == UPSCALE_NEAREST || mode == UPSCALE_BILINEAR || mode == UPSCALE_EDGE);
+    // dst 可能就是 src, 先持有输入头, dst 重新分配时输入仍然有效
+    cv::Mat in = src;
+    dst.create(in.rows * 2, in.cols * 2, in.type());
+    if (in.channels() == 1) {
+        upscaleDispatch<1>(in, dst, mode);
+    }
+    else {
+        upscaleDispatch<3>(in, dst, mode);
+    }
+}
@@ -0,0 +1,253 @@
+#include "appconfig.h"
+
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "cJSON.h"
+
+AppConfig::AppConfig() :
+    tuning(std::make_shared<TuningParams>()),
+    inotify_fd(-1),
+    reloads(0),
+    errors(0) {}
+
+AppConfig::~AppConfig()
+{
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+}
+
+// 缺少该项时保持原值
+static bool configNumber(const cJSON* section, const char* key, double& value)
+{
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(section, key);
+    if (item == NULL) {
+        return true;
+    }
+    if (!cJSON_IsNumber(item)) {
+        std::cerr << "配置项 " << key << " 应为数字" << std::endl;
+        return false;
+    }
+    value = item->valuedouble;
+    return true;
+}
+
+static bool configInt(const cJSON* section, const char* key, int& value)
+{
+    double number = value;
+    if (!configNumber(section, key, number)) {
+        return false;
+    }
+    if (number != (int)number) {
+        std::cerr << "配置项 " << key << " 应为整数" << std::endl;
+        return false;
+    }
+    value = (int)number;
+    return true;
+}
+
+static bool configString(const cJSON* section, const char* key, std::string& value)
+{
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(section, key);
+    if (item == NULL) {
+        return true;
+    }
+    if (!cJSON_IsString(item) || item->valuestring == NULL) {
+        std::cerr << "配置项 " << key << " 应为字符串" << std::endl;
+        return false;
+    }
+    value = item->valuestring;
+    return true;
+}
+
+static bool configCheck(bool ok, const char* message)
+{
+    if (!ok) {
+        std::cerr << "配置取值无效: " << message << std::endl;
+    }
+    return ok;
+}
+
+static bool configValidate(const DeviceConfig& device, const TuningParams& tuning)
+{
+    bool ok = true;
+    ok &= configCheck(!device.device.empty(), "device.path 为空");
+    ok &= configCheck(device.width > 0 && device.width % 2 == 0 && device.height > 0,
+                      "device.width/height 须为正数, 宽度为偶数(YUYV)");
+    ok &= configCheck(device.info_height >= -1, "device.info_height 须为 -1(自动)或非负数");
+    ok &= configCheck(device.usb_vid >= 0 && device.usb_vid <= 0xFFFF && device.usb_pid >= 0 &&
+                      device.usb_pid <= 0xFFFF, "device.usb_vid/usb_pid 须在 0-0xFFFF");
+    ok &= configCheck(device.temp_frame == 0 || device.temp_frame == 1, "device.temp_frame 须为 0 或 1");
+    ok &= configCheck(tuning.clip_default > 0 && tuning.clip_sobel_prewitt > 0 &&
+                      tuning.clip_kirsch > 0 && tuning.clip_frei_chen > 0, "clahe.clip_* 须大于 0");
+    ok &= configCheck(tuning.tile_size >= 1 && tuning.tile_size <= 64, "clahe.tile_size 须在 1-64");
+    ok &= configCheck(tuning.unsharp_ksize > 0 && tuning.unsharp_ksize % 2 == 1 && tuning.unsharp_ksize <= 15,
+                      "unsharp.ksize 须为 1-15 的奇数");
+    ok &= configCheck(tuning.unsharp_strength >= 0 && tuning.unsharp_strength < 128, "unsharp.strength 须在 0-128");
+    ok &= configCheck(tuning.edge_threshold >= 0 && tuning.edge_threshold <= 255, "edge_threshold 须在 0-255");
+    ok &= configCheck(tuning.display_factor >= 1 && tuning.display_factor <= 4, "display.factor 须在 1-4");
+    return ok;
+}
+
+bool appConfigParse(const std::string& text, DeviceConfig& device, TuningParams& tuning)
+{
+    cJSON* root = cJSON_Parse(text.c_str());
+    if (root == NULL || !cJSON_IsObject(root)) {
+        const char* error = cJSON_GetErrorPtr();
+        std::cerr << "配置文件不是有效的 JSON 对象";
+        if (root == NULL && error != NULL) {
+            std::cerr << ", 错误位置: " << std::string(error).substr(0, 32);
+        }
+        std::cerr << std::endl;
+        cJSON_Delete(root);
+        return false;
+    }
+
+    const cJSON* dev = cJSON_GetObjectItemCaseSensitive(root, "device");
+    const cJSON* clahe = cJSON_GetObjectItemCaseSensitive(root, "clahe");
+    const cJSON* unsharp = cJSON_GetObjectItemCaseSensitive(root, "unsharp");
+    const cJSON* display = cJSON_GetObjectItemCaseSensitive(root, "display");
+    bool ok = true;
+    ok &= configString(dev, "path", device.device);
+    ok &= configInt(dev, "width", device.width);
+    ok &= configInt(dev, "height", device.height);
+    ok &= configInt(dev, "info_height", device.info_height);
+    ok &= configString(dev, "dpc_map", device.dpc_map_path);
+    ok &= configInt(dev, "usb_vid", device.usb_vid);
+    ok &= configInt(dev, "usb_pid", device.usb_pid);
+    ok &= configString(dev, "palette_dir", device.palette_dir);
+    ok &= configInt(dev, "temp_frame", device.temp_frame);
+    ok &= configString(dev, "nuc_table", device.nuc_table_path);
+    ok &= configNumber(clahe, "clip_default", tuning.clip_default);
+    ok &= configNumber(clahe, "clip_sobel_prewitt", tuning.clip_sobel_prewitt);
+    ok &= configNumber(clahe, "clip_kirsch", tuning.clip_kirsch);
+    ok &= configNumber(clahe, "clip_frei_chen", tuning.clip_frei_chen);
+    ok &= configInt(clahe, "tile_size", tuning.tile_size);
+    ok &= configNumber(unsharp, "sigma", tuning.unsharp_sigma);
+    ok &= configNumber(unsharp, "strength", tuning.unsharp_strength);
+    ok &= configInt(unsharp, "ksize", tuning.unsharp_ksize);
+    ok &= configInt(root, "edge_threshold", tuning.edge_threshold);
+    ok &= configNumber(display, "factor", tuning.display_factor);
+    ok &= configString(display, "screenshot_path", tuning.screenshot_path);
+    cJSON_Delete(root);
+    return ok && configValidate(device, tuning);
+}
+
+static bool configRead(const std::string& path, std::string& text)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+// 发布新的调参块, 版本号接续当前块
+static void configPublish(AppConfig& config, TuningParams& tuning)
+{
+    tuning.version = appConfigTuning(config)->version + 1;
+    std::atomic_store(&config.tuning, std::shared_ptr<const TuningParams>(new TuningParams(tuning)));
+}
+
+bool appConfigLoad(AppConfig& config, const std::string& path)
+{
+    config.path = path;
+    DeviceConfig device;
+    TuningParams tuning;
+    std::string text;
+    if (!configRead(path, text)) {
+        std::cout << "未找到配置文件 " << path << ", 使用默认参数" << std::endl;
+    }
+    else if (!appConfigParse(text, device, tuning)) {
+        std::cerr << "配置文件加载失败, 使用默认参数: " << path << std::endl;
+        config.errors++;
+        device = DeviceConfig();
+        tuning = TuningParams();
+        configPublish(config, tuning);
+        return false;
+    }
+    config.device = device;
+    configPublish(config, tuning);
+    return true;
+}
+
+bool appConfigWatch(AppConfig& config)
+{
+    if (config.inotify_fd < 0) {
+        config.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (config.inotify_fd < 0) {
+            perror("inotify 初始化失败");
+            return false;
+        }
+    }
+    size_t slash = config.path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : config.path.substr(0, slash);
+    // 只在写入完成或改名到位时处理, 避免读到写了一半的文件
+    if (inotify_add_watch(config.inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        perror("监视配置目录失败");
+        return false;
+    }
+    return true;
+}
+
+static bool configDeviceEqual(const DeviceConfig& a, const DeviceConfig& b)
+{
+    return a.device == b.device && a.width == b.width && a.height == b.height &&
+           a.info_height == b.info_height && a.dpc_map_path == b.dpc_map_path &&
+           a.usb_vid == b.usb_vid && a.usb_pid == b.usb_pid && a.palette_dir == b.palette_dir &&
+           a.temp_frame == b.temp_frame && a.nuc_table_path == b.nuc_table_path;
+}
+
+bool appConfigPoll(AppConfig& config)
+{
+    if (config.inotify_fd < 0) {
+        return false;
+    }
+    // 没有事件时只有一次不阻塞的 read
+    bool changed = false;
+    alignas(inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = read(config.inotify_fd, buf, sizeof(buf))) > 0) {
+        size_t slash = config.path.rfind('/');
+        std::string name = slash == std::string::npos ? config.path : config.path.substr(slash + 1);
+        for (char* p = buf; p < buf + len; ) {
+            const inotify_event* event = (const inotify_event*)p;
+            if (event->len > 0 && name == event->name) {
+                changed = true;
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+    if (!changed) {
+        return false;
+    }
+
+    DeviceConfig device;
+    TuningParams tuning;
+    std::string text;
+    if (!configRead(config.path, text) || !appConfigParse(text, device, tuning)) {
+        std::cerr << "配置更新无效, 保持当前参数: " << config.path << std::endl;
+        config.errors++;
+        return false;
+    }
+    if (!configDeviceEqual(device, config.device)) {
+        std::cout << "设备配置的修改需重启后生效" << std::endl;
+    }
+    configPublish(config, tuning);
+    config.reloads++;
+    std::cout << "配置已更新(版本 " << tuning.version << ")" << std::endl;
+    return true;
+}
+
+std::shared_ptr<const TuningParams> appConfigTuning(const AppConfig& config)
+{
+    return std::atomic_load(&config.tuning);
+}
@@ -0,0 +1,1792 @@
+#include "bench.h"
+#include "alarm.h"
+#include "algorithm.h"
+#include "appconfig.h"
+#include "cmdexec.h"
+#include "devparam.h"
+#include "dpc.h"
+#include "ffc.h"
+#include "hotspot.h"
+#include "hud.h"
+#include "latency.h"
+#include "mockcam.h"
+#include "palette.h"
+#include "pipestats.h"
+#include "scenegen.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "tempmap.h"
+#include "tempstats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+// Frei-Chen 定点实现相对浮点实现的容差(幅值近似误差约 ±1.2%, 另有取整)
+static const double kFreiChenMaxDiff = 4;
+static const double kFreiChenMeanDiff = 1.0;
+static const int kBenchIterations = 50;
+
+// 合成测试帧: 平滑背景 + 高温目标 + 传感器噪声
+static cv::Mat makeBenchFrame(cv::Size size)
+{
+    cv::RNG rng(20250523);
+    cv::Mat gray(size, CV_8UC1);
+    int cx = size.width / 2, cy = size.height / 2, r = size.height / 8;
+    for (int y = 0; y < size.height; y++) {
+        uchar* p = gray.ptr<uchar>(y);
+        for (int x = 0; x < size.width; x++) {
+            double v = 60 + 80.0 * x / size.width + 40.0 * y / size.height;
+            if ((x - cx) * (x - cx) + (y - cy) * (y - cy) < r * r) {
+                v = 220;
+            }
+            else if (x > size.width / 8 && x < size.width / 4 && y > size.height / 2) {
+                v = 150;
+            }
+            p[x] = cv::saturate_cast<uchar>(v + rng.gaussian(3));
+        }
+    }
+    return gray;
+}
+
+// 重复执行计时, 返回单帧毫秒数
+template<typename F>
+static double timeIt(F f, int iterations)
+{
+    f();    // 预热, 完成缓冲区分配
+    int64_t start = cv::getTickCount();
+    for (int i = 0; i < iterations; i++) {
+        f();
+    }
+    return (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / iterations;
+}
+
+// 输出差异统计, 返回是否在容差内
+static bool compareOutputs(const cv::Mat& ref, const cv::Mat& out, double max_tol, double mean_tol,
+                           double& max_diff, double& mean_diff)
+{
+    cv::Mat diff;
+    cv::absdiff(ref, out, diff);
+    cv::minMaxLoc(diff, NULL, &max_diff);
+    mean_diff = cv::mean(diff)[0];
+    return max_diff <= max_tol && mean_diff <= mean_tol;
+}
+
+// 逐字节相同
+static bool sameFrame(const cv::Mat& a, const cv::Mat& b)
+{
+    if (a.size() != b.size() || a.type() != b.type()) {
+        return false;
+    }
+    for (int y = 0; y < a.rows; y++) {
+        if (memcmp(a.ptr(y), b.ptr(y), a.cols * a.elemSize()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool benchSceneGen(cv::Size size)
+{
+    SceneGen gen, replay, other;
+    gen.params.size = replay.params.size = other.params.size = size;
+    gen.params.shutter_interval = 50;
+    other.params.seed = gen.params.seed + 1;
+
+    // 同一帧序号的内容与生成顺序无关, 不同种子不同
+    cv::Mat f0, f9, g0, g9, h0;
+    sceneGenRender(gen, 0, SCENE_Y14, f0);
+    sceneGenRender(gen, 9, SCENE_Y14, f9);
+    sceneGenRender(replay, 9, SCENE_Y14, g9);
+    sceneGenRender(replay, 0, SCENE_Y14, g0);
+    sceneGenRender(other, 0, SCENE_Y14, h0);
+    bool pass = sameFrame(f0, g0) && sameFrame(f9, g9) && !sameFrame(f0, h0) && !sameFrame(f0, f9);
+
+    // 坏点: 只有坏点取到极值; 目标质心按速度移动
+    int dead = 0;
+    double sx[2] = {0, 0}, sy[2] = {0, 0}, sn[2] = {0, 0};
+    const cv::Mat* frames[2] = {&f0, &f9};
+    for (int k = 0; k < 2; k++) {
+        for (int y = 0; y < size.height; y++) {
+            const ushort* p = frames[k]->ptr<ushort>(y);
+            for (int x = 0; x < size.width; x++) {
+                dead += k == 0 && (p[x] == 0 || p[x] == kSceneMaxValue);
+                if (p[x] > 10500 && p[x] < kSceneMaxValue) {
+                    sx[k] += x;
+                    sy[k] += y;
+                    sn[k]++;
+                }
+            }
+        }
+    }
+    const SceneObject& o = gen.params.objects[0];
+    double move_x = sx[1] / std::max(sn[1], 1.0) - sx[0] / std::max(sn[0], 1.0);
+    double move_y = sy[1] / std::max(sn[1], 1.0) - sy[0] / std::max(sn[0], 1.0);
+    pass &= dead == (int)gen.dead.size() && dead > 0 &&
+            std::abs(move_x - o.velocity.x * 9) < 1 && std::abs(move_y - o.velocity.y * 9) < 1;
+
+    // 时域噪声: 相邻两帧之差的标准差为 sqrt(2) * sigma; 快门帧平坦
+    cv::Mat f10, f50;
+    sceneGenRender(gen, 10, SCENE_Y14, f10);
+    sceneGenRender(gen, 50, SCENE_Y14, f50);
+    bool shutter = gen.shutter;
+    double d2 = 0, m = 0, m2 = 0;
+    int n = 0;
+    for (int y = 0; y < size.height; y++) {
+        const ushort* a = f9.ptr<ushort>(y);
+        const ushort* b = f10.ptr<ushort>(y);
+        const ushort* c = f50.ptr<ushort>(y);
+        for (int x = 0; x < size.width; x++) {
+            if (a[x] < 9000 && b[x] < 9000 && a[x] > 0 && b[x] > 0 && c[x] > 0 && c[x] < kSceneMaxValue) {
+                double d = (double)a[x] - b[x];
+                d2 += d * d;
+                m += c[x];
+                m2 += (double)c[x] * c[x];
+                n++;
+            }
+        }
+    }
+    double noise = sqrt(d2 / std::max(n, 1) / 2);
+    double shutter_mean = m / std::max(n, 1);
+    double shutter_std = sqrt(std::max(m2 / std::max(n, 1) - shutter_mean * shutter_mean, 0.0));
+    pass &= shutter && std::abs(noise - gen.params.temporal_sigma) < gen.params.temporal_sigma * 0.15 &&
+            std::abs(shutter_mean - gen.params.shutter_value) < 2 && shutter_std < 30;
+
+    // 200 fps 的基准需要每帧 5 ms 以内(按 384x288 像素数折算)
+    cv::Mat y14, yuyv;
+    double t14 = timeIt([&]() { sceneGenNext(gen, SCENE_Y14, y14); }, kBenchIterations);
+    double tyuyv = timeIt([&]() { sceneGenNext(gen, SCENE_YUYV, yuyv); }, kBenchIterations);
+    double budget = 5.0 * size.area() / (384 * 288);
+    pass &= tyuyv < budget && yuyv.type() == CV_8UC2 && yuyv.rows == size.height;
+    printf("scene gen %dx%d: y14 %.3f ms, yuyv %.3f ms (%.0f fps), %d dead, noise %.2f, "
+           "shutter mean %.0f std %.1f [%s]\n",
+           size.width, size.height, t14, tyuyv, 1000 / tyuyv, dead, noise, shutter_mean, shutter_std,
+           pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 显示路径(sample.cpp 的 frei_Chen)用浮点实现, 定点核在目标板 SIMD 构建下测得快于浮点后才切换。
+// 已记录的测量(x86, 单线程, 100 次迭代取中位数):
+//                         384x288     768x576
+//   float Frei_Chen       0.770 ms    3.166 ms   OpenCV 5.0.0, SIMD
+//   freiChenFixed         1.265 ms    5.910 ms   CV_SIMD128=0 标量路径
+//   freiChenFixed SIMD    未测量                  需在目标板上运行 --bench 补记
+static bool benchFreiChen(cv::Size size)
+{
+    // 与 frei_Chen 模式相同, 在 CLAHE 之后的灰度图上比较
+    cv::Mat gray = makeBenchFrame(size);
+    do_CLAHE_edge_Frei_Chen(gray, gray);
+    cv::Mat ref = Frei_Chen(gray);
+    cv::Mat out;
+    freiChenFixed(gray, out);
+
+    double max_diff, mean_diff;
+    bool pass = compareOutputs(ref, out, kFreiChenMaxDiff, kFreiChenMeanDiff, max_diff, mean_diff);
+
+    double t_ref = timeIt([&]() { ref = Frei_Chen(gray); }, kBenchIterations);
+    double t_fixed = timeIt([&]() { freiChenFixed(gray, out); }, kBenchIterations);
+    double t_quality = timeIt([&]() { freiChenFixed(gray, out, FREI_CHEN_EDGE); }, kBenchIterations);
+
+    // 计时不影响 PASS, 只报告定点核是否快于当前的浮点显示路径
+    printf("Frei-Chen %dx%d: float %.3f ms, fixed %.3f ms (x%.2f, fixed %s than float display path), "
+           "9-basis %.3f ms, max diff %.0f, mean diff %.3f [%s]\n",
+           size.width, size.height, t_ref, t_fixed, t_ref / t_fixed, t_fixed < t_ref ? "faster" : "slower",
+           t_quality, max_diff, mean_diff, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 融合流水线与逐级链路(BGR2GRAY -> do_CLAHE_* -> 浮点边缘算子)对比
+static bool benchFusedEdge(cv::Size size, int op)
+{
+    cv::Mat gray = makeBenchFrame(size);
+    cv::Mat bgr;
+    cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+
+    const char* name;
+    double max_tol, mean_tol;
+    std::function<cv::Mat()> chain;
+    if (op == EDGE_KIRSCH) {
+        // 整数实现与浮点链路逐像素一致
+        name = "Kirsch";
+        max_tol = 0;
+        mean_tol = 0;
+        chain = [&]() {
+            cv::Mat g;
+            cv::cvtColor(bgr, g, cv::COLOR_BGR2GRAY);
+            do_CLAHE_edge(g, g);
+            return Kirsch(g);
+        };
+    }
+    else if (op == EDGE_FREI_CHEN) {
+        name = "Frei-Chen";
+        max_tol = kFreiChenMaxDiff;
+        mean_tol = kFreiChenMeanDiff;
+        chain = [&]() {
+            cv::Mat g;
+            cv::cvtColor(bgr, g, cv::COLOR_BGR2GRAY);
+            do_CLAHE_edge_Frei_Chen(g, g);
+            return Frei_Chen(g);
+        };
+    }
+    else {
+        // 单精度与双精度幅值在 .5 附近取整可能相差 1
+        name = "SobelPrewitt";
+        max_tol = 1;
+        mean_tol = 0.01;
+        chain = [&]() {
+            cv::Mat g;
+            cv::cvtColor(bgr, g, cv::COLOR_BGR2GRAY);
+            do_CLAHE_sobelprewitt(g, g);
+            return SobelPrewitt(g);
+        };
+    }
+    double clip = op == EDGE_KIRSCH ? kClaheClipKirsch :
+                  op == EDGE_FREI_CHEN ? kClaheClipFreiChen : kClaheClipSobelPrewitt;
+
+    FusedEdgeState state;
+    cv::Mat ref = chain(), out;
+    fusedClaheEdge(state, bgr, out, op, clip);
+    double max_diff, mean_diff;
+    bool pass = compareOutputs(ref, out, max_tol, mean_tol, max_diff, mean_diff);
+
+    double t_chain = timeIt([&]() { ref = chain(); }, kBenchIterations);
+    double t_fused = timeIt([&]() { fusedClaheEdge(state, bgr, out, op, clip); }, kBenchIterations);
+    printf("fused %s %dx%d: chain %.3f ms, fused %.3f ms (x%.2f), max diff %.0f, mean diff %.3f [%s]\n",
+           name, size.width, size.height, t_chain, t_fused, t_chain / t_fused,
+           max_diff, mean_diff, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// SobelPrewitt 模式绿色高亮: 融合着色与原 split/merge 着色逐像素一致
+static bool benchEdgeOverlay(cv::Size size)
+{
+    cv::Mat gray = makeBenchFrame(size);
+    cv::Mat bgr;
+    cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+
+    FusedEdgeState state;
+    EdgeOverlayParams overlay;
+    cv::Mat edge, ref, out;
+    auto colorize = [&]() {
+        fusedClaheEdge(state, bgr, edge, EDGE_SOBEL_PREWITT, kClaheClipSobelPrewitt);
+        std::vector<cv::Mat> channels(3);
+        cv::split(bgr, channels);
+        channels[0] = cv::Mat::zeros(edge.size(), CV_8UC1);
+        channels[1] = edge.clone();
+        channels[2] = cv::Mat::zeros(edge.size(), CV_8UC1);
+        channels[1].setTo(255, channels[1] > overlay.threshold);
+        cv::merge(channels, ref);
+    };
+    colorize();
+    fusedClaheEdge(state, bgr, out, EDGE_SOBEL_PREWITT, kClaheClipSobelPrewitt, &overlay);
+    double max_diff, mean_diff;
+    bool pass = compareOutputs(ref.reshape(1), out.reshape(1), 0, 0, max_diff, mean_diff);
+
+    double t_split = timeIt(colorize, kBenchIterations);
+    double t_fused = timeIt([&]() {
+        fusedClaheEdge(state, bgr, out, EDGE_SOBEL_PREWITT, kClaheClipSobelPrewitt, &overlay);
+    }, kBenchIterations);
+    overlay.blend_luma = true;
+    double t_blend = timeIt([&]() {
+        fusedClaheEdge(state, bgr, out, EDGE_SOBEL_PREWITT, kClaheClipSobelPrewitt, &overlay);
+    }, kBenchIterations);
+    printf("edge overlay %dx%d: split/merge %.3f ms, fused %.3f ms (x%.2f), luma blend %.3f ms, "
+           "max diff %.0f [%s]\n",
+           size.width, size.height, t_split, t_fused, t_split / t_fused, t_blend,
+           max_diff, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 伪彩查表: 8 位结果与 applyColorMap(同一色表)逐像素一致, Y14 全范围映射误差不超过 1
+static bool benchPalette(cv::Size size)
+{
+    cv::Mat gray = makeBenchFrame(size);
+    cv::Mat bgr, y14;
+    cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+    gray.convertTo(y14, CV_16U, (kPaletteY14Size - 1) / 255.0);
+
+    PaletteEngine engine;
+    paletteSelect(engine, PALETTE_IRONBOW);
+    cv::Mat user_color(256, 1, CV_8UC3, engine.colors[PALETTE_IRONBOW]);
+    cv::Mat ref, out, out14;
+    cv::applyColorMap(gray, ref, user_color);
+    applyPalette(engine, gray, out);
+    applyPalette(engine, y14, out14);
+
+    double max_diff, mean_diff, max_diff14, mean_diff14;
+    bool pass = compareOutputs(ref.reshape(1), out.reshape(1), 0, 0, max_diff, mean_diff);
+    pass &= compareOutputs(ref.reshape(1), out14.reshape(1), 1, 0.5, max_diff14, mean_diff14);
+
+    cv::Mat tmp;
+    double t_legacy = timeIt([&]() {
+        cv::cvtColor(bgr, tmp, cv::COLOR_BGR2GRAY);
+        cv::applyColorMap(tmp, ref, cv::COLORMAP_JET);
+    }, kBenchIterations);
+    double t_bgr = timeIt([&]() { applyPalette(engine, gray, out); }, kBenchIterations);
+    double t_bgra = timeIt([&]() { applyPalette(engine, gray, tmp, PALETTE_FMT_BGRA); }, kBenchIterations);
+    double t_nv12 = timeIt([&]() { applyPalette(engine, gray, tmp, PALETTE_FMT_NV12); }, kBenchIterations);
+    double t_y14 = timeIt([&]() { applyPalette(engine, y14, out14); }, kBenchIterations);
+    int next = 0;
+    double t_switch = timeIt([&]() { paletteSelect(engine, next++ % PALETTE_BUILTIN_NUM); }, kBenchIterations);
+    printf("palette %dx%d: cvtColor+applyColorMap %.3f ms, bgr %.3f ms (x%.2f), bgra %.3f ms, "
+           "nv12 %.3f ms, y14 %.3f ms, switch %.3f ms, max diff %.0f/%.0f [%s]\n",
+           size.width, size.height, t_legacy, t_bgr, t_legacy / t_bgr, t_bgra, t_nv12, t_y14,
+           t_switch, max_diff, max_diff14, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 清晰度: 灰度图相邻像素平均绝对差(水平 + 竖直)
+static double sharpness(const cv::Mat& img)
+{
+    cv::Mat gray = img;
+    if (img.channels() == 3) {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    double sum = 0;
+    for (int y = 0; y + 1 < gray.rows; y++) {
+        const uchar* p = gray.ptr<uchar>(y);
+        const uchar* q = gray.ptr<uchar>(y + 1);
+        for (int x = 0; x + 1 < gray.cols; x++) {
+            sum += std::abs(p[x + 1] - p[x]) + std::abs(q[x] - p[x]);
+        }
+    }
+    return sum / ((double)(gray.rows - 1) * (gray.cols - 1));
+}
+
+// 2 倍放大: 参考帧隔点抽取后放大, 以 PSNR 与清晰度衡量质量;
+// 边缘导向需不差于双线性
+static bool benchUpscale(cv::Size size)
+{
+    // 实际流水线中放大前已做时域降噪, 参考帧先平滑以模拟降噪后的输入
+    cv::Mat gray = makeBenchFrame(size);
+    cv::GaussianBlur(gray, gray, cv::Size(3, 3), 0.8);
+    cv::Mat ref, small(size.height / 2, size.width / 2, CV_8UC3);
+    cv::cvtColor(gray, ref, cv::COLOR_GRAY2BGR);
+    for (int y = 0; y < small.rows; y++) {
+        for (int x = 0; x < small.cols; x++) {
+            small.at<cv::Vec3b>(y, x) = ref.at<cv::Vec3b>(y * 2, x * 2);
+        }
+    }
+
+    const char* names[] = {"nearest", "bilinear", "edge"};
+    double psnr[3], sharp[3], t[3];
+    cv::Mat out;
+    for (int mode = UPSCALE_NEAREST; mode <= UPSCALE_EDGE; mode++) {
+        upscale2x(small, out, mode);
+        psnr[mode] = cv::PSNR(ref, out);
+        sharp[mode] = sharpness(out) / sharpness(ref);
+        t[mode] = timeIt([&]() { upscale2x(small, out, mode); }, kBenchIterations);
+    }
+    double t_resize = timeIt([&]() { cv::resize(small, out, size, 0, 0, cv::INTER_LINEAR); }, kBenchIterations);
+    bool pass = psnr[UPSCALE_EDGE] >= psnr[UPSCALE_BILINEAR] && sharp[UPSCALE_EDGE] >= sharp[UPSCALE_BILINEAR];
+
+    printf("upscale %dx%d -> %dx%d: cv::resize %.3f ms", small.cols, small.rows, size.width, size.height, t_resize);
+    for (int mode = UPSCALE_NEAREST; mode <= UPSCALE_EDGE; mode++) {
+        printf(", %s %.3f ms psnr %.2f dB sharpness %.2f", names[mode], t[mode], psnr[mode], sharp[mode]);
+    }
+    printf(" [%s]\n", pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 坏点校正: 注入常亮/常暗/闪烁坏点, 标定需全部检出且无误检, 校正后坏点处接近原值
+static bool benchDpc(cv::Size size)
+{
+    cv::Mat clean = makeBenchFrame(size);
+    cv::RNG rng(7);
+    std::vector<cv::Point> stuck, blinking;
+    for (int i = 0; i < 60; i++) {
+        stuck.push_back(cv::Point(rng.uniform(0, size.width), rng.uniform(0, size.height)));
+    }
+    for (int i = 0; i < 20; i++) {
+        blinking.push_back(cv::Point(rng.uniform(0, size.width), rng.uniform(0, size.height)));
+    }
+    // 相邻成对的坏点
+    stuck.push_back(cv::Point(size.width / 3, size.height / 3));
+    stuck.push_back(cv::Point(size.width / 3 + 1, size.height / 3));
+    auto makeFrame = [&](int n) {
+        cv::Mat frame = clean.clone();
+        for (int y = 0; y < frame.rows; y++) {
+            uchar* p = frame.ptr<uchar>(y);
+            for (int x = 0; x < frame.cols; x++) {
+                p[x] = cv::saturate_cast<uchar>(p[x] + rng.gaussian(2));
+            }
+        }
+        for (size_t i = 0; i < stuck.size(); i++) {
+            frame.at<uchar>(stuck[i]) = i % 2 ? 0 : 255;
+        }
+        for (size_t i = 0; i < blinking.size(); i++) {
+            if (n % 3 == 0) {
+                frame.at<uchar>(blinking[i]) = 255;
+            }
+        }
+        return frame;
+    };
+
+    DpcState state;
+    dpcStartCalibration(state);
+    int n = 0;
+    while (!dpcAccumulate(state, makeFrame(n++))) {
+    }
+    std::vector<uchar> truth((size_t)size.area(), 0);
+    for (size_t i = 0; i < stuck.size(); i++) {
+        truth[stuck[i].y * size.width + stuck[i].x] = 1;
+    }
+    for (size_t i = 0; i < blinking.size(); i++) {
+        truth[blinking[i].y * size.width + blinking[i].x] = 1;
+    }
+    int expected = 0, found = 0, false_alarm = 0;
+    for (size_t i = 0; i < truth.size(); i++) {
+        expected += truth[i];
+    }
+    for (size_t i = 0; i < state.defects.size(); i++) {
+        if (truth[state.defects[i].index]) {
+            found++;
+        }
+        else {
+            false_alarm++;
+        }
+    }
+
+    cv::Mat frame = makeFrame(0), median;
+    dpcCorrect(state, frame);
+    double max_err = 0;
+    for (size_t i = 0; i < state.defects.size(); i++) {
+        int idx = (int)state.defects[i].index;
+        max_err = std::max(max_err, (double)std::abs(frame.data[idx] - clean.data[idx]));
+    }
+    bool pass = found == expected && false_alarm == 0 && max_err <= 16;
+
+    cv::Mat raw = makeFrame(0);
+    double t_sparse = timeIt([&]() { raw.copyTo(frame); dpcCorrect(state, frame); }, kBenchIterations);
+    double t_copy = timeIt([&]() { raw.copyTo(frame); }, kBenchIterations);
+    double t_median = timeIt([&]() { cv::medianBlur(raw, median, 3); }, kBenchIterations);
+    printf("dpc %dx%d: %d/%d defects found, %d false, max err %.0f, sparse correct %.3f ms, "
+           "full medianBlur %.3f ms [%s]\n",
+           size.width, size.height, found, expected, false_alarm, max_err,
+           std::max(t_sparse - t_copy, 0.0), t_median, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static bool benchSbnuc(cv::Size size)
+{
+    // 平移的场景 + 固定图案噪声(逐像素 + 列条纹) + 时域噪声
+    const int pan = 160, frames = 240, measure = 40;
+    // 场景纹理: 平滑纹理叠加在测试帧上, 平移时大部分像素有帧差
+    cv::RNG rng(34);
+    cv::Mat scene = makeBenchFrame(cv::Size(size.width + pan, size.height)), texture(scene.size(), CV_8UC1);
+    for (int y = 0; y < texture.rows; y++) {
+        for (int x = 0; x < texture.cols; x++) {
+            texture.at<uchar>(y, x) = cv::saturate_cast<uchar>(128 + rng.gaussian(60));
+        }
+    }
+    cv::GaussianBlur(texture, texture, cv::Size(7, 7), 2);
+    for (int y = 0; y < scene.rows; y++) {
+        uchar* p = scene.ptr<uchar>(y);
+        const uchar* t = texture.ptr<uchar>(y);
+        for (int x = 0; x < scene.cols; x++) {
+            p[x] = cv::saturate_cast<uchar>(p[x] + t[x] - 128);
+        }
+    }
+    cv::GaussianBlur(scene, scene, cv::Size(3, 3), 0.8);
+    cv::Mat fpn(size, CV_32FC1);
+    std::vector<float> column(size.width);
+    for (int x = 0; x < size.width; x++) {
+        column[x] = (float)rng.gaussian(2);
+    }
+    for (int y = 0; y < size.height; y++) {
+        float* f = fpn.ptr<float>(y);
+        for (int x = 0; x < size.width; x++) {
+            f[x] = (float)rng.gaussian(4) + column[x];
+        }
+    }
+
+    SbnucState state;
+    cv::Mat raw(size, CV_8UC1), out, residual = cv::Mat::zeros(size, CV_32FC1);
+    double rough_before = 0, rough_after = 0;
+    for (int n = 0; n < frames; n++) {
+        int phase = (n * 3) % (2 * pan);
+        cv::Mat clean = scene(cv::Rect(phase < pan ? phase : 2 * pan - phase, 0, size.width, size.height));
+        for (int y = 0; y < size.height; y++) {
+            const uchar* c = clean.ptr<uchar>(y);
+            const float* f = fpn.ptr<float>(y);
+            uchar* r = raw.ptr<uchar>(y);
+            for (int x = 0; x < size.width; x++) {
+                r[x] = cv::saturate_cast<uchar>(c[x] + f[x] + rng.gaussian(1));
+            }
+        }
+        sceneBasedNuc(state, raw, out);
+        if (n >= frames - measure) {
+            // 残余固定图案 = 多帧平均的 (校正结果 - 真值), 时域噪声被平均掉
+            for (int y = 0; y < size.height; y++) {
+                const uchar* c = clean.ptr<uchar>(y);
+                const uchar* o = out.ptr<uchar>(y);
+                float* r = residual.ptr<float>(y);
+                for (int x = 0; x < size.width; x++) {
+                    r[x] += (float)(o[x] - c[x]) / measure;
+                }
+            }
+            rough_before += nucRoughness(raw) / measure;
+            rough_after += nucRoughness(out) / measure;
+        }
+    }
+    cv::Scalar m, fpn_std, res_std;
+    cv::meanStdDev(fpn, m, fpn_std);
+    cv::meanStdDev(residual, m, res_std);
+    bool pass = res_std[0] < fpn_std[0] * 0.5 && rough_after < rough_before;
+
+    double t = timeIt([&]() { sceneBasedNuc(state, raw, out); }, kBenchIterations);
+    printf("sbnuc %dx%d: fpn std %.2f -> %.2f, roughness %.4f -> %.4f, %.3f ms [%s]\n",
+           size.width, size.height, fpn_std[0], res_std[0], rough_before, rough_after, t,
+           pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static bool benchFfcGuard()
+{
+    // 原始 YUYV 帧: 实时帧带随机噪声, 冻结帧重复上一帧
+    const size_t size = 384 * 288 * 2;
+    cv::RNG rng(35);
+    std::vector<uchar> raw(size);
+    auto liveFrame = [&]() {
+        for (size_t i = 0; i < size; i++) {
+            raw[i] = (uchar)rng.uniform(0, 256);
+        }
+    };
+
+    FfcGuard guard;
+    FrameMeta meta;
+    int skipped = 0, finished = 0;
+    auto feed = [&](int frames, bool live) {
+        int n = 0;
+        for (int i = 0; i < frames; i++) {
+            if (live) {
+                liveFrame();
+            }
+            n += ffcGuardUpdate(guard, &raw[0], size, meta) != FFC_IDLE;
+            finished += guard.finished;
+        }
+        return n;
+    };
+    const int settle = guard.params.settle_frames, hold = guard.params.max_hold_frames;
+
+    // 冻结帧: 6 帧冻结 + settle 帧
+    feed(10, true);
+    feed(1, false);
+    skipped = feed(5, false) + feed(10, true);
+    bool pass = skipped == 5 + settle && finished == 1;
+    // 快门状态: 闭合期间的实时帧也跳过
+    ffcGuardSetShutter(guard, ADV_SHUTTER_CLOSE_STA);
+    skipped = feed(4, true);
+    ffcGuardSetShutter(guard, ADV_SHUTTER_OPEN_STA);
+    skipped += feed(10, true);
+    pass &= skipped == 4 + settle && finished == 2;
+    // 静止测试图: 超过 max_hold_frames 后恢复处理
+    skipped = feed(1, true) + feed(hold + 30, false);
+    pass &= skipped == hold + settle && finished == 3 && guard.phase == FFC_IDLE;
+
+    double t = timeIt([&]() { ffcGuardUpdate(guard, &raw[0], size, meta); }, kBenchIterations);
+    printf("ffc guard 384x288: freeze/shutter/static sequences, %d ffc, check %.3f ms [%s]\n",
+           guard.ffc_count, t, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 以下两项的 SDK 对照(get_*_temp 取点方式, remap_temp/KE/BE/temp_correct 换算)只在链接真实 libirtemp 时作数
+// (CMake 链接 irtemp 时定义 HAVE_LIBIRTEMP); 替身库上的结果不代表与 SDK 等价, 报告 SKIP 且不判定 PASS
+#ifdef HAVE_LIBIRTEMP
+static const bool kBenchRealSdk = true;
+#else
+static const bool kBenchRealSdk = false;
+#endif
+
+static const char* sdkVerdict(bool pass)
+{
+    return !kBenchRealSdk ? "SKIP: no libirtemp" : pass ? "PASS" : "FAIL";
+}
+
+// TempInfo_t 与 SDK 结果一致: 最值相同, 坐标处的温度等于最值(并列时位置可不同), 平均值允许取整差 1
+static bool sameTempInfo(const cv::Mat& temp, const TempInfo_t& a, const TempInfo_t& b)
+{
+    return a.max_temp == b.max_temp && a.min_temp == b.min_temp && std::abs(a.avr_temp - b.avr_temp) <= 1 &&
+           temp.at<ushort>(a.max_cord.y, a.max_cord.x) == b.max_temp &&
+           temp.at<ushort>(a.min_cord.y, a.min_cord.x) == b.min_temp;
+}
+
+static bool benchTempStats(cv::Size size)
+{
+    // 温度帧: kelvin*16, 约 300K 背景上叠加测试场景
+    cv::Mat scene = makeBenchFrame(size), temp(size, CV_16UC1);
+    for (int y = 0; y < size.height; y++) {
+        for (int x = 0; x < size.width; x++) {
+            temp.at<ushort>(y, x) = (ushort)(4800 + scene.at<uchar>(y, x) * 8);
+        }
+    }
+    TempDataRes_t res = {(uint16_t)size.width, (uint16_t)size.height};
+
+    TempStatsEngine engine;
+    tempStatsSetSize(engine, size.width, size.height);
+    cv::RNG rng(37);
+    std::vector<Dot_t> points;
+    std::vector<Line_t> lines;
+    std::vector<Area_t> rects;
+    Area_t full = {0, 0, size.width, size.height};
+    rects.push_back(full);
+    for (int i = 0; i < 8; i++) {
+        Dot_t p = {rng.uniform(0, size.width), rng.uniform(0, size.height)};
+        points.push_back(p);
+        Line_t l = {rng.uniform(0, size.width), rng.uniform(0, size.height),
+                    rng.uniform(0, size.width), rng.uniform(0, size.height)};
+        lines.push_back(l);
+        int w = rng.uniform(1, size.width / 3), h = rng.uniform(1, size.height / 3);
+        Area_t r = {rng.uniform(0, size.width - w), rng.uniform(0, size.height - h), w, h};
+        rects.push_back(r);
+    }
+    // 水平/竖直线
+    Line_t horizontal = {5, size.height / 2, size.width - 5, size.height / 2};
+    Line_t vertical = {size.width / 2, size.height - 1, size.width / 2, 0};
+    lines.push_back(horizontal);
+    lines.push_back(vertical);
+    for (size_t i = 0; i < points.size(); i++) {
+        tempStatsAddPoint(engine, points[i]);
+    }
+    for (size_t i = 0; i < lines.size(); i++) {
+        tempStatsAddLine(engine, lines[i]);
+    }
+    for (size_t i = 0; i < rects.size(); i++) {
+        tempStatsAddRect(engine, rects[i]);
+    }
+    tempStatsCompute(engine, temp);
+
+    uint16_t* data = (uint16_t*)temp.data;
+    int mismatch = 0, k = 0;
+    for (size_t i = 0; i < points.size(); i++, k++) {
+        uint16_t value = 0;
+        get_point_temp(data, res, points[i], &value);
+        const TempInfo_t& r = engine.results[k];
+        mismatch += r.max_temp != value || r.min_temp != value || r.avr_temp != value;
+    }
+    for (size_t i = 0; i < lines.size(); i++, k++) {
+        TempInfo_t info;
+        get_line_temp(data, res, lines[i], &info);
+        mismatch += !sameTempInfo(temp, engine.results[k], info);
+    }
+    for (size_t i = 0; i < rects.size(); i++, k++) {
+        TempInfo_t info;
+        get_rect_temp(data, res, rects[i], &info);
+        mismatch += !sameTempInfo(temp, engine.results[k], info);
+    }
+    bool pass = mismatch == 0 || !kBenchRealSdk;
+
+    double t_sdk = timeIt([&]() {
+        TempInfo_t info;
+        uint16_t value;
+        for (size_t i = 0; i < points.size(); i++) {
+            get_point_temp(data, res, points[i], &value);
+        }
+        for (size_t i = 0; i < lines.size(); i++) {
+            get_line_temp(data, res, lines[i], &info);
+        }
+        for (size_t i = 0; i < rects.size(); i++) {
+            get_rect_temp(data, res, rects[i], &info);
+        }
+    }, kBenchIterations);
+    double t_engine = timeIt([&]() { tempStatsCompute(engine, temp); }, kBenchIterations);
+    printf("temp stats %dx%d: %d rois, %d mismatch, sdk %.3f ms, single pass %.3f ms [%s]\n",
+           size.width, size.height, (int)engine.rois.size(), mismatch, t_sdk, t_engine, sdkVerdict(pass));
+    return pass;
+}
+
+// 逐值 SDK 换算: recalc_NUC_with_env_correct -> remap_temp -> temp_correct
+static float sdkCelsius(const TempMapState& state, const EnvFactor_t& factor, uint16_t nuc, uint16_t& k16)
+{
+    uint16_t cal = nuc;
+    recalc_NUC_with_env_correct(&factor, std::min((int)nuc, kTempMapSize - 1), &cal);
+    remap_temp(&state.nuc_table[0], std::min((int)cal, kTempMapSize - 1), &k16);
+    float celsius = k16 / 16.0f - 273.15f;
+    if (state.params.correct) {
+        temp_correct(state.params.ems, state.params.tau, state.params.ta, celsius, &celsius);
+        k16 = cv::saturate_cast<uint16_t>(cvRound((celsius + 273.15) * 16));
+    }
+    return celsius;
+}
+
+static bool benchTempMap(cv::Size size)
+{
+    // 单调的合成 NUC_T 表, NUC 帧为测试场景映射到 14 位
+    std::vector<uint16_t> table(NUC_T_SIZE);
+    for (int i = 0; i < NUC_T_SIZE; i++) {
+        table[i] = (uint16_t)(1000 + i * 1.2 + i * i * 0.00005);
+    }
+    cv::Mat scene = makeBenchFrame(size), nuc(size, CV_16UC1), k16, celsius;
+    for (int y = 0; y < size.height; y++) {
+        for (int x = 0; x < size.width; x++) {
+            nuc.at<ushort>(y, x) = (ushort)(1500 + scene.at<uchar>(y, x) * 48);
+        }
+    }
+
+    TempMapState state;
+    // 未设置 NUC_T 表: 不输出, 调用者跳过本帧
+    bool pass = !tempMapApply(state, nuc, k16, CV_16U) && k16.empty();
+    // NUC_T 表文件(小端 uint16)与直接设置一致, 长度不符时拒绝
+    const char* table_path = "/tmp/ir_bench_nuc_t.bin";
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < NUC_T_SIZE; i++) {
+        bytes.push_back((uint8_t)(table[i] & 0xFF));
+        bytes.push_back((uint8_t)(table[i] >> 8));
+    }
+    bytes.push_back(0);
+    auto write_table = [&](size_t len) {
+        FILE* file = fopen(table_path, "wb");
+        if (file == NULL) {
+            return false;
+        }
+        fwrite(&bytes[0], 1, len, file);
+        fclose(file);
+        return true;
+    };
+    pass &= write_table(bytes.size()) && !tempMapLoadNucTable(state, table_path) && state.nuc_table.empty();
+    pass &= write_table(bytes.size() - 1) && tempMapLoadNucTable(state, table_path) && state.nuc_table == table;
+    remove(table_path);
+    auto check = [&]() {
+        if (!tempMapApply(state, nuc, k16, CV_16U) || !tempMapApply(state, nuc, celsius, CV_32F)) {
+            return size.area();
+        }
+        EnvFactor_t factor;
+        calculate_new_KE_and_BE_with_nuc_t(&state.params.env, &state.nuc_table[0], state.params.gain, &factor);
+        int mismatch = 0;
+        for (int y = 0; y < size.height; y++) {
+            for (int x = 0; x < size.width; x++) {
+                uint16_t ref_k16;
+                float ref = sdkCelsius(state, factor, nuc.at<ushort>(y, x), ref_k16);
+                mismatch += k16.at<ushort>(y, x) != ref_k16 || celsius.at<float>(y, x) != ref;
+            }
+        }
+        return mismatch;
+    };
+    int mismatch = check();
+    // 只改 temp_correct 参数: 只重建最后一级
+    int builds[3] = {state.builds[0], state.builds[1], state.builds[2]};
+    state.params.correct = true;
+    state.params.ems = 0.95f;
+    mismatch += check();
+    pass &= state.builds[0] == builds[0] && state.builds[1] == builds[1] && state.builds[2] == builds[2] + 1;
+    // 改大气温度: 不重建 NUC_T 映射
+    state.params.env.Ta += 10;
+    mismatch += check();
+    pass &= state.builds[0] == builds[0] && state.builds[1] == builds[1] + 1 && state.builds[2] == builds[2] + 2;
+    // 参数不变: 不重建
+    tempMapUpdate(state);
+    pass &= state.builds[0] == builds[0] && state.builds[1] == builds[1] + 1 && state.builds[2] == builds[2] + 2;
+    // 与 SDK 逐值换算的对照只在链接真实 libirtemp 时有意义
+    pass &= mismatch == 0 || !kBenchRealSdk;
+
+    EnvFactor_t factor;
+    calculate_new_KE_and_BE_with_nuc_t(&state.params.env, &state.nuc_table[0], state.params.gain, &factor);
+    double t_sdk = timeIt([&]() {
+        uint16_t v;
+        for (int y = 0; y < size.height; y++) {
+            for (int x = 0; x < size.width; x++) {
+                sdkCelsius(state, factor, nuc.at<ushort>(y, x), v);
+            }
+        }
+    }, 5);
+    double t_lut = timeIt([&]() { tempMapApply(state, nuc, k16, CV_16U); }, kBenchIterations);
+    double t_rebuild = timeIt([&]() { state.params.ems = state.params.ems == 0.95f ? 0.9f : 0.95f; tempMapUpdate(state); }, 5);
+    printf("temp map %dx%d: %d mismatch, sdk per pixel %.3f ms, lut %.3f ms, correction rebuild %.3f ms [%s]\n",
+           size.width, size.height, mismatch, t_sdk, t_lut, t_rebuild, pass ? sdkVerdict(true) : "FAIL");
+    return pass;
+}
+
+static bool benchAlarm(cv::Size size)
+{
+    const int64_t frame_period = 33333333;  // 30 fps
+    cv::Mat scene = makeBenchFrame(size), base(size, CV_16UC1), temp;
+    for (int y = 0; y < size.height; y++) {
+        for (int x = 0; x < size.width; x++) {
+            base.at<ushort>(y, x) = (ushort)(4800 + scene.at<uchar>(y, x) * 2);
+        }
+    }
+    TempStatsEngine stats;
+    tempStatsSetSize(stats, size.width, size.height);
+    Area_t hot_area = {size.width / 8, size.height / 8, size.width / 4, size.height / 4};
+    Area_t cold_area = {size.width / 2, size.height / 8, size.width / 4, size.height / 4};
+    Area_t ramp_area = {size.width / 8, size.height / 2, size.width / 4, size.height / 4};
+    cv::Rect hot_spot(size.width / 4, size.height / 4, 4, 4), ramp_spot(size.width / 4, size.height * 5 / 8, 4, 4);
+
+    AlarmEngine engine;
+    AlarmRule rule;
+    rule.roi = tempStatsAddRect(stats, hot_area);
+    rule.threshold = 16 * 350;
+    const int high = alarmAddRule(engine, rule);
+    rule.roi = tempStatsAddRect(stats, cold_area);
+    rule.type = ALARM_RULE_LOW;
+    rule.threshold = 16 * 290;
+    alarmAddRule(engine, rule);
+    rule.roi = tempStatsAddRect(stats, ramp_area);
+    rule.type = ALARM_RULE_RISE;
+    rule.threshold = 16 * 5;    // 5 K/s
+    const int rise = alarmAddRule(engine, rule);
+    const int frame_high = alarmAddFrameHigh(engine, stats, 16 * 380);
+
+    // 热点在第 10~29 帧出现, 第 45 帧单帧毛刺; 温升区在第 20~50 帧以 10 K/s 升温
+    std::vector<AlarmEvent> events;
+    for (int n = 0; n < 120; n++) {
+        base.copyTo(temp);
+        if ((n >= 10 && n < 30) || n == 45) {
+            temp(hot_spot).setTo(cv::Scalar(16 * 400));
+        }
+        temp(ramp_spot).setTo(cv::Scalar(16 * 320 + std::min(std::max(n - 20, 0), 30) * 16 * 10 / 30));
+        alarmEvaluate(engine, stats, temp, n * frame_period);
+        AlarmEvent event;
+        while (alarmQueuePop(engine.queue, event)) {
+            events.push_back(event);
+        }
+    }
+    // 期望: HIGH/整帧高温在第 12 帧报警(3 帧去抖)、第 34 帧解除(5 帧去抖), 毛刺不报警;
+    // 温升先报警后解除; 低温区不报警
+    int raise_frame[4] = {-1, -1, -1, -1}, clear_frame[4] = {-1, -1, -1, -1}, count[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < events.size(); i++) {
+        int n = (int)(events[i].frame_ns / frame_period);
+        (events[i].event == ALARM_EVENT_RAISE ? raise_frame : clear_frame)[events[i].rule] = n;
+        count[events[i].rule]++;
+    }
+    bool pass = raise_frame[high] == 12 && clear_frame[high] == 34 && count[high] == 2 &&
+                raise_frame[frame_high] == 12 && clear_frame[frame_high] == 34 && count[frame_high] == 2 &&
+                count[rise] == 2 && raise_frame[rise] > 20 && clear_frame[rise] > 50 && count[1] == 0;
+
+    // 延迟: 帧到达 -> 判断完成, 以及 -> 另一线程取到事件
+    AlarmEngine timed;
+    timed.rules = engine.rules;
+    for (size_t i = 0; i < timed.rules.size(); i++) {
+        timed.rules[i].active = false;
+        timed.rules[i].counter = 0;
+        timed.rules[i].rise_num = 0;
+    }
+    std::atomic<bool> done(false);
+    int64_t consumer_sum = 0, consumer_max = 0;
+    int consumed = 0;
+    std::thread consumer([&]() {
+        AlarmEvent event;
+        while (!done.load() || timed.queue.head.load() != timed.queue.tail.load()) {
+            if (alarmQueuePop(timed.queue, event)) {
+                int64_t latency = alarmNowNs() - event.frame_ns;
+                consumer_sum += latency;
+                consumer_max = std::max(consumer_max, latency);
+                consumed++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int n = 0; n < 200; n++) {
+        base.copyTo(temp);
+        if ((n / 10) % 2) {
+            temp(hot_spot).setTo(cv::Scalar(16 * 400));
+        }
+        alarmEvaluate(timed, stats, temp, alarmNowNs());
+    }
+    done = true;
+    consumer.join();
+    pass &= consumed > 0 && timed.queue.dropped.load() == 0;
+
+    printf("alarm %dx%d: %d rules, %d events, eval latency mean %.3f ms max %.3f ms, "
+           "consumer latency mean %.3f ms max %.3f ms [%s]\n",
+           size.width, size.height, (int)engine.rules.size(), (int)events.size(),
+           timed.latency_sum_ns / 1e6 / timed.latency_count, timed.latency_max_ns / 1e6,
+           consumed ? consumer_sum / 1e6 / consumed : 0.0, consumer_max / 1e6, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 参考实现: 8 邻域洪水填充, 逐像素统计
+static void refHotspots(const cv::Mat& temp, int threshold, int min_area, std::vector<HotspotBlob>& blobs)
+{
+    blobs.clear();
+    cv::Mat visited = cv::Mat::zeros(temp.size(), CV_8UC1);
+    std::vector<cv::Point> stack;
+    for (int y = 0; y < temp.rows; y++) {
+        for (int x = 0; x < temp.cols; x++) {
+            if (visited.at<uchar>(y, x) || temp.at<ushort>(y, x) <= threshold) {
+                continue;
+            }
+            HotspotBlob blob;
+            blob.area = 0;
+            blob.peak = -1;
+            double sx = 0, sy = 0;
+            int x0 = x, y0 = y, x1 = x, y1 = y;
+            visited.at<uchar>(y, x) = 1;
+            stack.push_back(cv::Point(x, y));
+            while (!stack.empty()) {
+                cv::Point p = stack.back();
+                stack.pop_back();
+                int v = temp.at<ushort>(p);
+                blob.area++;
+                sx += p.x;
+                sy += p.y;
+                if (v > blob.peak || (v == blob.peak && (p.y < blob.peak_pos.y ||
+                    (p.y == blob.peak_pos.y && p.x < blob.peak_pos.x)))) {
+                    blob.peak = v;
+                    blob.peak_pos = p;
+                }
+                x0 = std::min(x0, p.x);
+                y0 = std::min(y0, p.y);
+                x1 = std::max(x1, p.x);
+                y1 = std::max(y1, p.y);
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        cv::Point q(p.x + dx, p.y + dy);
+                        if (q.x >= 0 && q.y >= 0 && q.x < temp.cols && q.y < temp.rows &&
+                            !visited.at<uchar>(q) && temp.at<ushort>(q) > threshold) {
+                            visited.at<uchar>(q) = 1;
+                            stack.push_back(q);
+                        }
+                    }
+                }
+            }
+            if (blob.area >= min_area) {
+                blob.centroid = cv::Point2f((float)(sx / blob.area), (float)(sy / blob.area));
+                blob.bbox = cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+                blobs.push_back(blob);
+            }
+        }
+    }
+    std::sort(blobs.begin(), blobs.end(), [](const HotspotBlob& a, const HotspotBlob& b) {
+        if (a.peak != b.peak) {
+            return a.peak > b.peak;
+        }
+        return a.peak_pos.y != b.peak_pos.y ? a.peak_pos.y < b.peak_pos.y : a.peak_pos.x < b.peak_pos.x;
+    });
+}
+
+static bool sameBlob(const HotspotBlob& a, const HotspotBlob& b)
+{
+    return a.area == b.area && a.peak == b.peak && a.peak_pos == b.peak_pos && a.bbox == b.bbox &&
+           std::abs(a.centroid.x - b.centroid.x) < 1e-3f && std::abs(a.centroid.y - b.centroid.y) < 1e-3f;
+}
+
+static bool benchHotspot(cv::Size size)
+{
+    cv::Mat scene = makeBenchFrame(size), base(size, CV_16UC1), temp;
+    for (int y = 0; y < size.height; y++) {
+        for (int x = 0; x < size.width; x++) {
+            base.at<ushort>(y, x) = (ushort)(4800 + scene.at<uchar>(y, x) * 2);
+        }
+    }
+    // 孤立的单像素热点应被面积门限滤除
+    cv::RNG rng(7);
+    for (int i = 0; i < 20; i++) {
+        base.at<ushort>(rng.uniform(0, size.height), rng.uniform(0, size.width)) = 16 * 340;
+    }
+    // U 形目标: 两臂的行程到底部才连通
+    int ux = size.width * 3 / 4, uy = size.height / 8, uw = size.width / 16;
+    base(cv::Rect(ux, uy, 3, uw * 2)).setTo(cv::Scalar(16 * 345));
+    base(cv::Rect(ux + uw, uy, 3, uw * 2)).setTo(cv::Scalar(16 * 345));
+    base(cv::Rect(ux, uy + uw * 2, uw + 3, 3)).setTo(cv::Scalar(16 * 346));
+
+    HotspotState state;
+    state.params.threshold = 16 * 330;
+    const int r = std::max(size.height / 32, 3);
+    // 圆形目标每帧右移 2 像素; 方形目标在第 5~14 帧出现
+    cv::Rect transient(size.width / 8, size.height * 3 / 4, r * 2, r * 2);
+    std::vector<HotspotBlob> ref;
+    std::vector<HotspotEvent> events;
+    std::vector<int> event_frame;
+    int mismatch = 0, moving_id = -2, lost_frame = -1, appear_frame = -1;
+    for (int n = 0; n < 40; n++) {
+        base.copyTo(temp);
+        cv::Point c(size.width / 8 + n * 2, size.height / 3);
+        for (int y = -r; y <= r; y++) {
+            for (int x = -r; x <= r; x++) {
+                if (x * x + y * y <= r * r) {
+                    temp.at<ushort>(c.y + y, c.x + x) = (ushort)(16 * 360 - (x * x + y * y));
+                }
+            }
+        }
+        if (n >= 5 && n < 15) {
+            temp(transient).setTo(cv::Scalar(16 * 350));
+        }
+        hotspotUpdate(state, temp);
+        refHotspots(temp, state.params.threshold, state.params.min_area, ref);
+        if (ref.size() != state.blobs.size()) {
+            mismatch++;
+        }
+        else {
+            for (size_t i = 0; i < ref.size(); i++) {
+                mismatch += !sameBlob(ref[i], state.blobs[i]);
+            }
+        }
+        // 最热的圆形目标应始终保持同一编号
+        for (size_t i = 0; i < state.tracks.size(); i++) {
+            if (state.tracks[i].missed == 0 && state.tracks[i].blob.peak == 16 * 360) {
+                if (moving_id == -2) {
+                    moving_id = state.tracks[i].id;
+                }
+                else if (moving_id != state.tracks[i].id) {
+                    moving_id = -1;
+                }
+            }
+        }
+        for (size_t i = 0; i < state.events.size(); i++) {
+            if (state.events[i].blob.peak == 16 * 350) {
+                (state.events[i].type == HOTSPOT_APPEAR ? appear_frame : lost_frame) = n;
+            }
+            events.push_back(state.events[i]);
+        }
+    }
+    // 期望: 方形目标第 6 帧确认(2 帧), 连续丢失 4 帧后于第 18 帧删除; 共 3 个 APPEAR 与 1 个 LOST
+    int appear = 0, lost = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        (events[i].type == HOTSPOT_APPEAR ? appear : lost)++;
+    }
+    bool pass = mismatch == 0 && moving_id >= 0 && appear_frame == 6 && lost_frame == 18 &&
+                appear == 3 && lost == 1 && !state.overflow;
+
+    double t_ref = timeIt([&]() { refHotspots(temp, state.params.threshold, state.params.min_area, ref); },
+                          kBenchIterations);
+    double t_fast = timeIt([&]() { hotspotUpdate(state, temp); }, kBenchIterations);
+    printf("hotspot %dx%d: %d blobs, %d mismatch, %d events, %.3f ms (flood fill %.3f ms) [%s]\n",
+           size.width, size.height, (int)state.blobs.size(), mismatch, (int)events.size(),
+           t_fast, t_ref, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 模拟总线事务耗时
+static void busSleep(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static bool benchCmdExec()
+{
+    CmdExecutor exec;
+    cmdExecStart(exec, NULL);
+    std::mutex order_mutex;
+    std::vector<int> order;     // 实际执行顺序, 记录命令标识
+    auto record = [&](int tag) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(tag);
+    };
+
+    // 先占住通道, 期间提交的命令在队列中合并与排序
+    std::future<CmdResult> blocker = cmdExecCall(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+        [&](IrcmdHandle_t*, CmdResult&) { busSleep(30); record(-1); return IRLIB_SUCCESS; });
+    busSleep(5);
+    // 滑块连续 10 次调整对比度, 只应写入最后一次
+    int contrast_done = 0;
+    for (int level = 0; level < 10; level++) {
+        cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_CONTRAST, true,
+            [&record, level](IrcmdHandle_t*, CmdResult&) { busSleep(5); record(100 + level); return IRLIB_SUCCESS; },
+            [&contrast_done](const CmdResult& r) { contrast_done += r.error == IRLIB_SUCCESS; });
+    }
+    // 3 次整帧温度读取共享一次结果
+    int reads_done = 0;
+    float read_value = 0;
+    for (int i = 0; i < 3; i++) {
+        cmdExecSubmit(exec, CMD_PRIORITY_READ, CMD_KEY_FRAME_TEMP, false,
+            [&record, i](IrcmdHandle_t*, CmdResult& r) {
+                busSleep(5);
+                record(200 + i);
+                r.frame_temp.max_temp = 36.5f;
+                return IRLIB_SUCCESS;
+            },
+            [&](const CmdResult& r) { reads_done++; read_value += r.frame_temp.max_temp; });
+    }
+    // FFC 最后提交但最先执行
+    std::future<CmdResult> ffc = cmdExecCall(exec, CMD_PRIORITY_URGENT, CMD_KEY_FFC, false,
+        [&](IrcmdHandle_t*, CmdResult&) { busSleep(5); record(300); return IRLIB_SUCCESS; });
+    blocker.wait();
+    ffc.wait();
+
+    // 采集线程每帧提交 UI 调整, 测量提交耗时(不应等待总线)
+    int64_t submit_max = 0, submit_sum = 0;
+    const int frames = 100;
+    for (int n = 0; n < frames; n++) {
+        int64_t start = alarmNowNs();
+        cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_BRIGHTNESS, true,
+                      [](IrcmdHandle_t*, CmdResult&) { busSleep(8); return IRLIB_SUCCESS; });
+        int64_t cost = alarmNowNs() - start;
+        submit_max = std::max(submit_max, cost);
+        submit_sum += cost;
+        busSleep(2);
+    }
+    // 停止时未执行的命令以错误完成
+    for (int i = 0; i < 3; i++) {
+        cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+                      [](IrcmdHandle_t*, CmdResult&) { busSleep(10); return IRLIB_SUCCESS; });
+    }
+    std::future<CmdResult> cancelled = cmdExecCall(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+        [](IrcmdHandle_t*, CmdResult&) { return IRLIB_SUCCESS; });
+    double occupancy = cmdExecOccupancy(exec);
+    cmdExecStop(exec);
+    bool stopped = cancelled.get().error == IRCMD_CMD_EXECUTE_FAILED &&
+                   cmdExecCall(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+                               [](IrcmdHandle_t*, CmdResult&) { return IRLIB_SUCCESS; }).get().error != IRLIB_SUCCESS;
+
+    bool ordered = order.size() >= 4 && order[0] == -1 && order[1] == 300 && order[2] == 200 && order[3] == 109;
+    bool pass = ordered && contrast_done == 10 && reads_done == 3 && read_value == 36.5f * 3 &&
+                exec.coalesced >= 11 && submit_max < 2000000 && stopped;
+    printf("cmdexec: %u submitted, %u coalesced, %u executed, submit mean %.1f us max %.1f us, "
+           "occupancy %.0f%% [%s]\n",
+           exec.submitted, exec.coalesced, exec.executed, submit_sum / 1e3 / frames, submit_max / 1e3,
+           occupancy * 100, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 模拟设备的参数寄存器, 每次读写耗时 2 ms
+static int g_fake_param[DEV_PARAM_NUM];
+static std::atomic<int> g_fake_calls(0);
+
+template<int ID>
+static IrlibError_e fakeParamGet(IrcmdHandle_t*, int* value)
+{
+    busSleep(2);
+    g_fake_calls++;
+    *value = g_fake_param[ID];
+    return IRLIB_SUCCESS;
+}
+
+template<int ID>
+static IrlibError_e fakeParamSet(IrcmdHandle_t*, int value)
+{
+    busSleep(2);
+    g_fake_calls++;
+    g_fake_param[ID] = value;
+    return IRLIB_SUCCESS;
+}
+
+static IrlibError_e fakeParamUnsupported(IrcmdHandle_t*, int*)
+{
+    g_fake_calls++;
+    return IRCMD_CMD_UNSUPPORTED;
+}
+
+static IrlibError_e fakeRestore(IrcmdHandle_t*, int)
+{
+    busSleep(2);
+    g_fake_param[DEV_PARAM_CONTRAST] = 50;
+    return IRLIB_SUCCESS;
+}
+
+static bool benchDevParam()
+{
+    static const DevParamDesc table[DEV_PARAM_NUM] = {
+        {"gain", fakeParamGet<0>, fakeParamSet<0>},
+        {"palette", fakeParamGet<1>, fakeParamSet<1>},
+        {"brightness", fakeParamGet<2>, fakeParamSet<2>},
+        {"contrast", fakeParamGet<3>, fakeParamSet<3>},
+        {"detail", fakeParamGet<4>, fakeParamSet<4>},
+        {"noise_reduction", fakeParamGet<5>, fakeParamSet<5>},
+        {"agc", fakeParamGet<6>, fakeParamSet<6>},
+        {"scene_mode", fakeParamGet<7>, fakeParamSet<7>},
+        {"mirror_flip", fakeParamUnsupported, fakeParamSet<8>},
+        {"auto_ffc", fakeParamGet<9>, fakeParamSet<9>},
+    };
+    for (int i = 0; i < DEV_PARAM_NUM; i++) {
+        g_fake_param[i] = i * 10;
+    }
+    CmdExecutor exec;
+    cmdExecStart(exec, NULL);
+    DevParamCache cache;
+    cache.table = table;
+    cache.restore = fakeRestore;
+    devParamAttach(cache, &exec);
+    std::atomic<int> notified(0), contrast_notified(0);
+    std::atomic<int> last_contrast(-1);
+    devParamSubscribe(cache, -1, [&](int, int) { notified++; });
+    devParamSubscribe(cache, DEV_PARAM_CONTRAST, [&](int, int value) {
+        contrast_notified++;
+        last_contrast = value;
+    });
+
+    // 启动时一次批量读取, 不支持的参数保持无效
+    int loaded = devParamLoad(cache).get().value;
+    int unsupported;
+    bool pass = loaded == DEV_PARAM_NUM - 1 && notified == DEV_PARAM_NUM - 1 &&
+                !devParamGet(cache, DEV_PARAM_MIRROR_FLIP, unsupported);
+
+    // 读取只访问缓存
+    int calls = g_fake_calls;
+    int value = 0, sum = 0;
+    const int reads = 10000;
+    int64_t start = alarmNowNs();
+    for (int i = 0; i < reads; i++) {
+        devParamGet(cache, i % DEV_PARAM_NUM, value);
+        sum += value;
+    }
+    double read_ns = (double)(alarmNowNs() - start) / reads;
+    pass &= g_fake_calls == calls;
+
+    // 通道忙时连续 10 次写对比度, 只写入最后一次
+    cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+                  [](IrcmdHandle_t*, CmdResult&) { busSleep(20); return IRLIB_SUCCESS; });
+    for (int level = 0; level < 10; level++) {
+        devParamSet(cache, DEV_PARAM_CONTRAST, 60 + level);
+    }
+    cmdExecCall(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+                [](IrcmdHandle_t*, CmdResult&) { return IRLIB_SUCCESS; }).wait();
+    int contrast = 0;
+    pass &= cache.device_writes == 1 && g_fake_param[DEV_PARAM_CONTRAST] == 69 &&
+            devParamGet(cache, DEV_PARAM_CONTRAST, contrast) && contrast == 69 &&
+            contrast_notified == 2 && last_contrast == 69;
+    // 与缓存值相同的写入不访问设备
+    devParamSet(cache, DEV_PARAM_CONTRAST, 69);
+    pass &= cache.device_writes == 1;
+
+    // 恢复默认值后只通知变化的参数
+    int before = notified;
+    pass &= devParamRestoreDefault(cache, 0).get().error == IRLIB_SUCCESS &&
+            notified == before + 1 && last_contrast == 50;
+    devParamInvalidate(cache);
+    pass &= !devParamGet(cache, DEV_PARAM_GAIN, value);
+    cmdExecStop(exec);
+
+    printf("devparam: %d params loaded, cached read %.0f ns (device read 2 ms), %u device reads, "
+           "%u device writes, %d notifications [%s]\n",
+           loaded, read_ns, cache.device_reads, cache.device_writes, (int)notified, pass ? "PASS" : "FAIL");
+    return pass && sum >= 0;
+}
+
+// 模拟遥测读取: 每次 3 ms; 快门在 g_fake_close_* 时间段内闭合
+static std::atomic<int64_t> g_fake_close_begin(0), g_fake_close_end(0);
+
+static IrlibError_e fakeTelemRead(IrcmdHandle_t*, int, CmdResult& result)
+{
+    busSleep(3);
+    result.temperature = 42.0f;
+    return IRLIB_SUCCESS;
+}
+
+static IrlibError_e fakeTelemShutter(IrcmdHandle_t*, int, CmdResult& result)
+{
+    busSleep(3);
+    int64_t now = alarmNowNs();
+    result.value = now >= g_fake_close_begin && now < g_fake_close_end ? ADV_SHUTTER_CLOSE_STA : ADV_SHUTTER_OPEN_STA;
+    return IRLIB_SUCCESS;
+}
+
+static bool runTelemetry(float max_occupancy, int run_ms, TelemetrySnapshot& snap, FfcGuard* ffc,
+                         std::vector<TelemetrySample>& frame_temp)
+{
+    static const TelemetryReader readers[TELEM_NUM] = {
+        fakeTelemRead, fakeTelemRead, fakeTelemRead, fakeTelemRead, fakeTelemShutter,
+    };
+    CmdExecutor exec;
+    cmdExecStart(exec, NULL);
+    TelemetryState state;
+    state.readers = readers;
+    state.ffc = ffc;
+    state.params.period_ms[TELEM_DEVICE_TEMP] = 100;
+    state.params.period_ms[TELEM_POWERED_TIME] = 400;
+    state.params.period_ms[TELEM_REALTIME_STATUS] = 50;
+    state.params.period_ms[TELEM_FRAME_TEMP] = 40;
+    state.params.period_ms[TELEM_SHUTTER] = 20;
+    state.params.jitter_ms = 5;
+    state.params.burst_window_ms = 10;
+    state.params.ffc_holdoff_ms = 200;
+    state.params.max_occupancy = max_occupancy;
+    telemetryStart(state, &exec);
+    busSleep(run_ms);
+    telemetrySnapshot(state, snap);
+    telemetryHistory(state, TELEM_FRAME_TEMP, frame_temp);
+    telemetryStop(state);
+    cmdExecStop(exec);
+    return true;
+}
+
+static bool benchTelemetry()
+{
+    // 需求约为 107 次读取/秒 x 3 ms = 32% 占用
+    TelemetrySnapshot open_snap, capped_snap, ffc_snap;
+    std::vector<TelemetrySample> frame_temp;
+    runTelemetry(0.5f, 1000, open_snap, NULL, frame_temp);
+    uint32_t reads = 0;
+    for (int m = 0; m < TELEM_NUM; m++) {
+        reads += open_snap.samples[m];
+    }
+    // 未触及上限时各指标按周期读取, 且多个到期指标合并为一次读取
+    bool pass = open_snap.samples[TELEM_SHUTTER] >= 35 && open_snap.samples[TELEM_FRAME_TEMP] >= 18 &&
+                open_snap.samples[TELEM_POWERED_TIME] >= 2 && reads > open_snap.bursts * 3 / 2;
+
+    runTelemetry(0.1f, 1000, capped_snap, NULL, frame_temp);
+    pass &= capped_snap.occupancy <= 0.11 && capped_snap.deferred > 0;
+
+    // 快门闭合后 200 ms 内只读快门状态, 快门状态同步给 FFC 检测
+    FfcGuard guard;
+    int64_t begin = alarmNowNs() + 300000000;
+    g_fake_close_begin = begin;
+    g_fake_close_end = begin + 100000000;
+    runTelemetry(0.5f, 800, ffc_snap, &guard, frame_temp);
+    int during = 0;
+    for (size_t i = 0; i < frame_temp.size(); i++) {
+        // 快门闭合最晚在一个快门周期加一次读取后被发现
+        if (frame_temp[i].t_ns > begin + 30000000 && frame_temp[i].t_ns < begin + 200000000) {
+            during++;
+        }
+    }
+    pass &= during == 0 && guard.shutter.load() == ADV_SHUTTER_OPEN_STA && ffc_snap.deferred > 0;
+
+    printf("telemetry: %u reads in %u bursts, occupancy %.1f%% (cap 50%%), capped %.1f%% (cap 10%%, %u deferred), "
+           "%d reads during FFC holdoff [%s]\n",
+           reads, open_snap.bursts, open_snap.occupancy * 100, capped_snap.occupancy * 100, capped_snap.deferred,
+           during, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// 构造后再设置种子, 返回视频/控制通道各 32 次调用的失败位图
+static uint64_t mockErrorPattern(uint64_t seed)
+{
+    MockCamera cam;
+    cam.params.width = 32;
+    cam.params.height = 16;
+    cam.params.fps = 1000;
+    cam.params.cmd_latency_us = 0;
+    cam.params.frame_error_rate = 0.3f;
+    cam.params.cmd_error_rate = 0.3f;
+    cam.params.seed = seed;
+    IrVideoHandle_t video;
+    IrControlHandle_t control;
+    mockCamAttachVideo(cam, video);
+    mockCamAttachControl(cam, control);
+    void* dev = video.ir_video_handle;
+    video.ir_video_start_stream(dev, NULL);
+    std::vector<uint8_t> raw(mockCamFrameSize(cam));
+    uint8_t payload[4] = {0};
+    uint64_t pattern = 0;
+    for (int i = 0; i < 32; i++) {
+        if (video.ir_video_frame_get(dev, NULL, &raw[0], (int)raw.size()) != IRLIB_SUCCESS) {
+            pattern |= (uint64_t)1 << i;
+        }
+        if (control.ir_control_write(control.ir_control_handle, NULL, payload, sizeof(payload)) != 0) {
+            pattern |= (uint64_t)1 << (32 + i);
+        }
+    }
+    video.ir_video_stop_stream(dev, NULL);
+    return pattern;
+}
+
+static bool benchMockCamera()
+{
+    // 50 fps 模拟相机, 控制事务 2 ms; 采集循环按真实主循环的顺序处理
+    MockCamera cam;
+    cam.params.fps = 50;
+    cam.params.cmd_latency_us = 2000;
+    cam.params.ffc_frames = 6;
+    IrVideoHandle_t video;
+    IrControlHandle_t control;
+    mockCamAttachVideo(cam, video);
+    mockCamAttachControl(cam, control);
+    void* dev = video.ir_video_handle;
+    video.ir_video_open(dev, NULL);
+    video.ir_video_start_stream(dev, NULL);
+
+    // 命令执行器经控制通道发送命令, 前 3 次传输失败
+    CmdExecutor exec;
+    cmdExecStart(exec, NULL);
+    mockCamInjectErrors(cam, MOCK_CONTROL, 3);
+    std::atomic<int> cmd_ok(0), cmd_failed(0);
+    for (int i = 0; i < 20; i++) {
+        cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_NONE, false,
+            [&control](IrcmdHandle_t*, CmdResult&) {
+                uint8_t payload[16] = {0};
+                return control.ir_control_write(control.ir_control_handle, NULL, payload, sizeof(payload)) == 0 ?
+                       IRLIB_SUCCESS : IRCMD_CMD_EXECUTE_FAILED;
+            },
+            [&](const CmdResult& r) { (r.error == IRLIB_SUCCESS ? cmd_ok : cmd_failed)++; });
+    }
+
+    const int frames = 60;
+    const int size = mockCamFrameSize(cam);
+    std::vector<uint8_t> raw(size);
+    FfcGuard guard;
+    FrameMeta meta;
+    TemporalDenoiseState denoise;
+    cv::Mat bgr, gray, out;
+    int errors = 0, ffc_skipped = 0;
+    int64_t stall_gap = 0, first_20 = 0;
+    int64_t start = alarmNowNs(), last = start;
+    for (int n = 0; n < frames; n++) {
+        if (n == 20) {
+            mockCamTriggerFfc(cam);
+        }
+        if (n == 40) {
+            mockCamInjectStall(cam, MOCK_VIDEO, 100);
+        }
+        if (n == 50) {
+            mockCamInjectErrors(cam, MOCK_VIDEO, 2);
+        }
+        if (video.ir_video_frame_get(dev, NULL, &raw[0], size) != IRLIB_SUCCESS) {
+            errors++;
+            continue;
+        }
+        int64_t now = alarmNowNs();
+        if (n == 40) {
+            stall_gap = now - last;
+        }
+        if (n == 19) {
+            first_20 = now - start;
+        }
+        last = now;
+        if (ffcGuardUpdate(guard, &raw[0], size, meta) != FFC_IDLE) {
+            ffc_skipped++;
+            continue;
+        }
+        cv::cvtColor(cv::Mat(cam.params.height, cam.params.width, CV_8UC2, &raw[0]), bgr, cv::COLOR_YUV2BGR_YUYV);
+        cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+        temporalDenoise(denoise, gray, out);
+    }
+    video.ir_video_stop_stream(dev, NULL);
+    cmdExecStop(exec);
+
+    double fps = 19 * 1e9 / std::max(first_20, (int64_t)1);
+    double cmd_ms = cam.stats.command_busy_ns.load() / 1e6 / std::max(cam.stats.commands.load(), 1u);
+    bool pass = fps > 45 && fps < 55 &&
+                stall_gap >= 100000000 && cam.stats.dropped >= 4 &&
+                errors == 2 && cam.stats.frame_errors == 2 &&
+                cam.stats.ffc_frames == 6 && guard.ffc_count >= 1 && ffc_skipped >= 6 &&
+                cmd_ok == 17 && cmd_failed == 3 && cam.stats.command_errors == 3 && cmd_ms >= 2.0;
+    // 种子在取流/挂接时生效: 相同种子错误序列相同, 不同种子不同
+    uint64_t pattern = mockErrorPattern(7);
+    bool seeded = pattern == mockErrorPattern(7) && pattern != mockErrorPattern(8);
+    pass &= seeded;
+    printf("mock camera 384x288: %.1f fps, stall gap %.0f ms (%u dropped), %d frame errors, "
+           "ffc %u frozen / %d skipped, %u commands (%u failed) %.2f ms each, seed %s [%s]\n",
+           fps, stall_gap / 1e6, cam.stats.dropped.load(), errors, cam.stats.ffc_frames.load(), ffc_skipped,
+           cam.stats.commands.load(), cam.stats.command_errors.load(), cmd_ms, seeded ? "ok" : "ignored",
+           pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static bool benchTrace()
+{
+    // 关闭时的跟踪点开销
+    const int n = 1000000;
+    volatile int sink = 0;
+    traceEnable(false);
+    int64_t start = traceNowNs();
+    for (int i = 0; i < n; i++) {
+        TRACE_SCOPE("disabled");
+        sink = sink + 1;
+    }
+    double off_ns = (double)(traceNowNs() - start) / n;
+
+    // 开启时: 两个线程各记录超过环形缓冲容量的嵌套事件
+    traceClear();
+    traceEnable(true);
+    traceSetThreadName("bench");
+    start = traceNowNs();
+    for (int i = 0; i < n / 10; i++) {
+        TRACE_SCOPE("enabled");
+        sink = sink + 1;
+    }
+    double on_ns = (double)(traceNowNs() - start) / (n / 10);
+    traceClear();
+    auto worker = [](const char* name) {
+        traceSetThreadName(name);
+        for (int f = 0; f < 3000; f++) {
+            traceFrame(f);
+            TRACE_SCOPE("frame");
+            {
+                TRACE_SCOPE("stage_a");
+            }
+            {
+                TRACE_SCOPE("stage_b");
+            }
+        }
+    };
+    std::thread a(worker, "worker_a"), b(worker, "worker_b");
+    a.join();
+    b.join();
+    traceEnable(false);
+    const char* path = "/tmp/ir_bench_trace.json";
+    bool pass = traceDump(path);
+
+    // 检查导出: 每个线程保留最近 kTraceRingSize 个事件, 括号配对, 帧内阶段落在帧事件内
+    FILE* file = fopen(path, "r");
+    std::string json;
+    if (file != NULL) {
+        char chunk[4096];
+        size_t len;
+        while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            json.append(chunk, len);
+        }
+        fclose(file);
+    }
+    int events = 0, names = 0, depth = 0, min_depth = 0;
+    for (size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos; pos = json.find("\"ph\":\"X\"", pos + 1)) {
+        events++;
+    }
+    for (size_t pos = json.find("\"worker_"); pos != std::string::npos; pos = json.find("\"worker_", pos + 1)) {
+        names++;
+    }
+    for (size_t i = 0; i < json.size(); i++) {
+        depth += json[i] == '{' || json[i] == '[';
+        depth -= json[i] == '}' || json[i] == ']';
+        min_depth = std::min(min_depth, depth);
+    }
+    size_t last_frame = json.rfind("\"args\":{\"frame\":2999}");
+    pass &= events == 2 * kTraceRingSize && names == 2 && depth == 0 && min_depth == 0 &&
+            last_frame != std::string::npos && json.compare(0, 2, "{\"") == 0;
+    pass &= off_ns < 5 && on_ns < 500;
+    printf("trace: disabled %.2f ns/scope, enabled %.1f ns/scope, %d events from 2 threads, %.0f KB json [%s]\n",
+           off_ns, on_ns, events, json.size() / 1024.0, pass ? "PASS" : "FAIL");
+    traceClear();
+    return pass;
+}
+
+static bool benchHud()
+{
+    // 统计: 百分位与排序结果一致, 由序号间隔推算丢帧
+    PipelineStats stats;
+    cv::RNG rng(7);
+    std::vector<int64_t> recent;
+    for (int i = 0; i < 1000; i++) {
+        int64_t ns = 100000 + rng.uniform(0, 5000000);
+        statsStage(stats, STAGE_ALGORITHM, ns);
+        recent.push_back(ns);
+    }
+    recent.erase(recent.begin(), recent.end() - kStatsWindow);
+    std::sort(recent.begin(), recent.end());
+    bool pass = statsPercentile(stats, STAGE_ALGORITHM, 0.5) == recent[kStatsWindow / 2] &&
+                statsPercentile(stats, STAGE_ALGORITHM, 0.99) == recent[(int)(0.99 * kStatsWindow)] &&
+                statsPercentile(stats, STAGE_UPSCALE, 0.5) == 0;
+    uint32_t sequence = 0xfffffff0u;     // 跨越序号回绕
+    for (int i = 0; i < 200; i++) {
+        sequence += (i % 50 == 49) ? 3 : 1;
+        statsFrame(stats, (int64_t)i * 40000000, sequence);
+    }
+    pass &= stats.drops == 8 && std::abs(statsFps(stats) - 25.0) < 0.01;
+
+    // 10 秒 25 fps, 每帧调用更新: 数值不变时只绘制一次, 变化时按周期重绘
+    HudState hud;
+    cv::Mat display(576, 768, CV_8UC3, cv::Scalar(0, 0, 0));
+    int64_t now = 200LL * 40000000;
+    for (int i = 0; i < 250; i++, now += 40000000) {
+        hudUpdate(hud, stats, now);
+    }
+    uint32_t steady_renders = hud.renders;
+    for (int i = 0; i < 250; i++, now += 40000000) {
+        statsStage(stats, STAGE_DISPLAY, 1000000 + (i / 25) * 500000);  // 每秒变化一次
+        hudUpdate(hud, stats, now);
+    }
+    uint32_t changing_renders = hud.renders - steady_renders;
+    hudDraw(hud, display);
+    int lit = cv::countNonZero(display.reshape(1));
+    pass &= steady_renders == 1 && changing_renders >= 10 && changing_renders <= (uint32_t)(250 * 40 / hud.params.period_ms + 1) &&
+            lit > 0 && cv::countNonZero(display(cv::Rect(0, 0, display.cols - hud.overlay.cols, display.rows)).reshape(1)) == 0;
+
+    // 每帧开销: 周期内的更新 + 拷贝叠加层
+    const int n = 2000;
+    int64_t start = traceNowNs();
+    for (int i = 0; i < n; i++) {
+        hudUpdate(hud, stats, now);
+        hudDraw(hud, display);
+    }
+    double frame_us = (traceNowNs() - start) / 1e3 / n;
+    // 到达刷新周期、数值不变时的采样开销
+    start = traceNowNs();
+    for (int i = 0; i < n; i++) {
+        hud.next_ns = 0;
+        hudUpdate(hud, stats, now);
+    }
+    double sample_us = (traceNowNs() - start) / 1e3 / n;
+    // 一次重绘
+    start = traceNowNs();
+    for (int i = 0; i < n / 10; i++) {
+        hud.next_ns = 0;
+        hud.shown.drops++;
+        hudUpdate(hud, stats, now);
+    }
+    double render_us = (traceNowNs() - start) / 1e3 / (n / 10);
+    // 40 ms 帧预算的 1%
+    pass &= frame_us < 400 && sample_us < 400;
+    printf("hud: %u renders steady, %u renders changing, per-frame %.1f us, sample %.1f us, render %.1f us [%s]\n",
+           steady_renders, changing_renders, frame_us, sample_us, render_us, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static bool benchLatency()
+{
+    // 时间戳换算: 单调时钟时间戳直接使用, 其他时钟退回取帧时间
+    v4l2_buffer buf = {};
+    buf.timestamp.tv_sec = 12;
+    buf.timestamp.tv_usec = 345678;
+    buf.flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+    bool pass = latencyCaptureNs(buf, -1) == 12345678000LL;
+    buf.flags = V4L2_BUF_FLAG_TIMESTAMP_COPY;
+    pass &= latencyCaptureNs(buf, -1) == -1;
+
+    // 100 fps, 处理 12 ms/帧: 驱动队列被填满, 缓冲越多排队越久
+    LatencyTestParams params;
+    params.fps = 100;
+    params.frames = 100;
+    params.load_ms = 12;
+    params.buffers.clear();
+    params.buffers.push_back(2);
+    params.buffers.push_back(4);
+    std::vector<LatencyAlgorithm> algorithms(1);
+    algorithms[0].name = "upscale";
+    algorithms[0].process = [](const cv::Mat& yuyv, cv::Mat& out) {
+        cv::Mat bgr;
+        cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+        upscale2x(bgr, out);
+    };
+    LatencyRecorder rec;
+    std::vector<LatencyTestResult> results;
+    pass &= latencySelfTest(params, algorithms, rec, results);
+    const int64_t period = 10000000;
+    pass &= results.size() == 2 && results[1].stamp_p50_ns > results[0].stamp_p50_ns + period;
+
+    const char* path = "/tmp/ir_bench_latency.csv";
+    remove(path);
+    pass &= rec.series.size() == 2 && rec.series[0].frames == params.frames && latencyReport(rec, path);
+    FILE* file = fopen(path, "r");
+    int lines = 0;
+    if (file != NULL) {
+        char line[512];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            lines++;
+        }
+        fclose(file);
+    }
+    pass &= lines == 3;
+    printf("latency: buffers 2 p50 %.1f ms, buffers 4 p50 %.1f ms [%s]\n",
+           results.size() == 2 ? results[0].stamp_p50_ns * 1e-6 : 0.0,
+           results.size() == 2 ? results[1].stamp_p50_ns * 1e-6 : 0.0, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static bool benchWriteFile(const std::string& path, const std::string& text)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+    fputs(text.c_str(), file);
+    fclose(file);
+    return true;
+}
+
+// 配置文本: edge_threshold 与 clip_kirsch 同步变化, 用于检查读到的参数块是否完整
+static std::string benchConfigText(int n)
+{
+    char text[256];
+    snprintf(text, sizeof(text),
+             "{\"clahe\": {\"clip_kirsch\": %d.5, \"tile_size\": 1}, \"edge_threshold\": %d, "
+             "\"unsharp\": {\"ksize\": 3}, \"display\": {\"screenshot_path\": \"/tmp/shots\"}}", n, n * 10 + 5);
+    return text;
+}
+
+static bool benchConfig()
+{
+    // 空配置取默认值(与原先写死的参数一致), 非法取值与语法错误被拒绝
+    DeviceConfig device;
+    TuningParams tuning;
+    bool pass = appConfigParse("{}", device, tuning) && device.device == "/dev/video0" && device.width == 384 &&
+                device.height == 288 && tuning.clip_default == 2 && tuning.clip_sobel_prewitt == 3.5 &&
+                tuning.clip_kirsch == 1.3 && tuning.clip_frei_chen == 3 && tuning.tile_size == 1 &&
+                tuning.unsharp_sigma == 1.5 && tuning.unsharp_strength == 1.0 && tuning.unsharp_ksize == 5 &&
+                tuning.edge_threshold == 70 && tuning.display_factor == 2;
+    pass &= !appConfigParse("{\"unsharp\": {\"ksize\": 4}}", device, tuning);
+    pass &= !appConfigParse("{\"edge_threshold\": \"70\"}", device, tuning);
+    pass &= !appConfigParse("{\"clahe\": {", device, tuning);
+
+    const std::string dir = "/tmp/ir_bench_config";
+    const std::string path = dir + "/config.json";
+    mkdir(dir.c_str(), 0755);
+    pass &= benchWriteFile(path, benchConfigText(1));
+    AppConfig config;
+    pass &= appConfigLoad(config, path) && appConfigWatch(config);
+    std::shared_ptr<const TuningParams> first = appConfigTuning(config);
+    pass &= first->version == 1 && first->edge_threshold == 15 && first->unsharp_ksize == 3 &&
+            first->screenshot_path == "/tmp/shots";
+
+    // 没有变化时轮询只有一次不阻塞的 read
+    const int n = 10000;
+    int64_t start = traceNowNs();
+    for (int i = 0; i < n; i++) {
+        pass &= !appConfigPoll(config);
+    }
+    double idle_us = (traceNowNs() - start) / 1e3 / n;
+
+    // 直接改写与改名替换都会生效; 错误的文件保留原参数; 已取得的旧参数块不受影响
+    pass &= benchWriteFile(path, benchConfigText(2)) && appConfigPoll(config);
+    pass &= appConfigTuning(config)->edge_threshold == 25 && first->edge_threshold == 15;
+    pass &= benchWriteFile(path, "{\"edge_threshold\": 300}") && !appConfigPoll(config) && config.errors == 1;
+    pass &= appConfigTuning(config)->edge_threshold == 25;
+    pass &= benchWriteFile(dir + "/config.json.tmp", benchConfigText(3)) &&
+            rename((dir + "/config.json.tmp").c_str(), path.c_str()) == 0 && appConfigPoll(config);
+    pass &= appConfigTuning(config)->edge_threshold == 35;
+    // 同目录其他文件的变化不触发重新加载
+    pass &= benchWriteFile(dir + "/other.json", "{}") && !appConfigPoll(config);
+
+    // 另一线程持续读取, 每次读到的都是完整的某一版本
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0), reads(0);
+    std::thread reader([&]() {
+        uint32_t last = 0;
+        while (!stop) {
+            std::shared_ptr<const TuningParams> t = appConfigTuning(config);
+            torn += t->edge_threshold != (int)t->clip_kirsch * 10 + 5 || t->version < last;
+            last = t->version;
+            reads++;
+        }
+    });
+    int reloads = 0;
+    int64_t reload_ns = 0;
+    for (int i = 4; i < 24; i++) {
+        benchWriteFile(path, benchConfigText(i));
+        int64_t t0 = traceNowNs();
+        reloads += appConfigPoll(config);
+        reload_ns += traceNowNs() - t0;
+    }
+    stop = true;
+    reader.join();
+    pass &= reloads == 20 && torn == 0 && appConfigTuning(config)->version == 23 && config.reloads == 22;
+    pass &= idle_us < 20;
+    printf("config: idle poll %.2f us, reload %.1f us, %d reloads under %d concurrent reads, %d torn [%s]\n",
+           idle_us, reload_ns / 1e3 / std::max(reloads, 1), reloads, reads.load(), torn.load(), pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+int runBenchmarks()
+{
+    const cv::Size sizes[] = {cv::Size(384, 288), cv::Size(768, 576)};
+    const int ops[] = {EDGE_SOBEL_PREWITT, EDGE_KIRSCH, EDGE_FREI_CHEN};
+    // 计时随编译选项与线程数变化, 记录测量结果时一并保留这一行
+#if CV_SIMD128
+    const int simd = 1;
+#else
+    const int simd = 0;
+#endif
+    printf("bench: OpenCV %s, CV_SIMD128 %d, %d threads\n", CV_VERSION, simd, cv::getNumThreads());
+    bool pass = true;
+    for (const cv::Size& size : sizes) {
+        pass &= benchSceneGen(size);
+        pass &= benchFreiChen(size);
+        for (int op : ops) {
+            pass &= benchFusedEdge(size, op);
+        }
+        pass &= benchEdgeOverlay(size);
+        pass &= benchPalette(size);
+        pass &= benchUpscale(size);
+        pass &= benchDpc(size);
+        pass &= benchSbnuc(size);
+        pass &= benchTempStats(size);
+        pass &= benchTempMap(size);
+        pass &= benchAlarm(size);
+        pass &= benchHotspot(size);
+    }
+    pass &= benchFfcGuard();
+    pass &= benchCmdExec();
+    pass &= benchDevParam();
+    pass &= benchTelemetry();
+    pass &= benchMockCamera();
+    pass &= benchTrace();
+    pass &= benchHud();
+    pass &= benchLatency();
+    pass &= benchConfig();
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+#include "cmdexec.h"
+#include "libircmd_temp.h"
+#include "trace.h"
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+static int64_t cmdNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void cmdComplete(const CmdRequest& request, const CmdResult& result)
+{
+    for (size_t i = 0; i < request.callbacks.size(); i++) {
+        if (request.callbacks[i]) {
+            request.callbacks[i](result);
+        }
+    }
+}
+
+// 取最高优先级队列的队首, 队列为空且已停止时返回 false
+static bool cmdTake(CmdExecutor& exec, CmdRequest& request)
+{
+    std::unique_lock<std::mutex> lock(exec.mutex);
+    exec.cond.wait(lock, [&exec]() { return exec.pending > 0 || !exec.running; });
+    if (!exec.running) {
+        return false;
+    }
+    for (int p = 0; p < CMD_PRIORITY_NUM; p++) {
+        if (!exec.queues[p].empty()) {
+            request = exec.queues[p].front();
+            exec.queues[p].pop_front();
+            exec.pending--;
+            exec.wait_max_ns[p] = std::max(exec.wait_max_ns[p], cmdNowNs() - request.submit_ns);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void cmdWorker(CmdExecutor* exec)
+{
+    traceSetThreadName("cmdexec");
+    CmdRequest request;
+    while (cmdTake(*exec, request)) {
+        CmdResult result;
+        int64_t start = cmdNowNs();
+        result.error = request.func(exec->handle, result);
+        int64_t busy = cmdNowNs() - start;
+        if (traceEnabled()) {
+            traceRecord("command", start, start + busy);
+        }
+        {
+            std::lock_guard<std::mutex> lock(exec->mutex);
+            exec->executed++;
+            exec->failed += result.error != IRLIB_SUCCESS;
+            exec->busy_ns += busy;
+        }
+        // 回调在锁外调用, 回调中可以继续提交命令
+        cmdComplete(request, result);
+    }
+}
+
+CmdExecutor::~CmdExecutor()
+{
+    cmdExecStop(*this);
+}
+
+void cmdExecStart(CmdExecutor& exec, IrcmdHandle_t* handle)
+{
+    CV_Assert(!exec.running);
+    exec.handle = handle;
+    exec.running = true;
+    exec.start_ns = cmdNowNs();
+    exec.worker = std::thread(cmdWorker, &exec);
+}
+
+void cmdExecStop(CmdExecutor& exec)
+{
+    std::vector<CmdRequest> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(exec.mutex);
+        if (!exec.running) {
+            return;
+        }
+        exec.running = false;
+        for (int p = 0; p < CMD_PRIORITY_NUM; p++) {
+            cancelled.insert(cancelled.end(), exec.queues[p].begin(), exec.queues[p].end());
+            exec.queues[p].clear();
+        }
+        exec.pending = 0;
+    }
+    exec.cond.notify_all();
+    exec.worker.join();
+
+    CmdResult result;
+    result.error = IRCMD_CMD_EXECUTE_FAILED;
+    for (size_t i = 0; i < cancelled.size(); i++) {
+        cmdComplete(cancelled[i], result);
+    }
+}
+
+// 在各优先级队列中查找相同键的等待命令
+static bool cmdFindKey(CmdExecutor& exec, int key, int& priority, size_t& index)
+{
+    for (priority = 0; priority < CMD_PRIORITY_NUM; priority++) {
+        const std::deque<CmdRequest>& queue = exec.queues[priority];
+        for (index = 0; index < queue.size(); index++) {
+            if (queue[index].key == key) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool cmdExecSubmit(CmdExecutor& exec, int priority, int key, bool replace,
+                   const CmdFunc& func, const CmdCallback& callback)
+{
+    CV_Assert(priority >= 0 && priority < CMD_PRIORITY_NUM && func);
+    {
+        std::lock_guard<std::mutex> lock(exec.mutex);
+        if (!exec.running) {
+            exec.rejected++;
+            return false;
+        }
+
+        int old_priority;
+        size_t index;
+        if (key != CMD_KEY_NONE && cmdFindKey(exec, key, old_priority, index)) {
+            exec.submitted++;
+            exec.coalesced++;
+            CmdRequest& request = exec.queues[old_priority][index];
+            if (replace) {
+                request.func = func;
+            }
+            request.callbacks.push_back(callback);
+            // 更高优先级的提交把合并后的命令移到对应队列末尾
+            if (priority < old_priority) {
+                request.priority = priority;
+                exec.queues[priority].push_back(request);
+                exec.queues[old_priority].erase(exec.queues[old_priority].begin() + index);
+            }
+            return true;
+        }
+
+        if (exec.pending >= kCmdQueueSize) {
+            exec.rejected++;
+            return false;
+        }
+        exec.submitted++;
+        CmdRequest request;
+        request.priority = priority;
+        request.key = key;
+        request.replace = replace;
+        request.func = func;
+        request.callbacks.push_back(callback);
+        request.submit_ns = cmdNowNs();
+        exec.queues[priority].push_back(request);
+        exec.pending++;
+    }
+    exec.cond.notify_one();
+    return true;
+}
+
+std::future<CmdResult> cmdExecCall(CmdExecutor& exec, int priority, int key, bool replace, const CmdFunc& func)
+{
+    std::shared_ptr<std::promise<CmdResult> > promise = std::make_shared<std::promise<CmdResult> >();
+    std::future<CmdResult> future = promise->get_future();
+    if (!cmdExecSubmit(exec, priority, key, replace, func,
+                       [promise](const CmdResult& result) { promise->set_value(result); })) {
+        CmdResult result;
+        result.error = IRCMD_CMD_EXECUTE_FAILED;
+        promise->set_value(result);
+    }
+    return future;
+}
+
+double cmdExecOccupancy(CmdExecutor& exec)
+{
+    std::lock_guard<std::mutex> lock(exec.mutex);
+    int64_t elapsed = cmdNowNs() - exec.start_ns;
+    return elapsed > 0 ? (double)exec.busy_ns / elapsed : 0.0;
+}
+
+std::future<CmdResult> cmdExecFfcUpdate(CmdExecutor& exec)
+{
+    return cmdExecCall(exec, CMD_PRIORITY_URGENT, CMD_KEY_FFC, false,
+                       [](IrcmdHandle_t* handle, CmdResult&) { return basic_ffc_update(handle); });
+}
+
+bool cmdExecSetPalette(CmdExecutor& exec, int index, const CmdCallback& callback)
+{
+    return cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_PALETTE, true,
+                         [index](IrcmdHandle_t* handle, CmdResult&) { return basic_palette_idx_set(handle, index); },
+                         callback);
+}
+
+bool cmdExecSetContrast(CmdExecutor& exec, int level, const CmdCallback& callback)
+{
+    return cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_CONTRAST, true,
+                         [level](IrcmdHandle_t* handle, CmdResult&) { return basic_image_contrast_level_set(handle, level); },
+                         callback);
+}
+
+bool cmdExecSetBrightness(CmdExecutor& exec, int level, const CmdCallback& callback)
+{
+    return cmdExecSubmit(exec, CMD_PRIORITY_UI, CMD_KEY_BRIGHTNESS, true,
+                         [level](IrcmdHandle_t* handle, CmdResult&) { return basic_image_brightness_level_set(handle, level); },
+                         callback);
+}
+
+bool cmdExecGetFrameTemp(CmdExecutor& exec, const CmdCallback& callback)
+{
+    return cmdExecSubmit(exec, CMD_PRIORITY_READ, CMD_KEY_FRAME_TEMP, false,
+                         [](IrcmdHandle_t* handle, CmdResult& result) {
+                             return basic_frame_temp_info_get(handle, &result.frame_temp);
+                         },
+                         callback);
+}
@@ -0,0 +1,94 @@
+#include "control.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+
+// 读取 sysfs 中的十六进制 ID
+static bool controlReadHex(const std::string& path, unsigned& value)
+{
+    std::ifstream file(path.c_str());
+    return (bool)(file >> std::hex >> value);
+}
+
+bool controlUsbIds(const std::string& video_dev, unsigned& vid, unsigned& pid)
+{
+    // /dev/v4l/by-id 等符号链接先解析到 /dev/videoN
+    char resolved[PATH_MAX];
+    if (realpath(video_dev.c_str(), resolved) == NULL) {
+        return false;
+    }
+    std::string node(resolved);
+    node = node.substr(node.find_last_of('/') + 1);
+    // device 指向 USB 接口目录, 其上一级是 USB 设备目录
+    std::string usb = "/sys/class/video4linux/" + node + "/device/../";
+    return controlReadHex(usb + "idVendor", vid) && controlReadHex(usb + "idProduct", pid);
+}
+
+bool controlOpen(ControlChannel& channel, const DeviceConfig& dev)
+{
+    unsigned vid = (unsigned)dev.usb_vid, pid = (unsigned)dev.usb_pid;
+    if ((vid == 0 || pid == 0) && !controlUsbIds(dev.device, vid, pid)) {
+        std::cerr << "无法读取 " << dev.device << " 的 USB VID/PID, 请在配置 device.usb_vid/usb_pid 中指定"
+                  << std::endl;
+        return false;
+    }
+    if (ir_control_handle_create(&channel.control) != IRLIB_SUCCESS || channel.control == NULL) {
+        std::cerr << "创建命令通道句柄失败" << std::endl;
+        channel.control = NULL;
+        return false;
+    }
+    channel.uvc = iruvc_usb_handle_create(channel.control);
+    if (channel.uvc == NULL) {
+        std::cerr << "创建 USB 命令句柄失败" << std::endl;
+        controlClose(channel);
+        return false;
+    }
+    IruvcDevParam_t dev_param = {};
+    dev_param.vid = vid;
+    dev_param.pid = pid;
+    dev_param.same_idx = 0;
+    if (iruvc_usb_device_open(channel.uvc, &dev_param) != IRLIB_SUCCESS) {
+        std::cerr << "打开 USB 命令通道失败(VID " << std::hex << vid << " PID " << pid << std::dec << ")"
+                  << std::endl;
+        iruvc_usb_handle_delete(channel.uvc);
+        channel.uvc = NULL;
+        controlClose(channel);
+        return false;
+    }
+    channel.con_param.cmd_method = CONTROL_USB;
+    if (iruvc_usb_device_init(channel.uvc, &channel.con_param) != IRLIB_SUCCESS) {
+        std::cerr << "初始化 USB 命令通道失败" << std::endl;
+        iruvc_usb_device_close(channel.uvc);
+        iruvc_usb_handle_delete(channel.uvc);
+        channel.uvc = NULL;
+        controlClose(channel);
+        return false;
+    }
+    channel.cmd = ircmd_create_handle(channel.control);
+    if (channel.cmd == NULL) {
+        std::cerr << "创建 ircmd 句柄失败" << std::endl;
+        controlClose(channel);
+        return false;
+    }
+    return true;
+}
+
+void controlClose(ControlChannel& channel)
+{
+    if (channel.cmd != NULL) {
+        ircmd_delete_handle(channel.cmd);
+        channel.cmd = NULL;
+    }
+    if (channel.uvc != NULL) {
+        iruvc_usb_device_release(channel.uvc, &channel.con_param);
+        iruvc_usb_device_close(channel.uvc);
+        iruvc_usb_handle_delete(channel.uvc);
+        channel.uvc = NULL;
+    }
+    if (channel.control != NULL) {
+        ir_control_handle_delete(&channel.control);
+        channel.control = NULL;
+    }
+}
@@ -0,0 +1,251 @@
+#include "devparam.h"
+
+#include <opencv2/opencv.hpp>
+
+const DevParamDesc kDevParamTable[DEV_PARAM_NUM] = {
+    {"gain", basic_gain_get, basic_gain_set},
+    {"palette", basic_palette_idx_get, basic_palette_idx_set},
+    {"brightness", basic_current_brightness_level_get, basic_image_brightness_level_set},
+    {"contrast", basic_current_contrast_level_get, basic_image_contrast_level_set},
+    {"detail", basic_current_detail_enhance_level_get, basic_image_detail_enhance_level_set},
+    {"noise_reduction", basic_current_image_noise_reduction_level_get, basic_image_noise_reduction_level_set},
+    {"agc", basic_current_agc_level_get, basic_image_agc_level_set},
+    {"scene_mode", basic_current_image_scene_mode_get, basic_image_scene_mode_set},
+    {"mirror_flip", basic_mirror_and_flip_status_get, basic_mirror_and_flip_status_set},
+    {"auto_ffc", basic_auto_ffc_status_get, basic_auto_ffc_status_set},
+};
+
+DevParamCache::DevParamCache() :
+    exec(NULL),
+    table(kDevParamTable),
+    restore(basic_restore_default_data),
+    hits(0),
+    misses(0),
+    device_reads(0),
+    device_writes(0),
+    write_errors(0),
+    next_token(0)
+{
+    for (int i = 0; i < DEV_PARAM_NUM; i++) {
+        entries[i].value = 0;
+        entries[i].valid = false;
+        entries[i].pending = 0;
+        entries[i].pending_value = 0;
+        entries[i].version = 0;
+    }
+}
+
+const char* devParamName(int id)
+{
+    return id >= 0 && id < DEV_PARAM_NUM ? kDevParamTable[id].name : "";
+}
+
+void devParamAttach(DevParamCache& cache, CmdExecutor* exec)
+{
+    cache.exec = exec;
+}
+
+// 在锁外调用订阅者, 订阅者中可以读写缓存
+static void devParamNotify(DevParamCache& cache, const std::vector<std::pair<int, int> >& changes)
+{
+    if (changes.empty()) {
+        return;
+    }
+    std::vector<DevParamSub> subs;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        subs = cache.subs;
+    }
+    for (size_t i = 0; i < changes.size(); i++) {
+        for (size_t k = 0; k < subs.size(); k++) {
+            if (subs[k].id < 0 || subs[k].id == changes[i].first) {
+                subs[k].listener(changes[i].first, changes[i].second);
+            }
+        }
+    }
+}
+
+// 更新缓存值, 值变化(或原来无效)时记录变化
+static void devParamStore(DevParamCache& cache, int id, int value, std::vector<std::pair<int, int> >& changes)
+{
+    DevParamEntry& entry = cache.entries[id];
+    if (!entry.valid || entry.value != value) {
+        entry.value = value;
+        entry.version++;
+        changes.push_back(std::make_pair(id, value));
+    }
+    entry.valid = true;
+}
+
+// 在执行器线程中连续读取全部参数, 不插入其他命令
+static IrlibError_e devParamSweep(DevParamCache& cache, IrcmdHandle_t* handle, CmdResult& result)
+{
+    int values[DEV_PARAM_NUM];
+    IrlibError_e errors[DEV_PARAM_NUM];
+    int reads = 0;
+    for (int id = 0; id < DEV_PARAM_NUM; id++) {
+        errors[id] = IRCMD_CMD_UNSUPPORTED;
+        if (cache.table[id].get != NULL) {
+            errors[id] = cache.table[id].get(handle, &values[id]);
+            reads++;
+        }
+    }
+
+    std::vector<std::pair<int, int> > changes;
+    IrlibError_e error = IRLIB_SUCCESS;
+    result.value = 0;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.device_reads += reads;
+        for (int id = 0; id < DEV_PARAM_NUM; id++) {
+            if (errors[id] != IRLIB_SUCCESS) {
+                // 部分机型不支持的参数保持无效, 不影响其他参数
+                cache.entries[id].valid = false;
+                if (error == IRLIB_SUCCESS) {
+                    error = errors[id];
+                }
+                continue;
+            }
+            devParamStore(cache, id, values[id], changes);
+            result.value++;
+        }
+    }
+    devParamNotify(cache, changes);
+    // 至少读到一个参数即成功, 全部失败时返回第一个错误
+    return result.value > 0 ? IRLIB_SUCCESS : error;
+}
+
+std::future<CmdResult> devParamLoad(DevParamCache& cache)
+{
+    CV_Assert(cache.exec != NULL);
+    DevParamCache* c = &cache;
+    return cmdExecCall(*cache.exec, CMD_PRIORITY_READ, CMD_KEY_DEV_PARAM_LOAD, false,
+                       [c](IrcmdHandle_t* handle, CmdResult& result) { return devParamSweep(*c, handle, result); });
+}
+
+bool devParamGet(DevParamCache& cache, int id, int& value)
+{
+    CV_Assert(id >= 0 && id < DEV_PARAM_NUM);
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    const DevParamEntry& entry = cache.entries[id];
+    if (!entry.valid) {
+        cache.misses++;
+        return false;
+    }
+    cache.hits++;
+    value = entry.value;
+    return true;
+}
+
+// 写入完成: 合并后的各次写入都会回调, 只有值等于最近一次提交的回调更新缓存
+static void devParamWritten(DevParamCache& cache, int id, int value, const CmdResult& result)
+{
+    std::vector<std::pair<int, int> > changes;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        DevParamEntry& entry = cache.entries[id];
+        entry.pending--;
+        if (result.error != IRLIB_SUCCESS) {
+            cache.write_errors++;
+        }
+        else if (value == entry.pending_value) {
+            devParamStore(cache, id, value, changes);
+        }
+    }
+    devParamNotify(cache, changes);
+}
+
+bool devParamSet(DevParamCache& cache, int id, int value, const CmdCallback& callback)
+{
+    CV_Assert(id >= 0 && id < DEV_PARAM_NUM && cache.exec != NULL);
+    DevParamSetter set = cache.table[id].set;
+    if (set == NULL) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        DevParamEntry& entry = cache.entries[id];
+        if (entry.valid && entry.pending == 0 && entry.value == value) {
+            cache.hits++;
+            set = NULL;
+        }
+        else {
+            entry.pending++;
+            entry.pending_value = value;
+        }
+    }
+    // 与设备值相同, 不发送命令, 直接在调用线程中回调
+    if (set == NULL) {
+        if (callback) {
+            callback(CmdResult());
+        }
+        return true;
+    }
+
+    DevParamCache* c = &cache;
+    bool ok = cmdExecSubmit(*cache.exec, CMD_PRIORITY_UI, CMD_KEY_DEV_PARAM + id, true,
+        [c, set, value](IrcmdHandle_t* handle, CmdResult&) {
+            {
+                std::lock_guard<std::mutex> lock(c->mutex);
+                c->device_writes++;
+            }
+            return set(handle, value);
+        },
+        [c, id, value, callback](const CmdResult& result) {
+            devParamWritten(*c, id, value, result);
+            if (callback) {
+                callback(result);
+            }
+        });
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.entries[id].pending--;
+    }
+    return ok;
+}
+
+void devParamInvalidate(DevParamCache& cache)
+{
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (int id = 0; id < DEV_PARAM_NUM; id++) {
+        cache.entries[id].valid = false;
+    }
+}
+
+std::future<CmdResult> devParamRestoreDefault(DevParamCache& cache, int type)
+{
+    CV_Assert(cache.exec != NULL && cache.restore != NULL);
+    DevParamCache* c = &cache;
+    return cmdExecCall(*cache.exec, CMD_PRIORITY_READ, CMD_KEY_NONE, false,
+        [c, type](IrcmdHandle_t* handle, CmdResult& result) {
+            IrlibError_e error = c->restore(handle, type);
+            if (error != IRLIB_SUCCESS) {
+                return error;
+            }
+            // 恢复后重新读取, 只通知值实际变化的参数
+            return devParamSweep(*c, handle, result);
+        });
+}
+
+int devParamSubscribe(DevParamCache& cache, int id, const DevParamListener& listener)
+{
+    CV_Assert(id >= -1 && id < DEV_PARAM_NUM && listener);
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    DevParamSub sub;
+    sub.token = cache.next_token++;
+    sub.id = id;
+    sub.listener = listener;
+    cache.subs.push_back(sub);
+    return sub.token;
+}
+
+void devParamUnsubscribe(DevParamCache& cache, int token)
+{
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (size_t i = 0; i < cache.subs.size(); i++) {
+        if (cache.subs[i].token == token) {
+            cache.subs.erase(cache.subs.begin() + i);
+            return;
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#include "dpc.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// 8 邻域, 左上起顺时针
+static const int kDpcDy[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+static const int kDpcDx[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+
+static bool dpcDefectLess(const DpcDefect& a, const DpcDefect& b)
+{
+    return a.index < b.index;
+}
+
+// 坏点表排序去重, 并计算每个坏点可用的邻域
+static void dpcFinalize(DpcState& state)
+{
+    std::vector<DpcDefect>& defects = state.defects;
+    std::sort(defects.begin(), defects.end(), dpcDefectLess);
+    std::vector<DpcDefect> unique;
+    unique.reserve(defects.size());
+    for (size_t i = 0; i < defects.size(); i++) {
+        if (unique.empty() || unique.back().index != defects[i].index) {
+            unique.push_back(defects[i]);
+        }
+    }
+    defects.swap(unique);
+
+    for (size_t i = 0; i < defects.size(); i++) {
+        int y = (int)(defects[i].index / state.width), x = (int)(defects[i].index % state.width);
+        uint8_t mask = 0;
+        for (int k = 0; k < 8; k++) {
+            int ny = y + kDpcDy[k], nx = x + kDpcDx[k];
+            if (ny < 0 || ny >= state.height || nx < 0 || nx >= state.width) {
+                continue;
+            }
+            DpcDefect key;
+            key.index = (uint32_t)(ny * state.width + nx);
+            if (!std::binary_search(defects.begin(), defects.end(), key, dpcDefectLess)) {
+                mask |= (uint8_t)(1 << k);
+            }
+        }
+        defects[i].neighbours = mask;
+    }
+}
+
+void dpcStartCalibration(DpcState& state)
+{
+    state.calib_remaining = std::max(state.params.calib_frames, 1);
+    state.hits.release();
+}
+
+bool dpcAccumulate(DpcState& state, const cv::Mat& frame)
+{
+    if (state.calib_remaining <= 0) {
+        return false;
+    }
+    CV_Assert(frame.depth() == CV_8U && (frame.channels() == 1 || frame.channels() == 3));
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, state.gray, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        frame.copyTo(state.gray);
+    }
+    const int rows = frame.rows, width = frame.cols;
+    if (state.hits.empty() || state.hits.size() != frame.size()) {
+        state.hits = cv::Mat::zeros(frame.size(), CV_16UC1);
+    }
+
+    // 与 8 邻域第二大/第二小值比较, 图像边界只统计图内邻域
+    const int thr = state.params.threshold;
+    for (int y = 0; y < rows; y++) {
+        const uchar* g = state.gray.ptr<uchar>(y);
+        ushort* h = state.hits.ptr<ushort>(y);
+        for (int x = 0; x < width; x++) {
+            int max1 = -1, max2 = -1, min1 = 256, min2 = 256, n = 0;
+            for (int k = 0; k < 8; k++) {
+                int ny = y + kDpcDy[k], nx = x + kDpcDx[k];
+                if (ny < 0 || ny >= rows || nx < 0 || nx >= width) {
+                    continue;
+                }
+                int v = state.gray.ptr<uchar>(ny)[nx];
+                n++;
+                if (v > max1) {
+                    max2 = max1;
+                    max1 = v;
+                }
+                else if (v > max2) {
+                    max2 = v;
+                }
+                if (v < min1) {
+                    min2 = min1;
+                    min1 = v;
+                }
+                else if (v < min2) {
+                    min2 = v;
+                }
+            }
+            if (n >= 2 && (g[x] > max2 + thr || g[x] < min2 - thr)) {
+                h[x]++;
+            }
+        }
+    }
+
+    if (--state.calib_remaining > 0) {
+        return false;
+    }
+
+    // 标定完成, 生成坏点表
+    state.width = width;
+    state.height = rows;
+    state.defects.clear();
+    for (int y = 0; y < rows; y++) {
+        const ushort* h = state.hits.ptr<ushort>(y);
+        for (int x = 0; x < width; x++) {
+            if (h[x] >= state.params.min_hits) {
+                DpcDefect d;
+                d.index = (uint32_t)(y * width + x);
+                d.neighbours = 0;
+                d.type = h[x] >= state.params.stuck_hits ? DPC_STUCK : DPC_BLINKING;
+                state.defects.push_back(d);
+            }
+        }
+    }
+    dpcFinalize(state);
+    state.hits.release();
+    return true;
+}
+
+void dpcCorrect(const DpcState& state, cv::Mat& frame)
+{
+    if (state.defects.empty() || frame.cols != state.width || frame.rows != state.height) {
+        return;
+    }
+    CV_Assert(frame.depth() == CV_8U);
+    const int cn = frame.channels();
+    for (size_t i = 0; i < state.defects.size(); i++) {
+        const DpcDefect& d = state.defects[i];
+        int y = (int)(d.index / state.width), x = (int)(d.index % state.width);
+        uchar* p = frame.ptr<uchar>(y) + x * cn;
+        for (int c = 0; c < cn; c++) {
+            uchar vals[8];
+            int n = 0;
+            for (int k = 0; k < 8; k++) {
+                if (d.neighbours & (1 << k)) {
+                    vals[n++] = frame.ptr<uchar>(y + kDpcDy[k])[(x + kDpcDx[k]) * cn + c];
+                }
+            }
+            // 成片坏点没有可用邻域时保持原值
+            if (n > 0) {
+                std::nth_element(vals, vals + n / 2, vals + n);
+                p[c] = vals[n / 2];
+            }
+        }
+    }
+}
+
+bool dpcSave(const DpcState& state, const std::string& path)
+{
+    std::ofstream file(path.c_str());
+    if (!file) {
+        std::cerr << "坏点表保存失败: " << path << std::endl;
+        return false;
+    }
+    file << "DPC " << state.width << " " << state.height << " " << state.defects.size() << "\n";
+    for (size_t i = 0; i < state.defects.size(); i++) {
+        const DpcDefect& d = state.defects[i];
+        file << d.index % state.width << " " << d.index / state.width << " " << (int)d.type << "\n";
+    }
+    return (bool)file;
+}
+
+bool dpcLoad(DpcState& state, const std::string& path)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    std::string tag;
+    int width = 0, height = 0;
+    size_t count = 0;
+    if (!(file >> tag >> width >> height >> count) || tag != "DPC" || width <= 0 || height <= 0) {
+        std::cerr << "坏点表格式错误: " << path << std::endl;
+        return false;
+    }
+    // 坏点数不可能超过像素数, 先检查再按它预分配
+    if (count > (size_t)width * height) {
+        std::cerr << "坏点表格式错误(坏点数 " << count << " 超过像素数): " << path << std::endl;
+        return false;
+    }
+    std::vector<DpcDefect> defects;
+    defects.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        int x, y, type;
+        if (!(file >> x >> y >> type)) {
+            std::cerr << "坏点表格式错误: " << path << std::endl;
+            return false;
+        }
+        if (type != DPC_STUCK && type != DPC_BLINKING) {
+            std::cerr << "坏点表格式错误(未知坏点类型 " << type << "): " << path << std::endl;
+            return false;
+        }
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            continue;
+        }
+        DpcDefect d;
+        d.index = (uint32_t)(y * width + x);
+        d.neighbours = 0;
+        d.type = (uint8_t)type;
+        defects.push_back(d);
+    }
+    state.width = width;
+    state.height = height;
+    state.defects.swap(defects);
+    dpcFinalize(state);
+    return true;
+}
@@ -0,0 +1,65 @@
+#include "ffc.h"
+
+#include <string.h>
+
+// FNV-1a, 按 64 位字处理, 尾部按字节
+static uint64_t ffcHash(const uchar* data, size_t size)
+{
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t h = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * prime;
+    }
+    for (; i < size; i++) {
+        h = (h ^ data[i]) * prime;
+    }
+    return h;
+}
+
+void ffcGuardSetShutter(FfcGuard& guard, int status)
+{
+    guard.shutter.store(status, std::memory_order_relaxed);
+}
+
+int ffcGuardUpdate(FfcGuard& guard, const uchar* raw, size_t size, FrameMeta& meta)
+{
+    guard.finished = false;
+
+    uint64_t hash = ffcHash(raw, size);
+    bool frozen = guard.hash_valid && hash == guard.frame_hash;
+    guard.frame_hash = hash;
+    guard.hash_valid = true;
+
+    bool detected = frozen || guard.shutter.load(std::memory_order_relaxed) == ADV_SHUTTER_CLOSE_STA;
+    const IrinfoFrameSta_t* frame = frameMetaFrame(meta);
+    if (frame != NULL && frame->frame_type == FREEZE_IMAGE) {
+        detected = true;
+    }
+    if (!detected) {
+        guard.hold_frames = 0;
+    }
+    // 持续过久视为误判(如静止的测试图、快门状态停止更新), 恢复正常处理直到检测条件消失
+    else if (guard.hold_frames < guard.params.max_hold_frames) {
+        guard.hold_frames++;
+        guard.phase = FFC_ACTIVE;
+        return guard.phase;
+    }
+
+    if (guard.phase == FFC_ACTIVE) {
+        // 快门打开后的前几帧 NUC 表刚刷新, 仍可能闪烁
+        guard.phase = FFC_SETTLING;
+        guard.settle_remaining = guard.params.settle_frames;
+        guard.ffc_count++;
+    }
+    if (guard.phase == FFC_SETTLING) {
+        if (guard.settle_remaining-- > 0) {
+            return guard.phase;
+        }
+        guard.phase = FFC_IDLE;
+        guard.finished = true;
+    }
+    return guard.phase;
+}
@@ -0,0 +1,60 @@
+#include "framemeta.h"
+
+void frameMetaAttach(FrameMeta& meta, uint8_t* info)
+{
+    meta.info = info;
+    meta.decoded = 0;
+    meta.failed = 0;
+}
+
+// 解析一个分组, 成功或失败都只解析一次
+static bool frameMetaDecode(FrameMeta& meta, unsigned group)
+{
+    if (meta.decoded & group) {
+        return true;
+    }
+    if (meta.info == NULL || (meta.failed & group)) {
+        return false;
+    }
+    IrlibError_e ret;
+    if (group == FRAME_META_STATUS) {
+        ret = irinfoparse_get_irinfo_status_info(meta.info, &meta.status);
+    }
+    else if (group == FRAME_META_TEST) {
+        ret = irinfoparse_get_irinfo_test_info(meta.info, &meta.test);
+    }
+    else {
+        ret = irinfoparse_get_irinfo_function_info(meta.info, &meta.func);
+    }
+    if (ret != IRLIB_SUCCESS) {
+        meta.failed |= group;
+        return false;
+    }
+    meta.decoded |= group;
+    return true;
+}
+
+const IrinfoStatusInfo_t* frameMetaStatus(FrameMeta& meta)
+{
+    return frameMetaDecode(meta, FRAME_META_STATUS) ? &meta.status : NULL;
+}
+
+const IrinfoFrameSta_t* frameMetaFrame(FrameMeta& meta)
+{
+    return frameMetaDecode(meta, FRAME_META_STATUS) ? &meta.status.frame_status : NULL;
+}
+
+const IrinfoShutterSta_t* frameMetaShutter(FrameMeta& meta)
+{
+    return frameMetaDecode(meta, FRAME_META_STATUS) ? &meta.status.shutter_status : NULL;
+}
+
+const IrinfoAGCInfo_t* frameMetaAgc(FrameMeta& meta)
+{
+    return frameMetaDecode(meta, FRAME_META_TEST) ? &meta.test.agc_info : NULL;
+}
+
+const IrinfoTpdInfo_t* frameMetaTpd(FrameMeta& meta)
+{
+    return frameMetaDecode(meta, FRAME_META_FUNC) ? &meta.func.tpd_info : NULL;
+}
@@ -0,0 +1,533 @@
+#include "golden.h"
+#include "algorithm.h"
+#include "scenegen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+static const int kGoldenIterations = 20;
+static const int kGoldenHeatmapCols = 48;   // 终端热图宽度(字符)
+
+struct GoldenInput {
+    std::string name;
+    cv::Mat gray;
+};
+
+/**
+* @brief 回归项与容差; 黄金输出由 reference 生成, 容差留出 SIMD/定点改写允许的取整差异
+*/
+struct GoldenCase {
+    const char* name;
+    double max_diff;
+    double min_psnr;
+    double min_ssim;
+    void (*run)(const cv::Mat& gray, cv::Mat& dst);         ///< 当前实现
+    void (*reference)(const cv::Mat& gray, cv::Mat& dst);   ///< 优化前的参考实现
+};
+
+// ===================== 参考实现 ======================
+// 优化前 sample.cpp 中的浮点实现原样保留于此, 定点核另有逐位定义的参考, 都不随 algorithm.cpp 的改写变化;
+// 黄金输出只由这些函数生成(--update), 改写后的实现不能把自己的输出写成黄金输出。
+static void goldenRefClahe(const cv::Mat& gray, cv::Mat& dst, double clip_limit)
+{
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(1, 1));
+    clahe->apply(gray, dst);
+}
+
+static cv::Mat goldenRefSobelPrewitt(const cv::Mat& img)
+{
+    cv::Mat sobel_x, sobel_y, sobel_magnitude;
+    cv::Sobel(img, sobel_x, CV_64F, 1, 0, 3);
+    cv::Sobel(img, sobel_y, CV_64F, 0, 1, 3);
+    cv::magnitude(sobel_x, sobel_y, sobel_magnitude);
+
+    cv::Mat prewitt_x, prewitt_y, prewitt_magnitude;
+    cv::Mat kernel_prewitt_x = (cv::Mat_<float>(3, 3) << -1, 0, 1,
+                                                         -1, 0, 1,
+                                                         -1, 0, 1);
+    cv::Mat kernel_prewitt_y = (cv::Mat_<float>(3, 3) <<  1,  1,  1,
+                                                          0,  0,  0,
+                                                         -1, -1, -1);
+    cv::filter2D(img, prewitt_x, CV_64F, kernel_prewitt_x);
+    cv::filter2D(img, prewitt_y, CV_64F, kernel_prewitt_y);
+    cv::magnitude(prewitt_x, prewitt_y, prewitt_magnitude);
+
+    cv::Mat combined_magnitude_64F, combined_magnitude_8U;
+    cv::addWeighted(sobel_magnitude, 0.5, prewitt_magnitude, 0.5, 0, combined_magnitude_64F);
+    combined_magnitude_64F.convertTo(combined_magnitude_8U, CV_8U);
+    return combined_magnitude_8U;
+}
+
+static cv::Mat goldenRefKirsch(const cv::Mat& img)
+{
+    static const float kKernels[8][9] = {
+        { 5,  5,  5, -3,  0, -3, -3, -3, -3},   // N
+        { 5,  5, -3,  5,  0, -3, -3, -3, -3},   // NE
+        { 5, -3, -3,  5,  0, -3,  5, -3, -3},   // E
+        {-3, -3, -3,  5,  0, -3,  5,  5, -3},   // SE
+        {-3, -3, -3, -3,  0, -3,  5,  5,  5},   // S
+        {-3, -3, -3, -3,  0,  5, -3,  5,  5},   // SW
+        {-3, -3,  5, -3,  0,  5, -3, -3,  5},   // W
+        {-3,  5,  5, -3,  0,  5, -3, -3, -3},   // NW
+    };
+    cv::Mat max_response = cv::Mat::zeros(img.size(), CV_32F);
+    for (int k = 0; k < 8; k++) {
+        cv::Mat kernel(3, 3, CV_32F, (void*)kKernels[k]);
+        cv::Mat response;
+        cv::filter2D(img, response, CV_32F, kernel);
+        cv::max(max_response, response, max_response);
+    }
+    cv::Mat kirsch_edge;
+    max_response.convertTo(kirsch_edge, CV_8U);
+    return kirsch_edge;
+}
+
+static cv::Mat goldenRefFreiChen(const cv::Mat& img)
+{
+    float sqrt2 = std::sqrt(2.0f);
+    cv::Mat kernel_x = (cv::Mat_<float>(3, 3) <<
+        1,      sqrt2,  1,
+        0,      0,      0,
+       -1,     -sqrt2, -1);
+    cv::Mat kernel_y = (cv::Mat_<float>(3, 3) <<
+         1,     0,    -1,
+         sqrt2, 0, -sqrt2,
+         1,     0,    -1);
+    cv::Mat frei_x, frei_y, magnitude, edge_output;
+    cv::filter2D(img, frei_x, CV_32F, kernel_x);
+    cv::filter2D(img, frei_y, CV_32F, kernel_y);
+    cv::magnitude(frei_x, frei_y, magnitude);
+    magnitude.convertTo(edge_output, CV_8U);
+    return edge_output;
+}
+
+// 定点 Frei-Chen(FREI_CHEN_FAST)的逐像素标量定义: Q4 梯度, 幅值取
+// max(hi + 0.155*lo, 0.845*hi + 0.555*lo), 边界 BORDER_REFLECT_101。
+// 与 algorithm.cpp 的常量和取整逐项相同但独立保留, 标量/SIMD 路径的改写都须与它逐位一致
+static void goldenRefFreiChenFixed(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat p;
+    cv::copyMakeBorder(gray, p, 1, 1, 1, 1, cv::BORDER_REFLECT_101);
+    dst.create(gray.size(), CV_8UC1);
+    for (int y = 0; y < gray.rows; y++) {
+        const uchar* t = p.ptr<uchar>(y);
+        const uchar* m = p.ptr<uchar>(y + 1);
+        const uchar* b = p.ptr<uchar>(y + 2);
+        uchar* out = dst.ptr<uchar>(y);
+        for (int x = 0; x < gray.cols; x++) {
+            int gx = ((t[x] + t[x + 2] - b[x] - b[x + 2]) << 4) + (((t[x + 1] - b[x + 1]) * 64 * 23170) >> 16);
+            int gy = ((t[x] + b[x] - t[x + 2] - b[x + 2]) << 4) + (((m[x] - m[x + 2]) * 64 * 23170) >> 16);
+            int hi = std::max(std::abs(gx), std::abs(gy)), lo = std::min(std::abs(gx), std::abs(gy));
+            int mag = std::max(hi + ((lo * 10158) >> 16), ((hi * 55378) >> 16) + ((lo * 36372) >> 16));
+            out[x] = (uchar)std::min((mag + 8) >> 4, 255);
+        }
+    }
+}
+
+// 原 unsharpMasking 的 8 位 GaussianBlur; 细节量按有符号计算(原实现的 8 位 subtract 把负细节截为 0,
+// user-027 起按有符号细节锐化, 见 unsharpMaskFixed)
+static void goldenRefUnsharp(const cv::Mat& gray, cv::Mat& dst)
+{
+    const double strength = 1.0;
+    cv::Mat blurred;
+    cv::GaussianBlur(gray, blurred, cv::Size(5, 5), 1.5, 1.5, cv::BORDER_REPLICATE);
+    cv::addWeighted(gray, 1.0 + strength, blurred, -strength, 0.0, dst);
+}
+
+// 原实现的限制对比度参数(clip_limit 为 int/float 局部变量)
+static void goldenRefClaheDefault(const cv::Mat& gray, cv::Mat& dst)
+{
+    goldenRefClahe(gray, dst, 2);
+}
+
+static void goldenRefClaheSobelPrewitt(const cv::Mat& gray, cv::Mat& dst)
+{
+    goldenRefClahe(gray, dst, 3.5f);
+}
+
+static void goldenRefClaheKirsch(const cv::Mat& gray, cv::Mat& dst)
+{
+    goldenRefClahe(gray, dst, 1.3f);
+}
+
+static void goldenRefClaheFreiChen(const cv::Mat& gray, cv::Mat& dst)
+{
+    goldenRefClahe(gray, dst, 3);
+}
+
+static void goldenRefSobelPrewittEdge(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = goldenRefSobelPrewitt(gray);
+}
+
+static void goldenRefKirschEdge(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = goldenRefKirsch(gray);
+}
+
+static void goldenRefFreiChenEdge(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = goldenRefFreiChen(gray);
+}
+
+static void goldenRefFusedSobelPrewitt(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat clahe;
+    goldenRefClaheSobelPrewitt(gray, clahe);
+    dst = goldenRefSobelPrewitt(clahe);
+}
+
+static void goldenRefFusedKirsch(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat clahe;
+    goldenRefClaheKirsch(gray, clahe);
+    dst = goldenRefKirsch(clahe);
+}
+
+static void goldenRefFusedFreiChen(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat clahe;
+    goldenRefClaheFreiChen(gray, clahe);
+    dst = goldenRefFreiChen(clahe);
+}
+
+// ===================== 回归项 ======================
+static void goldenClahe(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat src = gray;
+    do_CLAHE(src, dst);
+}
+
+static void goldenClaheSobelPrewitt(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat src = gray;
+    do_CLAHE_sobelprewitt(src, dst);
+}
+
+static void goldenClaheKirsch(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat src = gray;
+    do_CLAHE_edge(src, dst);
+}
+
+static void goldenClaheFreiChen(const cv::Mat& gray, cv::Mat& dst)
+{
+    cv::Mat src = gray;
+    do_CLAHE_edge_Frei_Chen(src, dst);
+}
+
+static void goldenSobelPrewitt(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = SobelPrewitt(gray);
+}
+
+static void goldenKirsch(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = Kirsch(gray);
+}
+
+static void goldenFreiChen(const cv::Mat& gray, cv::Mat& dst)
+{
+    dst = Frei_Chen(gray);
+}
+
+static void goldenFreiChenFixed(const cv::Mat& gray, cv::Mat& dst)
+{
+    freiChenFixed(gray, dst);
+}
+
+// 与 sample 中 unsharpMasking 的默认参数一致
+static void goldenUnsharp(const cv::Mat& gray, cv::Mat& dst)
+{
+    unsharpMaskFixed(gray, dst, 1.5, 1.0, 5);
+}
+
+static void goldenFusedSobelPrewitt(const cv::Mat& gray, cv::Mat& dst)
+{
+    FusedEdgeState state;
+    fusedClaheEdge(state, gray, dst, EDGE_SOBEL_PREWITT, kClaheClipSobelPrewitt);
+}
+
+static void goldenFusedKirsch(const cv::Mat& gray, cv::Mat& dst)
+{
+    FusedEdgeState state;
+    fusedClaheEdge(state, gray, dst, EDGE_KIRSCH, kClaheClipKirsch);
+}
+
+static void goldenFusedFreiChen(const cv::Mat& gray, cv::Mat& dst)
+{
+    FusedEdgeState state;
+    fusedClaheEdge(state, gray, dst, EDGE_FREI_CHEN, kClaheClipFreiChen);
+}
+
+static const GoldenCase kGoldenCases[] = {
+    {"clahe", 1, 50, 0.995, goldenClahe, goldenRefClaheDefault},
+    {"clahe_sobel_prewitt", 1, 50, 0.995, goldenClaheSobelPrewitt, goldenRefClaheSobelPrewitt},
+    {"clahe_kirsch", 1, 50, 0.995, goldenClaheKirsch, goldenRefClaheKirsch},
+    {"clahe_frei_chen", 1, 50, 0.995, goldenClaheFreiChen, goldenRefClaheFreiChen},
+    {"sobel_prewitt", 2, 45, 0.99, goldenSobelPrewitt, goldenRefSobelPrewittEdge},
+    {"kirsch", 2, 45, 0.99, goldenKirsch, goldenRefKirschEdge},
+    {"frei_chen", 2, 45, 0.99, goldenFreiChen, goldenRefFreiChenEdge},
+    {"frei_chen_fixed", 0, 50, 0.995, goldenFreiChenFixed, goldenRefFreiChenFixed},
+    {"unsharp", 1, 50, 0.995, goldenUnsharp, goldenRefUnsharp},
+    {"fused_sobel_prewitt", 4, 40, 0.98, goldenFusedSobelPrewitt, goldenRefFusedSobelPrewitt},
+    {"fused_kirsch", 1, 50, 0.995, goldenFusedKirsch, goldenRefFusedKirsch},
+    {"fused_frei_chen", 4, 40, 0.98, goldenFusedFreiChen, goldenRefFusedFreiChen},
+};
+
+// ===================== 指标 ======================
+static double goldenSsim(const cv::Mat& a, const cv::Mat& b)
+{
+    const double c1 = 6.5025, c2 = 58.5225;     // (0.01*255)^2, (0.03*255)^2
+    const cv::Size win(11, 11);
+    cv::Mat x, y;
+    a.convertTo(x, CV_32F);
+    b.convertTo(y, CV_32F);
+    cv::Mat xx(x.size(), CV_32F), yy(x.size(), CV_32F), xy(x.size(), CV_32F);
+    for (int r = 0; r < x.rows; r++) {
+        const float* px = x.ptr<float>(r);
+        const float* py = y.ptr<float>(r);
+        float* pxx = xx.ptr<float>(r);
+        float* pyy = yy.ptr<float>(r);
+        float* pxy = xy.ptr<float>(r);
+        for (int c = 0; c < x.cols; c++) {
+            pxx[c] = px[c] * px[c];
+            pyy[c] = py[c] * py[c];
+            pxy[c] = px[c] * py[c];
+        }
+    }
+    cv::Mat mx, my, sxx, syy, sxy;
+    cv::GaussianBlur(x, mx, win, 1.5);
+    cv::GaussianBlur(y, my, win, 1.5);
+    cv::GaussianBlur(xx, sxx, win, 1.5);
+    cv::GaussianBlur(yy, syy, win, 1.5);
+    cv::GaussianBlur(xy, sxy, win, 1.5);
+    double sum = 0;
+    for (int r = 0; r < x.rows; r++) {
+        const float* ux = mx.ptr<float>(r);
+        const float* uy = my.ptr<float>(r);
+        const float* vxx = sxx.ptr<float>(r);
+        const float* vyy = syy.ptr<float>(r);
+        const float* vxy = sxy.ptr<float>(r);
+        for (int c = 0; c < x.cols; c++) {
+            double mu_xy = (double)ux[c] * uy[c];
+            double mu_xx = (double)ux[c] * ux[c];
+            double mu_yy = (double)uy[c] * uy[c];
+            double num = (2 * mu_xy + c1) * (2 * (vxy[c] - mu_xy) + c2);
+            double den = (mu_xx + mu_yy + c1) * ((vxx[c] - mu_xx) + (vyy[c] - mu_yy) + c2);
+            sum += num / den;
+        }
+    }
+    return sum / ((double)x.rows * x.cols);
+}
+
+void goldenCompare(const cv::Mat& ref, const cv::Mat& out, GoldenMetrics& metrics)
+{
+    CV_Assert(ref.size() == out.size() && ref.type() == out.type() && ref.type() == CV_8UC1);
+    cv::Mat diff;
+    cv::absdiff(ref, out, diff);
+    cv::minMaxLoc(diff, NULL, &metrics.max_diff);
+    metrics.psnr = cv::PSNR(ref, out);
+    metrics.ssim = goldenSsim(ref, out);
+}
+
+// 按块取最大差异, 打印字符热图
+static void goldenPrintHeatmap(const cv::Mat& diff)
+{
+    static const char kShades[] = " .:-=+*#%@";
+    const int levels = (int)sizeof(kShades) - 2;
+    int cols = std::min(kGoldenHeatmapCols, diff.cols);
+    int cell = (diff.cols + cols - 1) / cols;
+    int cell_h = cell * 2;      // 字符约为 1:2 的高宽比
+    for (int y0 = 0; y0 < diff.rows; y0 += cell_h) {
+        std::string line = "    |";
+        for (int x0 = 0; x0 < diff.cols; x0 += cell) {
+            int m = 0;
+            for (int y = y0; y < std::min(y0 + cell_h, diff.rows); y++) {
+                const uchar* p = diff.ptr<uchar>(y);
+                for (int x = x0; x < std::min(x0 + cell, diff.cols); x++) {
+                    m = std::max(m, (int)p[x]);
+                }
+            }
+            // 差异 1 即可见, 16 以上为最深
+            line += kShades[m == 0 ? 0 : std::min(levels, 1 + (m - 1) * (levels - 1) / 15)];
+        }
+        printf("%s|\n", line.c_str());
+    }
+}
+
+// ===================== 语料 ======================
+// 合成场景只在 --update 且语料中没有同名帧时写入; 回归只读取提交的语料,
+// 不依赖当前 OpenCV 的随机数实现
+static bool goldenWriteScenes(const std::string& corpus)
+{
+    struct SceneSpec {
+        const char* name;
+        cv::Size size;
+        int64_t index;
+        float dead_ratio;
+        uint64_t seed;
+    };
+    static const SceneSpec kScenes[] = {
+        {"scene_a", cv::Size(384, 288), 0, 0.0005f, 20250612},
+        {"scene_b", cv::Size(384, 288), 37, 0.0005f, 20250613},
+        {"scene_dead", cv::Size(384, 288), 5, 0.005f, 20250614},
+        {"scene_2x", cv::Size(768, 576), 12, 0.0005f, 20250615},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(kScenes) / sizeof(kScenes[0]); i++) {
+        std::string path = corpus + "/" + kScenes[i].name + ".png";
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            continue;
+        }
+        SceneGen gen;
+        gen.params.size = kScenes[i].size;
+        gen.params.dead_ratio = kScenes[i].dead_ratio;
+        gen.params.seed = kScenes[i].seed;
+        cv::Mat yuyv, gray;
+        sceneGenRender(gen, kScenes[i].index, SCENE_YUYV, yuyv);
+        cv::cvtColor(yuyv, gray, cv::COLOR_YUV2GRAY_YUYV);
+        if (!cv::imwrite(path, gray)) {
+            std::cerr << "无法写入语料帧: " << path << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static void goldenCorpus(const std::string& corpus, std::vector<GoldenInput>& inputs)
+{
+    // cv::glob 对不存在的目录会抛异常
+    struct stat st;
+    if (stat(corpus.c_str(), &st) != 0) {
+        return;
+    }
+    std::vector<cv::String> files;
+    cv::glob(corpus + "/*.png", files, false);
+    std::sort(files.begin(), files.end());
+    for (size_t i = 0; i < files.size(); i++) {
+        GoldenInput input;
+        input.gray = cv::imread(files[i], cv::IMREAD_GRAYSCALE);
+        if (input.gray.empty()) {
+            std::cerr << "无法读取语料帧: " << files[i] << std::endl;
+            continue;
+        }
+        std::string file = files[i];
+        size_t slash = file.find_last_of("/\\");
+        file = slash == std::string::npos ? file : file.substr(slash + 1);
+        input.name = file.substr(0, file.size() - 4);
+        inputs.push_back(input);
+    }
+}
+
+static std::string goldenPath(const std::string& dir, const char* name, const std::string& input)
+{
+    return dir + "/" + name + "__" + input + ".png";
+}
+
+// 单帧平均耗时(ms), 先运行一次预热
+static double goldenTime(void (*fn)(const cv::Mat&, cv::Mat&), const cv::Mat& gray, cv::Mat& out)
+{
+    fn(gray, out);
+    int64_t start = cv::getTickCount();
+    for (int k = 0; k < kGoldenIterations; k++) {
+        fn(gray, out);
+    }
+    return (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / kGoldenIterations;
+}
+
+int runGolden(const std::string& dir, bool update)
+{
+    const std::string corpus = dir + "/corpus";
+    if (update) {
+        mkdir(dir.c_str(), 0755);
+        mkdir(corpus.c_str(), 0755);
+        if (!goldenWriteScenes(corpus)) {
+            return 1;
+        }
+    }
+    std::vector<GoldenInput> inputs;
+    goldenCorpus(corpus, inputs);
+    if (inputs.empty()) {
+        std::cerr << "语料为空: " << corpus << "(黄金输出与语料随仓库提交在 golden/ 下)" << std::endl;
+        return 1;
+    }
+
+    bool pass = true;
+    for (size_t c = 0; c < sizeof(kGoldenCases) / sizeof(kGoldenCases[0]); c++) {
+        const GoldenCase& gc = kGoldenCases[c];
+        GoldenMetrics worst;
+        worst.max_diff = 0;
+        worst.psnr = 1e9;
+        worst.ssim = 1;
+        double ms_sum = 0, ref_ms_sum = 0, ref_max_diff = 0;
+        int failed = 0, missing = 0;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const GoldenInput& input = inputs[i];
+            cv::Mat out, ref_out;
+            ms_sum += goldenTime(gc.run, input.gray, out);
+            ref_ms_sum += goldenTime(gc.reference, input.gray, ref_out);
+
+            std::string path = goldenPath(dir, gc.name, input.name);
+            if (update) {
+                if (!cv::imwrite(path, ref_out)) {
+                    std::cerr << "无法写入黄金输出: " << path << std::endl;
+                    pass = false;
+                }
+                continue;
+            }
+            cv::Mat ref = cv::imread(path, cv::IMREAD_UNCHANGED);
+            if (ref.empty() || ref.size() != out.size() || ref.type() != out.type()) {
+                std::cerr << "缺少黄金输出或尺寸不符: " << path << std::endl;
+                missing++;
+                continue;
+            }
+            // 参考实现与黄金输出的差异只反映 OpenCV 版本/平台的差别, 单独打印便于区分
+            cv::Mat ref_diff;
+            double m_ref = 0;
+            cv::absdiff(ref, ref_out, ref_diff);
+            cv::minMaxLoc(ref_diff, NULL, &m_ref);
+            ref_max_diff = std::max(ref_max_diff, m_ref);
+
+            GoldenMetrics m;
+            goldenCompare(ref, out, m);
+            worst.max_diff = std::max(worst.max_diff, m.max_diff);
+            worst.psnr = std::min(worst.psnr, m.psnr);
+            worst.ssim = std::min(worst.ssim, m.ssim);
+            if (m.max_diff <= gc.max_diff && m.psnr >= gc.min_psnr && m.ssim >= gc.min_ssim) {
+                continue;
+            }
+            // 超差: 打印热图, 保存彩色差异图(差异放大 16 倍)
+            failed++;
+            printf("  %s on %s: max diff %.0f (tol %.0f), psnr %.2f (min %.0f), ssim %.4f (min %.3f)\n",
+                   gc.name, input.name.c_str(), m.max_diff, gc.max_diff, m.psnr, gc.min_psnr, m.ssim, gc.min_ssim);
+            cv::Mat diff, heat;
+            cv::absdiff(ref, out, diff);
+            goldenPrintHeatmap(diff);
+            mkdir((dir + "/diff").c_str(), 0755);
+            diff.convertTo(heat, CV_8U, 16);
+            cv::applyColorMap(heat, heat, cv::COLORMAP_JET);
+            cv::imwrite(dir + "/diff/" + gc.name + "__" + input.name + ".png", heat);
+        }
+
+        double n = (double)inputs.size();
+        if (update) {
+            printf("golden %s: %d frames written from reference, %.3f ms\n", gc.name, (int)inputs.size(),
+                   ref_ms_sum / n);
+            continue;
+        }
+        bool ok = failed == 0 && missing == 0;
+        pass &= ok;
+        printf("golden %s: %d frames, max diff %.0f, min psnr %.2f, min ssim %.4f, "
+               "%.3f ms vs reference %.3f ms (x%.2f, reference max diff %.0f) [%s]\n",
+               gc.name, (int)inputs.size() - missing, worst.max_diff, worst.psnr, worst.ssim,
+               ms_sum / n, ref_ms_sum / n, ref_ms_sum / std::max(ms_sum, 1e-9), ref_max_diff,
+               ok ? "PASS" : "FAIL");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+#include "hotspot.h"
+
+#include <algorithm>
+#include <limits>
+
+HotspotState::HotspotState() :
+    next_id(0),
+    overflow(false)
+{
+    // 全部缓冲区按上限预分配, 运行期不再分配内存
+    runs.reserve(kHotspotMaxRuns);
+    parent.reserve(kHotspotMaxRuns);
+    acc.reserve(kHotspotMaxRuns);
+    blobs.reserve(kHotspotMaxBlobs);
+    tracks.reserve(kHotspotMaxTracks);
+    events.reserve(kHotspotMaxTracks * 2);
+}
+
+// 跳过整块低于阈值的像素, 返回可能含热点像素的位置
+static int hotspotSkip(const uchar* row, int x, int cols, int thr)
+{
+#if CV_SIMD128
+    const cv::v_uint8x16 v_thr = cv::v_setall_u8((uchar)thr);
+    for (; x <= cols - 16; x += 16) {
+        if (cv::v_check_any(cv::v_load(row + x) > v_thr)) {
+            break;
+        }
+    }
+#endif
+    return x;
+}
+
+static int hotspotSkip(const ushort* row, int x, int cols, int thr)
+{
+#if CV_SIMD128
+    const cv::v_uint16x8 v_thr = cv::v_setall_u16((ushort)thr);
+    for (; x <= cols - 8; x += 8) {
+        if (cv::v_check_any(cv::v_load(row + x) > v_thr)) {
+            break;
+        }
+    }
+#endif
+    return x;
+}
+
+static int hotspotFind(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// 序号小的作为根, 结果与合并顺序无关
+static void hotspotUnion(std::vector<int>& parent, int a, int b)
+{
+    a = hotspotFind(parent, a);
+    b = hotspotFind(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    }
+    else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+// 峰值相同时取行优先的第一个位置
+static bool hotspotPeakBefore(int peak_a, cv::Point a, int peak_b, cv::Point b)
+{
+    if (peak_a != peak_b) {
+        return peak_a > peak_b;
+    }
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+}
+
+static void hotspotMerge(HotspotAcc& dst, const HotspotAcc& src)
+{
+    dst.area += src.area;
+    dst.sum_x += src.sum_x;
+    dst.sum_y += src.sum_y;
+    if (hotspotPeakBefore(src.peak, src.peak_pos, dst.peak, dst.peak_pos)) {
+        dst.peak = src.peak;
+        dst.peak_pos = src.peak_pos;
+    }
+    dst.x0 = std::min(dst.x0, src.x0);
+    dst.y0 = std::min(dst.y0, src.y0);
+    dst.x1 = std::max(dst.x1, src.x1);
+    dst.y1 = std::max(dst.y1, src.y1);
+}
+
+// 逐行提取高于阈值的行程, 与上一行 8 邻域相接的行程合并, 统计量在建立行程时一并计算
+template <typename T>
+static void hotspotLabel(HotspotState& state, const cv::Mat& src, int thr)
+{
+    int prev_begin = 0, prev_end = 0;
+    for (int y = 0; y < src.rows; y++) {
+        const T* row = src.ptr<T>(y);
+        int cur_begin = (int)state.runs.size();
+        int j = prev_begin;
+        int x = 0;
+        while (x < src.cols) {
+            x = hotspotSkip(row, x, src.cols, thr);
+            if (x >= src.cols) {
+                break;
+            }
+            if (row[x] <= thr) {
+                x++;
+                continue;
+            }
+            if ((int)state.runs.size() >= kHotspotMaxRuns) {
+                state.overflow = true;
+                return;
+            }
+            int x0 = x;
+            int peak = row[x], peak_x = x;
+            for (x++; x < src.cols && row[x] > thr; x++) {
+                if (row[x] > peak) {
+                    peak = row[x];
+                    peak_x = x;
+                }
+            }
+            int x1 = x - 1;
+            int n = x1 - x0 + 1;
+
+            int id = (int)state.runs.size();
+            HotspotRun run = {y, x0, x1};
+            state.runs.push_back(run);
+            state.parent.push_back(id);
+            HotspotAcc a;
+            a.area = n;
+            a.peak = peak;
+            a.peak_pos = cv::Point(peak_x, y);
+            a.sum_x = (int64_t)(x0 + x1) * n / 2;
+            a.sum_y = (int64_t)y * n;
+            a.x0 = x0;
+            a.y0 = y;
+            a.x1 = x1;
+            a.y1 = y;
+            state.acc.push_back(a);
+
+            // 上一行的行程按 x 有序: 完全在左侧的以后也不会相接, 直接跳过
+            while (j < prev_end && state.runs[j].x1 < x0 - 1) {
+                j++;
+            }
+            for (int k = j; k < prev_end && state.runs[k].x0 <= x1 + 1; k++) {
+                hotspotUnion(state.parent, id, k);
+            }
+        }
+        prev_begin = cur_begin;
+        prev_end = (int)state.runs.size();
+    }
+}
+
+// 合并各行程的统计量到根, 输出面积达标的连通域(超过上限时保留峰值最高的)
+static void hotspotCollect(HotspotState& state)
+{
+    state.blobs.clear();
+    int num = (int)state.runs.size();
+    for (int i = 0; i < num; i++) {
+        int r = hotspotFind(state.parent, i);
+        if (r != i) {
+            hotspotMerge(state.acc[r], state.acc[i]);
+        }
+    }
+    for (int i = 0; i < num; i++) {
+        const HotspotAcc& a = state.acc[i];
+        if (state.parent[i] != i || a.area < state.params.min_area) {
+            continue;
+        }
+        HotspotBlob blob;
+        blob.area = a.area;
+        blob.peak = a.peak;
+        blob.peak_pos = a.peak_pos;
+        blob.centroid = cv::Point2f((float)((double)a.sum_x / a.area), (float)((double)a.sum_y / a.area));
+        blob.bbox = cv::Rect(a.x0, a.y0, a.x1 - a.x0 + 1, a.y1 - a.y0 + 1);
+        if ((int)state.blobs.size() < kHotspotMaxBlobs) {
+            state.blobs.push_back(blob);
+            continue;
+        }
+        int weakest = 0;
+        for (int k = 1; k < kHotspotMaxBlobs; k++) {
+            if (hotspotPeakBefore(state.blobs[weakest].peak, state.blobs[weakest].peak_pos,
+                                  state.blobs[k].peak, state.blobs[k].peak_pos)) {
+                weakest = k;
+            }
+        }
+        if (hotspotPeakBefore(blob.peak, blob.peak_pos, state.blobs[weakest].peak, state.blobs[weakest].peak_pos)) {
+            state.blobs[weakest] = blob;
+        }
+    }
+    // 按峰值从高到低, 新建跟踪时优先最热的热点
+    for (size_t i = 1; i < state.blobs.size(); i++) {
+        HotspotBlob b = state.blobs[i];
+        size_t k = i;
+        for (; k > 0 && hotspotPeakBefore(b.peak, b.peak_pos, state.blobs[k - 1].peak, state.blobs[k - 1].peak_pos); k--) {
+            state.blobs[k] = state.blobs[k - 1];
+        }
+        state.blobs[k] = b;
+    }
+}
+
+static void hotspotEmit(HotspotState& state, int type, const HotspotTrack& track)
+{
+    HotspotEvent event;
+    event.type = type;
+    event.id = track.id;
+    event.blob = track.blob;
+    state.events.push_back(event);
+}
+
+// 贪心关联: 每次取门限内质心距离最小的一对, 直到没有可关联的
+static void hotspotTrack(HotspotState& state)
+{
+    const HotspotParams& p = state.params;
+    int num_tracks = (int)state.tracks.size();
+    int num_blobs = (int)state.blobs.size();
+    bool track_used[kHotspotMaxTracks] = {false};
+    bool blob_used[kHotspotMaxBlobs] = {false};
+    const float gate2 = p.gate * p.gate;
+
+    while (true) {
+        int best_t = -1, best_b = -1;
+        float best = gate2;
+        for (int t = 0; t < num_tracks; t++) {
+            if (track_used[t]) {
+                continue;
+            }
+            cv::Point2f c = state.tracks[t].blob.centroid;
+            for (int b = 0; b < num_blobs; b++) {
+                if (blob_used[b]) {
+                    continue;
+                }
+                cv::Point2f d = state.blobs[b].centroid - c;
+                float dist2 = d.x * d.x + d.y * d.y;
+                if (dist2 < best || (best_t < 0 && dist2 <= best)) {
+                    best = dist2;
+                    best_t = t;
+                    best_b = b;
+                }
+            }
+        }
+        if (best_t < 0) {
+            break;
+        }
+        track_used[best_t] = true;
+        blob_used[best_b] = true;
+        HotspotTrack& track = state.tracks[best_t];
+        track.blob = state.blobs[best_b];
+        track.age++;
+        track.missed = 0;
+        if (!track.confirmed && track.age >= p.confirm_frames) {
+            track.confirmed = true;
+            hotspotEmit(state, HOTSPOT_APPEAR, track);
+        }
+    }
+
+    // 未关联的跟踪计丢失, 超时删除(保持原有顺序)
+    int kept = 0;
+    for (int t = 0; t < num_tracks; t++) {
+        HotspotTrack& track = state.tracks[t];
+        if (!track_used[t] && ++track.missed > p.max_missed) {
+            if (track.confirmed) {
+                hotspotEmit(state, HOTSPOT_LOST, track);
+            }
+            continue;
+        }
+        state.tracks[kept++] = track;
+    }
+    state.tracks.resize(kept);
+
+    // 未关联的热点建立新跟踪
+    for (int b = 0; b < num_blobs && (int)state.tracks.size() < kHotspotMaxTracks; b++) {
+        if (blob_used[b]) {
+            continue;
+        }
+        HotspotTrack track;
+        track.id = state.next_id++;
+        track.blob = state.blobs[b];
+        track.age = 1;
+        track.missed = 0;
+        track.confirmed = track.age >= p.confirm_frames;
+        state.tracks.push_back(track);
+        if (track.confirmed) {
+            hotspotEmit(state, HOTSPOT_APPEAR, track);
+        }
+    }
+}
+
+void hotspotUpdate(HotspotState& state, const cv::Mat& src)
+{
+    CV_Assert(src.type() == CV_8UC1 || src.type() == CV_16UC1);
+    CV_Assert(state.params.threshold >= 0 && state.params.min_area > 0 && state.params.max_missed >= 0);
+    state.runs.clear();
+    state.parent.clear();
+    state.acc.clear();
+    state.events.clear();
+    state.overflow = false;
+
+    int max_value = src.depth() == CV_8U ? std::numeric_limits<uchar>::max() : std::numeric_limits<ushort>::max();
+    // 阈值不小于输入最大值时没有热点像素
+    int thr = state.params.threshold;
+    if (thr < max_value) {
+        if (src.depth() == CV_8U) {
+            hotspotLabel<uchar>(state, src, thr);
+        }
+        else {
+            hotspotLabel<ushort>(state, src, thr);
+        }
+    }
+    hotspotCollect(state);
+    hotspotTrack(state);
+}
+
+void hotspotDraw(const HotspotState& state, cv::Mat& display, double scale)
+{
+    const cv::Scalar color(0, 0, 255);
+    for (size_t i = 0; i < state.tracks.size(); i++) {
+        const HotspotTrack& track = state.tracks[i];
+        // 只画已确认且本帧仍检测到的热点
+        if (!track.confirmed || track.missed > 0) {
+            continue;
+        }
+        const cv::Rect& r = track.blob.bbox;
+        cv::Point tl(cvRound(r.x * scale), cvRound(r.y * scale));
+        cv::Point br(cvRound((r.x + r.width) * scale) - 1, cvRound((r.y + r.height) * scale) - 1);
+        cv::rectangle(display, tl, br, color, 1);
+
+        cv::Point c(cvRound((track.blob.peak_pos.x + 0.5) * scale), cvRound((track.blob.peak_pos.y + 0.5) * scale));
+        cv::line(display, cv::Point(c.x - 4, c.y), cv::Point(c.x + 4, c.y), color, 1);
+        cv::line(display, cv::Point(c.x, c.y - 4), cv::Point(c.x, c.y + 4), color, 1);
+
+        cv::putText(display, "#" + std::to_string(track.id), cv::Point(tl.x, std::max(tl.y - 3, 10)),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.4, color, 1);
+    }
+}
@@ -0,0 +1,115 @@
+#include "hud.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const int kHudLine = 14;     // 行高(显示像素)
+static const int kHudMargin = 4;
+
+HudState::HudState() :
+    next_ns(0),
+    renders(0)
+{
+    // 整体清零, 按字节比较时不受填充影响
+    memset(&shown, 0, sizeof(shown));
+}
+
+// ns -> 0.1 ms, 四舍五入
+static int hudTenthMs(int64_t ns)
+{
+    return (int)((ns + 50000) / 100000);
+}
+
+static void hudSample(const HudParams& params, const PipelineStats& stats, HudValues& v)
+{
+    memset(&v, 0, sizeof(v));
+    v.fps10 = cvRound(statsFps(stats) * 10);
+    v.drops = stats.drops;
+    for (int s = 0; s < STAGE_NUM; s++) {
+        v.p50[s] = hudTenthMs(statsPercentile(stats, s, 0.5));
+        v.p99[s] = hudTenthMs(statsPercentile(stats, s, 0.99));
+    }
+
+    int64_t history[kHudSparkline];
+    v.spark_num = statsFrameHistory(stats, history, kHudSparkline);
+    int64_t max_ns = 0;
+    for (int i = 0; i < v.spark_num; i++) {
+        max_ns = std::max(max_ns, history[i]);
+    }
+    // 满量程按 10 ms 取整, 帧间隔小幅抖动时不改变量程
+    v.spark_scale = std::max(10, (int)((max_ns + 9999999) / 10000000) * 10);
+    int64_t full_ns = (int64_t)v.spark_scale * 1000000;
+    for (int i = 0; i < v.spark_num; i++) {
+        v.spark[i] = (uint8_t)std::min<int64_t>(params.spark_height, history[i] * params.spark_height / full_ns);
+    }
+}
+
+static void hudRender(HudState& hud)
+{
+    const HudParams& params = hud.params;
+    const HudValues& v = hud.shown;
+    int rows = kHudMargin * 2 + kHudLine * (STAGE_NUM + 2) + params.spark_height;
+    hud.overlay.create(rows, params.width, CV_8UC3);
+    hud.overlay.setTo(cv::Scalar(32, 32, 32));
+
+    const cv::Scalar text_color(220, 220, 220);
+    char line[64];
+    int y = kHudMargin + kHudLine - 3;
+    snprintf(line, sizeof(line), "fps %d.%d  drop %u", v.fps10 / 10, v.fps10 % 10, v.drops);
+    cv::putText(hud.overlay, line, cv::Point(kHudMargin, y), cv::FONT_HERSHEY_SIMPLEX, 0.4, text_color, 1);
+    y += kHudLine;
+    cv::putText(hud.overlay, "ms        p50    p99", cv::Point(kHudMargin, y), cv::FONT_HERSHEY_SIMPLEX, 0.4,
+                cv::Scalar(150, 150, 150), 1);
+    for (int s = 0; s < STAGE_NUM; s++) {
+        y += kHudLine;
+        snprintf(line, sizeof(line), "%-11s %3d.%d  %3d.%d", kStageNames[s],
+                 v.p50[s] / 10, v.p50[s] % 10, v.p99[s] / 10, v.p99[s] % 10);
+        cv::putText(hud.overlay, line, cv::Point(kHudMargin, y), cv::FONT_HERSHEY_SIMPLEX, 0.4, text_color, 1);
+    }
+
+    // 帧间隔曲线, 最新的在右侧
+    int base = rows - kHudMargin - 1;
+    int x0 = params.width - kHudMargin - v.spark_num * 2;
+    for (int i = 0; i < v.spark_num; i++) {
+        int x = x0 + i * 2;
+        cv::line(hud.overlay, cv::Point(x, base), cv::Point(x, base - v.spark[i]), cv::Scalar(0, 200, 0), 1);
+    }
+    snprintf(line, sizeof(line), "%d", v.spark_scale);
+    cv::putText(hud.overlay, line, cv::Point(kHudMargin, base - params.spark_height + 10), cv::FONT_HERSHEY_SIMPLEX,
+                0.35, cv::Scalar(150, 150, 150), 1);
+    hud.renders++;
+}
+
+bool hudUpdate(HudState& hud, const PipelineStats& stats, int64_t now_ns)
+{
+    if (now_ns < hud.next_ns) {
+        return false;
+    }
+    hud.next_ns = now_ns + (int64_t)hud.params.period_ms * 1000000;
+
+    HudValues v;
+    hudSample(hud.params, stats, v);
+    if (!hud.overlay.empty() && memcmp(&v, &hud.shown, sizeof(v)) == 0) {
+        return false;
+    }
+    hud.shown = v;
+    hudRender(hud);
+    return true;
+}
+
+void hudDraw(const HudState& hud, cv::Mat& display)
+{
+    if (hud.overlay.empty() || display.depth() != CV_8U ||
+        display.cols < hud.overlay.cols || display.rows < hud.overlay.rows) {
+        return;
+    }
+    cv::Rect roi(display.cols - hud.overlay.cols, 0, hud.overlay.cols, hud.overlay.rows);
+    cv::Mat dst = display(roi);
+    if (display.channels() == 3) {
+        hud.overlay.copyTo(dst);
+    }
+    else if (display.channels() == 1) {
+        cv::cvtColor(hud.overlay, dst, cv::COLOR_BGR2GRAY);
+    }
+}
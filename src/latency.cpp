@@ -0,0 +1,341 @@
+#include "latency.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "mockcam.h"
+#include "scenegen.h"
+
+int64_t latencyCaptureNs(const v4l2_buffer& buf, int64_t fallback_ns)
+{
+    // uvcvideo 的时间戳为 CLOCK_MONOTONIC, 与 steady_clock 同源
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC ||
+        (buf.timestamp.tv_sec == 0 && buf.timestamp.tv_usec == 0)) {
+        return fallback_ns;
+    }
+    return (int64_t)buf.timestamp.tv_sec * 1000000000 + (int64_t)buf.timestamp.tv_usec * 1000;
+}
+
+static LatencySeries& latencySeries(LatencyRecorder& rec, const std::string& algorithm, int buffers)
+{
+    for (size_t i = 0; i < rec.series.size(); i++) {
+        if (rec.series[i].algorithm == algorithm && rec.series[i].buffers == buffers) {
+            return rec.series[i];
+        }
+    }
+    LatencySeries series;
+    series.algorithm = algorithm;
+    series.buffers = buffers;
+    series.total_ns.reserve(4096);
+    for (int s = 0; s < STAGE_NUM; s++) {
+        series.mark_sum_ns[s] = 0;
+        series.mark_frames[s] = 0;
+    }
+    series.total_sum_ns = 0;
+    series.frames = 0;
+    rec.series.push_back(series);
+    return rec.series.back();
+}
+
+void latencyRecord(LatencyRecorder& rec, const PipelineStats& stats, const std::string& algorithm, int buffers,
+                   int64_t capture_ns, int64_t present_ns)
+{
+    LatencySeries& series = latencySeries(rec, algorithm, buffers);
+    // 取帧阶段结束即本帧开始处理, 早于它结束的阶段属于之前的帧
+    int64_t dq_ns = stats.stage_end_ns[STAGE_CAPTURE];
+    for (int s = 0; s < STAGE_NUM; s++) {
+        int64_t end_ns = stats.stage_end_ns[s];
+        if (end_ns >= dq_ns && end_ns <= present_ns) {
+            series.mark_sum_ns[s] += end_ns - capture_ns;
+            series.mark_frames[s]++;
+        }
+    }
+    if ((int)series.total_ns.size() < kLatencyMaxSamples) {
+        series.total_ns.push_back(present_ns - capture_ns);
+    }
+    series.total_sum_ns += present_ns - capture_ns;
+    series.frames++;
+}
+
+int64_t latencyPercentile(const LatencySeries& series, double p)
+{
+    int num = (int)series.total_ns.size();
+    if (num == 0) {
+        return 0;
+    }
+    std::vector<int64_t> samples(series.total_ns);
+    int k = std::min(num - 1, std::max(0, (int)(p * num)));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+bool latencyReport(const LatencyRecorder& rec, const std::string& path)
+{
+    const double kMs = 1e-6;
+    for (size_t i = 0; i < rec.series.size(); i++) {
+        const LatencySeries& series = rec.series[i];
+        printf("延迟 %-14s 缓冲 %d, %d 帧: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f ms\n",
+               series.algorithm.c_str(), series.buffers, series.frames,
+               latencyPercentile(series, 0.5) * kMs, latencyPercentile(series, 0.9) * kMs,
+               latencyPercentile(series, 0.99) * kMs, latencyPercentile(series, 1.0) * kMs);
+        // 各阶段结束时距采集的平均时间, 相邻两项之差即该阶段(含等待)的贡献
+        printf("    ");
+        for (int s = 0; s < STAGE_NUM; s++) {
+            if (series.mark_frames[s] > 0) {
+                printf("%s +%.1f  ", kStageNames[s], series.mark_sum_ns[s] * kMs / series.mark_frames[s]);
+            }
+        }
+        printf("present +%.1f ms\n", series.frames > 0 ? series.total_sum_ns * kMs / series.frames : 0.0);
+    }
+    if (path.empty()) {
+        return true;
+    }
+
+    struct stat st;
+    bool header = stat(path.c_str(), &st) != 0 || st.st_size == 0;
+    FILE* file = fopen(path.c_str(), "a");
+    if (file == NULL) {
+        std::cerr << "无法写入延迟报告: " << path << std::endl;
+        return false;
+    }
+    if (header) {
+        fprintf(file, "algorithm,buffers,frames,p50_ms,p90_ms,p99_ms,max_ms");
+        for (int s = 0; s < STAGE_NUM; s++) {
+            fprintf(file, ",%s_ms", kStageNames[s]);
+        }
+        fprintf(file, ",present_ms\n");
+    }
+    for (size_t i = 0; i < rec.series.size(); i++) {
+        const LatencySeries& series = rec.series[i];
+        fprintf(file, "%s,%d,%d,%.3f,%.3f,%.3f,%.3f", series.algorithm.c_str(), series.buffers, series.frames,
+                latencyPercentile(series, 0.5) * kMs, latencyPercentile(series, 0.9) * kMs,
+                latencyPercentile(series, 0.99) * kMs, latencyPercentile(series, 1.0) * kMs);
+        for (int s = 0; s < STAGE_NUM; s++) {
+            if (series.mark_frames[s] > 0) {
+                fprintf(file, ",%.3f", series.mark_sum_ns[s] * kMs / series.mark_frames[s]);
+            }
+            else {
+                fprintf(file, ",");
+            }
+        }
+        fprintf(file, ",%.3f\n", series.frames > 0 ? series.total_sum_ns * kMs / series.frames : 0.0);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+// ===================== 闪烁自测 ======================
+static const int kBlinkSize = 32;       // 图案边长(源图像像素)
+static const int kBlinkMargin = 8;      // 距右下角的距离
+static const int kBlinkStripe = 4;      // 条纹宽度
+static const double kBlinkMinContrast = 30;
+static const int64_t kBlinkToleranceNs = 1000000;   // 图案延迟与时间戳延迟对照的容差
+
+static cv::Rect latencyBlinkRect(cv::Size size)
+{
+    return cv::Rect(size.width - kBlinkMargin - kBlinkSize, size.height - kBlinkMargin - kBlinkSize,
+                    kBlinkSize, kBlinkSize);
+}
+
+// 每个周期的最后 blink_frames 帧显示图案, 开始的若干帧没有图案, 便于建立背景对比度
+static bool latencyBlinkOn(const LatencyTestParams& params, int64_t index)
+{
+    return index % params.blink_period >= params.blink_period - params.blink_frames;
+}
+
+// 偶数周期画竖条纹, 奇数周期画横条纹: 输出端可区分相邻周期, 延迟超过一个周期时图案出现时刻也不会错配
+static void latencyBlinkPaint(uint8_t* yuyv, int width, const cv::Rect& r, bool odd)
+{
+    for (int y = r.y; y < r.y + r.height; y++) {
+        uint8_t* row = yuyv + (size_t)y * width * 2;
+        for (int x = r.x; x < r.x + r.width; x++) {
+            int k = odd ? y - r.y : x - r.x;
+            row[x * 2] = (k / kBlinkStripe) & 1 ? 235 : 16;
+            row[x * 2 + 1] = 128;
+        }
+    }
+}
+
+// 输出端检测: 图案区域中部(按输出尺寸缩放)的灰度标准差; odd 返回条纹方向(横向梯度弱于纵向即横条纹)
+static double latencyBlinkContrast(const cv::Mat& out, cv::Size src_size, bool& odd)
+{
+    odd = false;
+    cv::Rect r = latencyBlinkRect(src_size);
+    double sx = (double)out.cols / src_size.width;
+    double sy = (double)out.rows / src_size.height;
+    cv::Rect roi(cvRound((r.x + r.width / 4) * sx), cvRound((r.y + r.height / 4) * sy),
+                 cvRound(r.width / 2 * sx), cvRound(r.height / 2 * sy));
+    roi &= cv::Rect(0, 0, out.cols, out.rows);
+    if (roi.area() == 0 || out.depth() != CV_8U || (out.channels() != 1 && out.channels() != 3)) {
+        return 0;
+    }
+    cv::Mat gray = out(roi);
+    if (out.channels() == 3) {
+        cv::Mat bgr = gray;
+        cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+    }
+    double sum = 0, sum_sq = 0, grad_x = 0, grad_y = 0;
+    for (int y = 0; y < gray.rows; y++) {
+        const uchar* row = gray.ptr<uchar>(y);
+        const uchar* next = gray.ptr<uchar>(std::min(y + 1, gray.rows - 1));
+        for (int x = 0; x < gray.cols; x++) {
+            sum += row[x];
+            sum_sq += (double)row[x] * row[x];
+            grad_x += std::abs(row[std::min(x + 1, gray.cols - 1)] - row[x]);
+            grad_y += std::abs(next[x] - row[x]);
+        }
+    }
+    odd = grad_y > grad_x;
+    double n = (double)roi.area();
+    double mean = sum / n;
+    return std::sqrt(std::max(sum_sq / n - mean * mean, 0.0));
+}
+
+static int64_t latencyMedian(std::vector<int64_t> v)
+{
+    if (v.empty()) {
+        return 0;
+    }
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+
+// 一种算法、一种缓冲数的自测
+static LatencyTestResult latencyRunOne(const LatencyTestParams& params, const LatencyAlgorithm& algorithm,
+                                       int buffers, LatencyRecorder& rec)
+{
+    SceneGen scene;
+    scene.params.objects.clear();
+    scene.params.shutter_interval = 0;
+    sceneGenReset(scene);
+    const cv::Size size = scene.params.size;
+    const cv::Rect blink = latencyBlinkRect(size);
+
+    MockCamera cam;
+    cam.params.width = size.width;
+    cam.params.height = size.height;
+    cam.params.fps = params.fps;
+    cam.params.buffers = buffers;
+    cam.source = [&](int64_t index, uint8_t* data, int len) {
+        sceneGenYuyv(scene, index, data, len);
+        if (latencyBlinkOn(params, index)) {
+            latencyBlinkPaint(data, size.width, blink, (index / params.blink_period) & 1);
+        }
+    };
+    IrVideoHandle_t video;
+    mockCamAttachVideo(cam, video);
+    void* dev = video.ir_video_handle;
+    video.ir_video_open(dev, NULL);
+    video.ir_video_start_stream(dev, NULL);
+
+    // 场景时钟: 第 index 帧在 start + index * period 时出现在传感器上
+    const int64_t start = cam.stream_start_ns;
+    const int64_t period = (int64_t)(1e9 / std::max(params.fps, 0.1));
+    const int64_t cycle = params.blink_period * period;
+    const int64_t first_onset = (params.blink_period - params.blink_frames) * period;
+
+    const int frame_size = mockCamFrameSize(cam);
+    std::vector<uint8_t> raw(frame_size);
+    cv::Mat yuyv(size, CV_8UC2, &raw[0]);
+    cv::Mat out;
+    PipelineStats stats;
+    std::vector<int64_t> blink_ns, stamp_ns;
+    int disagree = 0, cycles = 0;
+    int64_t last_cycle = -1;
+    double off_level = -1;
+    bool was_on = false;
+    for (int n = 0; n < params.frames; n++) {
+        int rc;
+        {
+            StageScope stage(stats, STAGE_CAPTURE);
+            rc = video.ir_video_frame_get(dev, NULL, &raw[0], frame_size);
+        }
+        if (rc != IRLIB_SUCCESS) {
+            continue;
+        }
+        int64_t capture = mockCamCaptureNs(cam);
+        // 取到了带图案的帧的周期才要求输出端检测到(处理过慢时整段图案帧可能都被驱动丢弃)
+        int64_t index = (capture - start + period / 2) / period;
+        if (latencyBlinkOn(params, index) && index / params.blink_period != last_cycle) {
+            last_cycle = index / params.blink_period;
+            cycles++;
+        }
+        {
+            StageScope stage(stats, STAGE_ALGORITHM);
+            algorithm.process(yuyv, out);
+            if (params.load_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(params.load_ms));
+            }
+        }
+        double contrast;
+        bool odd;
+        {
+            StageScope stage(stats, STAGE_DISPLAY);
+            contrast = latencyBlinkContrast(out, size, odd);
+        }
+        int64_t present = traceNowNs();
+        latencyRecord(rec, stats, algorithm.name, buffers, capture, present);
+
+        // 对比度明显高于背景水平时认为看到图案, 背景水平只在无图案的帧上更新
+        bool on = off_level >= 0 && contrast > std::max(kBlinkMinContrast, off_level * 3);
+        if (!on) {
+            off_level = off_level < 0 ? contrast : off_level * 0.9 + contrast * 0.1;
+        }
+        if (on && !was_on) {
+            // 图案出现的时刻只由场景时钟与条纹方向决定, 与被测的时间戳无关: 取呈现前最近一个同奇偶的周期
+            int64_t k = std::max(present - start - first_onset, (int64_t)0) / cycle;
+            if ((k & 1) != (int64_t)odd) {
+                k--;
+            }
+            int64_t onset = start + first_onset + k * cycle;
+            blink_ns.push_back(present - onset);
+            stamp_ns.push_back(present - capture);
+            // 检测到的是图案的某一帧: 两种延迟之差即该帧采集时刻与图案出现时刻之差, 应在图案持续时间内
+            int64_t lead = capture - onset;
+            if (lead < -kBlinkToleranceNs || lead > (params.blink_frames - 1) * period + kBlinkToleranceNs) {
+                disagree++;
+            }
+        }
+        was_on = on;
+    }
+    video.ir_video_stop_stream(dev, NULL);
+    video.ir_video_close(dev);
+
+    LatencyTestResult result;
+    result.algorithm = algorithm.name;
+    result.buffers = buffers;
+    result.cycles = cycles;
+    result.detected = (int)blink_ns.size();
+    result.disagree = disagree;
+    result.blink_p50_ns = latencyMedian(blink_ns);
+    result.stamp_p50_ns = latencyMedian(stamp_ns);
+    return result;
+}
+
+bool latencySelfTest(const LatencyTestParams& params, const std::vector<LatencyAlgorithm>& algorithms,
+                     LatencyRecorder& rec, std::vector<LatencyTestResult>& results)
+{
+    CV_Assert(params.blink_frames > 0 && params.blink_frames < params.blink_period);
+    bool pass = true;
+    for (size_t a = 0; a < algorithms.size(); a++) {
+        for (size_t b = 0; b < params.buffers.size(); b++) {
+            LatencyTestResult result = latencyRunOne(params, algorithms[a], params.buffers[b], rec);
+            // 允许首个周期因背景水平尚未建立而漏检; 每次检测的图案延迟都须与时间戳延迟一致
+            bool ok = result.cycles > 0 && result.detected >= result.cycles - 1 &&
+                      result.detected <= result.cycles && result.disagree == 0;
+            printf("闪烁自测 %-14s 缓冲 %d: 检测到 %d/%d 次, 图案延迟 p50 %.1f ms, 时间戳延迟 p50 %.1f ms, "
+                   "%d 次不一致 [%s]\n",
+                   result.algorithm.c_str(), result.buffers, result.detected, result.cycles,
+                   result.blink_p50_ns * 1e-6, result.stamp_p50_ns * 1e-6, result.disagree, ok ? "PASS" : "FAIL");
+            results.push_back(result);
+            pass &= ok;
+        }
+    }
+    return pass;
+}
@@ -0,0 +1,345 @@
+#include "mockcam.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include <thread>
+
+static int64_t mockNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void mockSleepUntil(int64_t t_ns)
+{
+    int64_t now = mockNowNs();
+    if (t_ns > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(t_ns - now));
+    }
+}
+
+MockCamera::MockCamera() :
+    streaming(false),
+    stream_start_ns(0),
+    next_index(0),
+    capture_ns(0),
+    ffc_remaining(0),
+    rng(params.seed),
+    control_rng(params.seed + 1),
+    ffc_request(0)
+{
+    for (int c = 0; c < MOCK_CHANNEL_NUM; c++) {
+        stall_ms[c] = 0;
+        errors[c] = 0;
+    }
+}
+
+int mockCamFrameSize(const MockCamera& cam)
+{
+    return cam.params.width * (cam.params.height + cam.params.info_lines) * 2;
+}
+
+// 取出注入的卡顿时间
+static void mockStall(MockCamera& cam, int channel)
+{
+    int ms = cam.stall_ms[channel].exchange(0);
+    if (ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+// 注入的错误优先, 其次按概率随机失败
+static bool mockFail(MockCamera& cam, int channel, cv::RNG& rng, float rate)
+{
+    int n = cam.errors[channel].load();
+    while (n > 0) {
+        if (cam.errors[channel].compare_exchange_weak(n, n - 1)) {
+            return true;
+        }
+    }
+    return rate > 0 && rng.uniform(0.f, 1.f) < rate;
+}
+
+// ===================== 视频通道 ======================
+// 默认帧源: 合成场景, 尺寸与 info 行数跟随相机参数
+static void mockScene(MockCamera& cam, int64_t index, uint8_t* data, int len)
+{
+    SceneParams& sp = cam.scene.params;
+    if (!cam.scene.built || sp.size != cv::Size(cam.params.width, cam.params.height) ||
+        sp.info_lines != cam.params.info_lines) {
+        sp.size = cv::Size(cam.params.width, cam.params.height);
+        sp.info_lines = cam.params.info_lines;
+        sceneGenReset(cam.scene);
+    }
+    sceneGenYuyv(cam.scene, index, data, len);
+}
+
+static void mockRender(MockCamera& cam, int64_t index, uint8_t* data, int len)
+{
+    if (cam.source) {
+        cam.source(index, data, len);
+    }
+    else if (!cam.recording.empty()) {
+        const std::vector<uint8_t>& frame = cam.recording[index % cam.recording.size()];
+        memcpy(data, &frame[0], std::min((int)frame.size(), len));
+    }
+    else {
+        mockScene(cam, index, data, len);
+    }
+}
+
+// 已到采集时间的帧在有空闲缓冲时入队, 否则丢弃(与 uvcvideo 一致), 返回队列中最旧的帧
+static int64_t mockQueueNext(MockCamera& cam, int64_t period)
+{
+    // 调用方处理当前帧时占用一个缓冲
+    size_t capacity = (size_t)std::max(1, cam.params.buffers - 1);
+    int64_t latest = (mockNowNs() - cam.stream_start_ns) / period;
+    for (; cam.next_index <= latest; cam.next_index++) {
+        if (cam.ready.size() < capacity) {
+            cam.ready.push_back(cam.next_index);
+        }
+        else {
+            cam.stats.dropped++;
+        }
+    }
+    if (cam.ready.empty()) {
+        mockSleepUntil(cam.stream_start_ns + cam.next_index * period);
+        cam.ready.push_back(cam.next_index++);
+    }
+    int64_t index = cam.ready.front();
+    cam.ready.pop_front();
+    return index;
+}
+
+static int mockVideoOpen(void*, void*)
+{
+    return IRLIB_SUCCESS;
+}
+
+static int mockVideoStartStream(void* device, void*)
+{
+    MockCamera& cam = *(MockCamera*)device;
+    std::lock_guard<std::mutex> lock(cam.video_mutex);
+    cam.streaming = true;
+    cam.stream_start_ns = mockNowNs();
+    cam.next_index = 0;
+    cam.ready.clear();
+    cam.ffc_remaining = 0;
+    cam.frozen.clear();
+    // 按当前 params.seed 重新播种, 每次取流的随机错误序列可复现
+    cam.rng = cv::RNG(cam.params.seed);
+    return IRLIB_SUCCESS;
+}
+
+static int mockVideoStopStream(void* device, void*)
+{
+    MockCamera& cam = *(MockCamera*)device;
+    std::lock_guard<std::mutex> lock(cam.video_mutex);
+    cam.streaming = false;
+    return IRLIB_SUCCESS;
+}
+
+static int mockVideoClose(void*)
+{
+    return IRLIB_SUCCESS;
+}
+
+static int mockVideoFrameGet(void* device, void*, uint8_t* frame_data, int len)
+{
+    MockCamera& cam = *(MockCamera*)device;
+    std::lock_guard<std::mutex> lock(cam.video_mutex);
+    if (!cam.streaming || frame_data == NULL || len < mockCamFrameSize(cam)) {
+        return IRUVC_PARAM_ERROR;
+    }
+    mockStall(cam, MOCK_VIDEO);
+
+    // 按帧节拍等待下一帧; 已落后时直接取最新一帧, 中间的帧计为丢帧
+    int64_t period = (int64_t)(1e9 / std::max(cam.params.fps, 0.1));
+    int64_t index;
+    if (cam.params.buffers > 0) {
+        index = mockQueueNext(cam, period);
+    }
+    else {
+        int64_t latest = (mockNowNs() - cam.stream_start_ns) / period;
+        index = cam.next_index;
+        if (latest > index) {
+            cam.stats.dropped += (uint32_t)(latest - index);
+            index = latest;
+        }
+        mockSleepUntil(cam.stream_start_ns + index * period);
+        cam.next_index = index + 1;
+    }
+    cam.capture_ns = cam.stream_start_ns + index * period;
+
+    if (mockFail(cam, MOCK_VIDEO, cam.rng, cam.params.frame_error_rate)) {
+        cam.stats.frame_errors++;
+        return IRUVC_IO_ERROR;
+    }
+
+    // FFC 期间快门闭合, 重复返回闭合前的最后一帧
+    int interval = cam.params.ffc_interval_frames;
+    if (cam.ffc_request.exchange(0) != 0 || (interval > 0 && index > 0 && index % interval == 0)) {
+        cam.ffc_remaining = std::max(cam.ffc_remaining, cam.params.ffc_frames);
+    }
+    int size = mockCamFrameSize(cam);
+    if (cam.ffc_remaining > 0 && (int)cam.frozen.size() == size) {
+        cam.ffc_remaining--;
+        memcpy(frame_data, &cam.frozen[0], size);
+        cam.stats.ffc_frames++;
+    }
+    else {
+        mockRender(cam, index, frame_data, size);
+        cam.frozen.assign(frame_data, frame_data + size);
+    }
+    cam.stats.frames++;
+    return IRLIB_SUCCESS;
+}
+
+// ===================== 控制通道 ======================
+// 总线串行: 持锁模拟事务耗时, 并发的命令依次等待
+static int mockControlTransfer(MockCamera& cam, bool write, void* cmd_param, uint8_t* data, uint32_t len)
+{
+    std::lock_guard<std::mutex> lock(cam.control_mutex);
+    int64_t start = mockNowNs();
+    mockStall(cam, MOCK_CONTROL);
+    mockSleepUntil(start + (int64_t)cam.params.cmd_latency_us * 1000 + (int64_t)len * cam.params.cmd_ns_per_byte);
+
+    int ret = IRLIB_SUCCESS;
+    if (mockFail(cam, MOCK_CONTROL, cam.control_rng, cam.params.cmd_error_rate)) {
+        ret = IRUVC_CONTROL_TRANSFER_FAILED;
+    }
+    else if (cam.control) {
+        ret = cam.control(write, cmd_param, data, len);
+    }
+    else if (!write && data != NULL) {
+        memset(data, 0, len);
+    }
+    cam.stats.commands++;
+    cam.stats.command_bytes += len;
+    if (ret != IRLIB_SUCCESS) {
+        cam.stats.command_errors++;
+    }
+    cam.stats.command_busy_ns += mockNowNs() - start;
+    return ret;
+}
+
+static int mockControlOpen(void*, void*)
+{
+    return IRLIB_SUCCESS;
+}
+
+static int mockControlRead(void* device, void* cmd_param, uint8_t* data, uint32_t len)
+{
+    return mockControlTransfer(*(MockCamera*)device, false, cmd_param, data, len);
+}
+
+static int mockControlWrite(void* device, void* cmd_param, uint8_t* data, uint32_t len)
+{
+    return mockControlTransfer(*(MockCamera*)device, true, cmd_param, data, len);
+}
+
+static int mockControlClose(void*)
+{
+    return IRLIB_SUCCESS;
+}
+
+static int mockControlDownload(void*, char*, uint8_t*, uint32_t, void* (*)(void*, void*), void*)
+{
+    return IRUVC_OPERATION_UNSUPPORTED;
+}
+
+static int mockControlDetect(void*, void*, int* status)
+{
+    if (status != NULL) {
+        *status = 0;
+    }
+    return IRLIB_SUCCESS;
+}
+
+static int mockControlChannelType(void*, int* type)
+{
+    if (type != NULL) {
+        *type = UVC_USB_COMMAND_CHANNEL;
+    }
+    return IRLIB_SUCCESS;
+}
+
+void mockCamAttachVideo(MockCamera& cam, IrVideoHandle_t& handle)
+{
+    handle.ir_video_handle = &cam;
+    handle.ir_video_open = mockVideoOpen;
+    handle.ir_video_init = mockVideoOpen;
+    handle.ir_video_start_stream = mockVideoStartStream;
+    handle.ir_video_frame_get = mockVideoFrameGet;
+    handle.ir_video_stop_stream = mockVideoStopStream;
+    handle.ir_video_release = mockVideoOpen;
+    handle.ir_video_close = mockVideoClose;
+}
+
+void mockCamAttachControl(MockCamera& cam, IrControlHandle_t& handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(cam.control_mutex);
+        cam.control_rng = cv::RNG(cam.params.seed + 1);
+    }
+    handle.ir_control_handle = &cam;
+    handle.ir_control_open = mockControlOpen;
+    handle.ir_control_init = mockControlOpen;
+    handle.ir_control_read = mockControlRead;
+    handle.ir_control_write = mockControlWrite;
+    handle.ir_control_write_without_read_return_status = mockControlWrite;
+    handle.ir_control_release = mockControlOpen;
+    handle.ir_control_close = mockControlClose;
+    handle.ir_control_firmware_download = mockControlDownload;
+    handle.ir_control_detect_device_status = mockControlDetect;
+    handle.ir_control_command_channel_type_get = mockControlChannelType;
+    handle.ir_control_bootloader_download = mockControlDownload;
+}
+
+int64_t mockCamCaptureNs(MockCamera& cam)
+{
+    std::lock_guard<std::mutex> lock(cam.video_mutex);
+    return cam.capture_ns;
+}
+
+bool mockCamLoadRecording(MockCamera& cam, const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        std::cerr << "无法打开录制文件: " << path << std::endl;
+        return false;
+    }
+    int size = mockCamFrameSize(cam);
+    std::vector<std::vector<uint8_t> > frames;
+    std::vector<uint8_t> frame(size);
+    while (file.read((char*)&frame[0], size)) {
+        frames.push_back(frame);
+    }
+    if (frames.empty()) {
+        std::cerr << "录制文件中没有完整的帧: " << path << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(cam.video_mutex);
+    cam.recording.swap(frames);
+    return true;
+}
+
+void mockCamInjectStall(MockCamera& cam, int channel, int ms)
+{
+    CV_Assert(channel >= 0 && channel < MOCK_CHANNEL_NUM);
+    cam.stall_ms[channel] = ms;
+}
+
+void mockCamInjectErrors(MockCamera& cam, int channel, int count)
+{
+    CV_Assert(channel >= 0 && channel < MOCK_CHANNEL_NUM);
+    cam.errors[channel] += count;
+}
+
+void mockCamTriggerFfc(MockCamera& cam)
+{
+    cam.ffc_request = 1;
+}
@@ -0,0 +1,379 @@
+#include "palette.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string.h>
+
+// 内置伪彩控制点: 色表序号与 RGB, 控制点之间线性插值
+struct PaletteKnot {
+    int pos;
+    uchar r, g, b;
+};
+
+static const PaletteKnot kIronbowKnots[] = {
+    {0, 0, 0, 0}, {40, 32, 0, 140}, {90, 150, 0, 155}, {140, 225, 60, 40},
+    {190, 250, 140, 0}, {230, 255, 215, 40}, {255, 255, 255, 255},
+};
+
+static const PaletteKnot kRainbowKnots[] = {
+    {0, 0, 0, 130}, {45, 0, 0, 255}, {100, 0, 255, 255}, {140, 0, 255, 0},
+    {185, 255, 255, 0}, {225, 255, 0, 0}, {255, 255, 255, 255},
+};
+
+static void paletteFromKnots(const PaletteKnot* knots, int n, uchar* bgr)
+{
+    for (int k = 0; k + 1 < n; k++) {
+        const PaletteKnot& a = knots[k];
+        const PaletteKnot& b = knots[k + 1];
+        int span = b.pos - a.pos;
+        for (int i = a.pos; i <= b.pos; i++) {
+            int t = i - a.pos;
+            bgr[i * 3 + 0] = (uchar)((a.b * (span - t) + b.b * t + span / 2) / span);
+            bgr[i * 3 + 1] = (uchar)((a.g * (span - t) + b.g * t + span / 2) / span);
+            bgr[i * 3 + 2] = (uchar)((a.r * (span - t) + b.r * t + span / 2) / span);
+        }
+    }
+}
+
+// 注册(或按名字覆盖)伪彩, 返回序号
+static int paletteRegister(PaletteEngine& engine, const char* name, const uchar* bgr)
+{
+    int index = paletteFind(engine, name);
+    if (index < 0) {
+        if (engine.num >= kPaletteMaxNum) {
+            return -1;
+        }
+        index = engine.num++;
+        strncpy(engine.names[index], name, kPaletteNameLen - 1);
+        engine.names[index][kPaletteNameLen - 1] = '\0';
+    }
+    memcpy(engine.colors[index], bgr, 256 * 3);
+    if (index == engine.active) {
+        paletteSelect(engine, index);
+    }
+    return index;
+}
+
+static inline uint32_t packBgra(int b, int g, int r)
+{
+    return (uint32_t)b | ((uint32_t)g << 8) | ((uint32_t)r << 16) | 0xFF000000u;
+}
+
+// BT.601 全范围, 与 libirparse 的 y14_to_nv12 一致(灰度时 Y 等于 8 位灰度, U=V=128)
+static inline uint32_t packYuv(int b, int g, int r)
+{
+    int y = (77 * r + 150 * g + 29 * b + 128) >> 8;
+    int u = ((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128;
+    int v = ((128 * r - 107 * g - 21 * b + 128) >> 8) + 128;
+    return (uint32_t)cv::saturate_cast<uchar>(y) | ((uint32_t)cv::saturate_cast<uchar>(u) << 8) |
+           ((uint32_t)cv::saturate_cast<uchar>(v) << 16);
+}
+
+static void paletteBuildY14(PaletteEngine& engine)
+{
+    const uchar* c = engine.colors[engine.active];
+    int low = engine.y14_low, high = engine.y14_high;
+    for (int i = 0; i < kPaletteY14Size; i++) {
+        int b, g, r;
+        if (i <= low || i >= high) {
+            int k = i <= low ? 0 : 255;
+            b = c[k * 3];
+            g = c[k * 3 + 1];
+            r = c[k * 3 + 2];
+        }
+        else {
+            // Q8 色表位置, 相邻两项线性插值
+            int pos = (i - low) * (255 * 256) / (high - low);
+            int k = pos >> 8, f = pos & 255;
+            const uchar* c0 = c + k * 3;
+            const uchar* c1 = c + std::min(k + 1, 255) * 3;
+            b = (c0[0] * (256 - f) + c1[0] * f + 128) >> 8;
+            g = (c0[1] * (256 - f) + c1[1] * f + 128) >> 8;
+            r = (c0[2] * (256 - f) + c1[2] * f + 128) >> 8;
+        }
+        engine.lut14_bgra[i] = packBgra(b, g, r);
+        engine.lut14_yuv[i] = packYuv(b, g, r);
+    }
+}
+
+PaletteEngine::PaletteEngine() :
+    num(0),
+    active(0),
+    y14_low(0),
+    y14_high(kPaletteY14Size - 1),
+    device_num(0),
+    lut8_bgra(256),
+    lut8_yuv(256),
+    lut14_bgra(kPaletteY14Size),
+    lut14_yuv(kPaletteY14Size)
+{
+    std::fill(device_map, device_map + kPaletteMaxNum, -1);
+
+    uchar bgr[256 * 3];
+    for (int i = 0; i < 256; i++) {
+        bgr[i * 3] = bgr[i * 3 + 1] = bgr[i * 3 + 2] = (uchar)i;
+    }
+    paletteRegister(*this, "whitehot", bgr);
+    for (int i = 0; i < 256; i++) {
+        bgr[i * 3] = bgr[i * 3 + 1] = bgr[i * 3 + 2] = (uchar)(255 - i);
+    }
+    paletteRegister(*this, "blackhot", bgr);
+    paletteFromKnots(kIronbowKnots, sizeof(kIronbowKnots) / sizeof(kIronbowKnots[0]), bgr);
+    paletteRegister(*this, "ironbow", bgr);
+    paletteFromKnots(kRainbowKnots, sizeof(kRainbowKnots) / sizeof(kRainbowKnots[0]), bgr);
+    paletteRegister(*this, "rainbow", bgr);
+    paletteSelect(*this, PALETTE_WHITE_HOT);
+}
+
+int paletteFind(const PaletteEngine& engine, const char* name)
+{
+    for (int i = 0; i < engine.num; i++) {
+        if (strncmp(engine.names[i], name, kPaletteNameLen - 1) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int paletteLoad(PaletteEngine& engine, const std::string& path, const char* name)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        return -1;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uchar bgr[256 * 3];
+    if (data.size() == 768 || data.size() == 772) {
+        // RGB 二进制色表(ACT 末尾 4 字节为颜色数和透明色, 忽略)
+        for (int i = 0; i < 256; i++) {
+            bgr[i * 3 + 0] = (uchar)data[i * 3 + 2];
+            bgr[i * 3 + 1] = (uchar)data[i * 3 + 1];
+            bgr[i * 3 + 2] = (uchar)data[i * 3 + 0];
+        }
+    }
+    else {
+        std::istringstream text(data);
+        for (int i = 0; i < 256; i++) {
+            int r, g, b;
+            if (!(text >> r >> g >> b)) {
+                std::cerr << "伪彩文件格式错误: " << path << std::endl;
+                return -1;
+            }
+            bgr[i * 3 + 0] = cv::saturate_cast<uchar>(b);
+            bgr[i * 3 + 1] = cv::saturate_cast<uchar>(g);
+            bgr[i * 3 + 2] = cv::saturate_cast<uchar>(r);
+        }
+    }
+    return paletteRegister(engine, name, bgr);
+}
+
+bool paletteSelect(PaletteEngine& engine, int index)
+{
+    if (index < 0 || index >= engine.num) {
+        return false;
+    }
+    engine.active = index;
+    const uchar* c = engine.colors[index];
+    for (int i = 0; i < 256; i++) {
+        engine.lut8_bgra[i] = packBgra(c[i * 3], c[i * 3 + 1], c[i * 3 + 2]);
+        engine.lut8_yuv[i] = packYuv(c[i * 3], c[i * 3 + 1], c[i * 3 + 2]);
+    }
+    paletteBuildY14(engine);
+    return true;
+}
+
+void paletteSetY14Range(PaletteEngine& engine, int low, int high)
+{
+    low = std::min(std::max(low, 0), kPaletteY14Size - 2);
+    high = std::min(std::max(high, low + 1), kPaletteY14Size - 1);
+    if (low == engine.y14_low && high == engine.y14_high) {
+        return;
+    }
+    engine.y14_low = low;
+    engine.y14_high = high;
+    paletteBuildY14(engine);
+}
+
+int paletteSyncDevice(PaletteEngine& engine, IrcmdHandle_t* handle, const std::string& dir)
+{
+    int count = 0;
+    if (basic_palette_num_get(handle, &count) != IRLIB_SUCCESS) {
+        return -1;
+    }
+    count = std::min(count, kPaletteMaxNum);
+    engine.device_num = 0;
+    std::fill(engine.device_map, engine.device_map + kPaletteMaxNum, -1);
+    for (int i = 0; i < count; i++) {
+        char name[kPaletteNameLen] = {0};
+        if (basic_palette_name_get(handle, i, name) != IRLIB_SUCCESS) {
+            return -1;
+        }
+        int index = paletteFind(engine, name);
+        if (index < 0 && !dir.empty()) {
+            index = paletteLoad(engine, dir + "/" + name + ".pal", name);
+        }
+        if (index < 0) {
+            std::cerr << "设备伪彩 " << i << "(" << name << ") 无对应色表" << std::endl;
+        }
+        engine.device_map[i] = index;
+    }
+    engine.device_num = count;
+    return count;
+}
+
+bool paletteSelectDevice(PaletteEngine& engine, int device_index)
+{
+    if (device_index < 0 || device_index >= engine.device_num) {
+        return false;
+    }
+    return paletteSelect(engine, engine.device_map[device_index]);
+}
+
+// 16 个像素的查表结果(每项 32 位打包)拆成 4 个字节平面
+#if CV_SIMD128
+template<typename T>
+static inline void paletteGather16(const T* src, const uint32_t* lut, int mask, uint32_t* buf);
+
+template<>
+inline void paletteGather16<uchar>(const uchar* src, const uint32_t* lut, int, uint32_t* buf)
+{
+    for (int k = 0; k < 4; k++) {
+        cv::v_int32x4 idx = cv::v_reinterpret_as_s32(cv::v_load_expand_q(src + k * 4));
+        cv::v_store(buf + k * 4, cv::v_lut((const unsigned*)lut, idx));
+    }
+}
+
+template<>
+inline void paletteGather16<ushort>(const ushort* src, const uint32_t* lut, int mask, uint32_t* buf)
+{
+    const cv::v_uint16x8 v_mask = cv::v_setall_u16((ushort)mask);
+    for (int k = 0; k < 2; k++) {
+        cv::v_uint32x4 i0, i1;
+        cv::v_expand(cv::v_min(cv::v_load(src + k * 8), v_mask), i0, i1);
+        cv::v_store(buf + k * 8, cv::v_lut((const unsigned*)lut, cv::v_reinterpret_as_s32(i0)));
+        cv::v_store(buf + k * 8 + 4, cv::v_lut((const unsigned*)lut, cv::v_reinterpret_as_s32(i1)));
+    }
+}
+#endif
+
+template<typename T>
+static void paletteRowBgr(const T* src, const uint32_t* lut, int mask, uchar* dst, int width, int cn)
+{
+    int x = 0;
+#if CV_SIMD128
+    uint32_t buf[16];
+    for (; x <= width - 16; x += 16) {
+        paletteGather16(src + x, lut, mask, buf);
+        if (cn == 4) {
+            memcpy(dst + x * 4, buf, sizeof(buf));
+        }
+        else {
+            cv::v_uint8x16 b, g, r, a;
+            cv::v_load_deinterleave((const uchar*)buf, b, g, r, a);
+            cv::v_store_interleave(dst + x * 3, b, g, r);
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        uint32_t c = lut[std::min((int)src[x], mask)];
+        uchar* p = dst + x * cn;
+        p[0] = (uchar)c;
+        p[1] = (uchar)(c >> 8);
+        p[2] = (uchar)(c >> 16);
+        if (cn == 4) {
+            p[3] = 0xFF;
+        }
+    }
+}
+
+// 两行生成两行 Y 与一行交织 UV, UV 取 2x2 块平均
+template<typename T>
+static void paletteRowsNv12(const T* src0, const T* src1, const uint32_t* lut, int mask,
+                            uchar* y0, uchar* y1, uchar* uv, int width)
+{
+    int x = 0;
+#if CV_SIMD128
+    uint32_t buf[16];
+    const cv::v_uint32x4 v_lo16 = cv::v_setall_u32(0xFFFF);
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint8x16 yy0, u0, v0, a, yy1, u1, v1;
+        paletteGather16(src0 + x, lut, mask, buf);
+        cv::v_load_deinterleave((const uchar*)buf, yy0, u0, v0, a);
+        paletteGather16(src1 + x, lut, mask, buf);
+        cv::v_load_deinterleave((const uchar*)buf, yy1, u1, v1, a);
+        cv::v_store(y0 + x, yy0);
+        cv::v_store(y1 + x, yy1);
+
+        cv::v_uint16x8 c[2];
+        const cv::v_uint8x16* top[2] = {&u0, &v0};
+        const cv::v_uint8x16* bottom[2] = {&u1, &v1};
+        for (int k = 0; k < 2; k++) {
+            cv::v_uint16x8 t0, t1, b0, b1;
+            cv::v_expand(*top[k], t0, t1);
+            cv::v_expand(*bottom[k], b0, b1);
+            // 竖直两行求和后, 相邻两列在 32 位内相加
+            cv::v_uint32x4 s0 = cv::v_reinterpret_as_u32(t0 + b0);
+            cv::v_uint32x4 s1 = cv::v_reinterpret_as_u32(t1 + b1);
+            s0 = (s0 & v_lo16) + (s0 >> 16);
+            s1 = (s1 & v_lo16) + (s1 >> 16);
+            c[k] = cv::v_rshr_pack<2>(s0, s1);
+        }
+        cv::v_store((ushort*)(uv + x), c[0] | (c[1] << 8));
+    }
+#endif
+    for (; x < width; x += 2) {
+        uint32_t c00 = lut[std::min((int)src0[x], mask)], c01 = lut[std::min((int)src0[x + 1], mask)];
+        uint32_t c10 = lut[std::min((int)src1[x], mask)], c11 = lut[std::min((int)src1[x + 1], mask)];
+        y0[x] = (uchar)c00;
+        y0[x + 1] = (uchar)c01;
+        y1[x] = (uchar)c10;
+        y1[x + 1] = (uchar)c11;
+        for (int k = 1; k <= 2; k++) {
+            int s = ((c00 >> (k * 8)) & 0xFF) + ((c01 >> (k * 8)) & 0xFF) +
+                    ((c10 >> (k * 8)) & 0xFF) + ((c11 >> (k * 8)) & 0xFF);
+            uv[x + k - 1] = (uchar)((s + 2) >> 2);
+        }
+    }
+}
+
+template<typename T>
+static void applyPaletteImpl(const cv::Mat& src, cv::Mat& dst, const uint32_t* bgra,
+                             const uint32_t* yuv, int mask, int format)
+{
+    int width = src.cols, height = src.rows;
+    if (format == PALETTE_FMT_NV12) {
+        CV_Assert(width % 2 == 0 && height % 2 == 0);
+        dst.create(height * 3 / 2, width, CV_8UC1);
+        for (int y = 0; y < height; y += 2) {
+            paletteRowsNv12(src.ptr<T>(y), src.ptr<T>(y + 1), yuv, mask,
+                            dst.ptr<uchar>(y), dst.ptr<uchar>(y + 1),
+                            dst.ptr<uchar>(height + y / 2), width);
+        }
+    }
+    else {
+        int cn = format == PALETTE_FMT_BGRA ? 4 : 3;
+        dst.create(src.size(), CV_MAKETYPE(CV_8U, cn));
+        for (int y = 0; y < height; y++) {
+            paletteRowBgr(src.ptr<T>(y), bgra, mask, dst.ptr<uchar>(y), width, cn);
+        }
+    }
+}
+
+void applyPalette(const PaletteEngine& engine, const cv::Mat& src, cv::Mat& dst, int format)
+{
+    CV_Assert(src.type() == CV_8UC1 || src.type() == CV_16UC1);
+    CV_Assert(format == PALETTE_FMT_BGR || format == PALETTE_FMT_BGRA || format == PALETTE_FMT_NV12);
+    // dst 可能就是 src, 先持有输入头, dst 重新分配时输入仍然有效
+    cv::Mat in = src;
+    if (in.depth() == CV_8U) {
+        applyPaletteImpl<uchar>(in, dst, &engine.lut8_bgra[0], &engine.lut8_yuv[0], 255, format);
+    }
+    else {
+        applyPaletteImpl<ushort>(in, dst, &engine.lut14_bgra[0], &engine.lut14_yuv[0],
+                                 kPaletteY14Size - 1, format);
+    }
+}
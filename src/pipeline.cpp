@@ -0,0 +1,6 @@
+#include "pipeline.h"
+
+void resetPipelineState(PipelineArena& arena)
+{
+    resetTemporalDenoise(arena.tnr);
+}
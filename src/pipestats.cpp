@@ -0,0 +1,98 @@
+#include "pipestats.h"
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+// 与原跟踪点名称一致, 在 Perfetto 中按阶段名查找
+const char* const kStageNames[STAGE_NUM] = {
+    "dqbuf",
+    "yuyv_to_mat",
+    "preprocess",
+    "upscale",
+    "algorithm",
+    "show_ui",
+};
+
+PipelineStats::PipelineStats()
+{
+    statsReset(*this);
+}
+
+void statsReset(PipelineStats& stats)
+{
+    for (int s = 0; s < STAGE_NUM; s++) {
+        stats.stage_count[s] = 0;
+        stats.stage_end_ns[s] = 0;
+    }
+    stats.frame_count = 0;
+    stats.last_frame_ns = 0;
+    stats.last_sequence = 0;
+    stats.frames = 0;
+    stats.drops = 0;
+}
+
+void statsStage(PipelineStats& stats, int stage, int64_t ns)
+{
+    CV_Assert(stage >= 0 && stage < STAGE_NUM);
+    stats.stage_ns[stage][stats.stage_count[stage] % kStatsWindow] = ns;
+    stats.stage_count[stage]++;
+}
+
+void statsStageEnd(PipelineStats& stats, int stage, int64_t begin_ns)
+{
+    int64_t end_ns = traceNowNs();
+    statsStage(stats, stage, end_ns - begin_ns);
+    stats.stage_end_ns[stage] = end_ns;
+    if (traceEnabled()) {
+        traceRecord(kStageNames[stage], begin_ns, end_ns);
+    }
+}
+
+void statsFrame(PipelineStats& stats, int64_t now_ns, uint32_t sequence)
+{
+    if (stats.frames > 0) {
+        stats.frame_ns[stats.frame_count % kStatsWindow] = now_ns - stats.last_frame_ns;
+        stats.frame_count++;
+        // 序号回绕时按无符号差计算
+        uint32_t gap = sequence - stats.last_sequence;
+        if (gap > 1 && gap < 0x80000000u) {
+            stats.drops += gap - 1;
+        }
+    }
+    stats.last_frame_ns = now_ns;
+    stats.last_sequence = sequence;
+    stats.frames++;
+}
+
+double statsFps(const PipelineStats& stats)
+{
+    int num = std::min(stats.frame_count, kStatsWindow);
+    int64_t sum = 0;
+    for (int i = 0; i < num; i++) {
+        sum += stats.frame_ns[i];
+    }
+    return sum > 0 ? num * 1e9 / sum : 0.0;
+}
+
+int64_t statsPercentile(const PipelineStats& stats, int stage, double p)
+{
+    CV_Assert(stage >= 0 && stage < STAGE_NUM);
+    int num = std::min(stats.stage_count[stage], kStatsWindow);
+    if (num == 0) {
+        return 0;
+    }
+    int64_t samples[kStatsWindow];
+    std::copy(stats.stage_ns[stage], stats.stage_ns[stage] + num, samples);
+    int k = std::min(num - 1, std::max(0, (int)(p * num)));
+    std::nth_element(samples, samples + k, samples + num);
+    return samples[k];
+}
+
+int statsFrameHistory(const PipelineStats& stats, int64_t* out, int max)
+{
+    int num = std::min(std::min(stats.frame_count, kStatsWindow), max);
+    for (int i = 0; i < num; i++) {
+        out[i] = stats.frame_ns[(stats.frame_count - num + i) % kStatsWindow];
+    }
+    return num;
+}
@@ -352,8 +352,6 @@
 //        return -1;
 //    }
 
-//    // 初始化截图上下文（保存到当前目录的 screenshots 文件夹）
-//    ScreenshotContext screenshot_ctx("/home/nnewn/Desktop/AC020_SDK/libir_sample/sample/usb_stream_cmd/fig");
 
 //    // 设置视频格式
 //    v4l2_format fmt{};
@@ -465,270 +463,65 @@
 
 
 #include <iostream>
+#include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <linux/videodev2.h>
 #include <opencv2/opencv.hpp>
 #include <chrono>
 #include <string>
 
-#define DEVICE "/dev/video0"
-#define WIDTH 384
-#define HEIGHT 288
+#include "pipeline.h"
+#include "appconfig.h"
+#include "bench.h"
+#include "control.h"
+#include "golden.h"
+#include "latency.h"
+#include "telemetry.h"
+#include "trace.h"
 
-// ===================== algorithm ======================
-void do_CLAHE(cv::Mat& src,cv::Mat& dst){
-    //int clip_limit = 3; // 定义限制对比度的参数  best_config
-//    int clip_limit = 4.5; // 定义限制对比度的参数
-    int clip_limit = 2; // 定义限制对比度的参数
-    int tile_size = 1; // 定义块的大小
-
-    cv::Ptr<cv::CLAHE> clahe = createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
-    clahe->apply(src, dst); // 应用CLAHE算法
-}
-
-void do_CLAHE_sobelprewitt(cv::Mat& src,cv::Mat& dst){
-    //int clip_limit = 3; // 定义限制对比度的参数  best_config
-//    int clip_limit = 4.5; // 定义限制对比度的参数
-    float clip_limit = 3.5; // 定义限制对比度的参数
-    int tile_size = 1; // 定义块的大小
-
-    cv::Ptr<cv::CLAHE> clahe = createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
-    clahe->apply(src, dst); // 应用CLAHE算法
-}
-
-void do_CLAHE_edge(cv::Mat& src,cv::Mat& dst){
-    float clip_limit = 1.3; // 定义限制对比度的参数
-    //int tile_size = 8; // 定义块的大小
-    int tile_size = 1; // 定义块的大小
-
-    cv::Ptr<cv::CLAHE> clahe = createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
-    clahe->apply(src, dst); // 应用CLAHE算法
-}
-
-
-void do_CLAHE_edge_Frei_Chen(cv::Mat& src,cv::Mat& dst){
-    int clip_limit = 3; // 定义限制对比度的参数
-    //int tile_size = 8; // 定义块的大小
-    int tile_size = 1; // 定义块的大小
-
-    cv::Ptr<cv::CLAHE> clahe = createCLAHE(clip_limit, cv::Size(tile_size, tile_size)); // 创建CLAHE对象
-    clahe->apply(src, dst); // 应用CLAHE算法
-}
-
-
-cv::Mat SobelPrewitt(cv::Mat img) {
-    // ---------------- Sobel 边缘检测 ----------------
-    cv::Mat sobel_x, sobel_y, sobel_magnitude;
-    cv::Sobel(img, sobel_x, CV_64F, 1, 0, 3);
-    cv::Sobel(img, sobel_y, CV_64F, 0, 1, 3);
-    cv::magnitude(sobel_x, sobel_y, sobel_magnitude);
-
-    // ---------------- Prewitt 边缘检测 ----------------
-    cv::Mat prewitt_x, prewitt_y, prewitt_magnitude;
-    cv::Mat kernel_prewitt_x = (cv::Mat_<float>(3,3) << -1, 0, 1,
-                                                        -1, 0, 1,
-                                                        -1, 0, 1);
-    cv::Mat kernel_prewitt_y = (cv::Mat_<float>(3,3) <<  1,  1,  1,
-                                                         0,  0,  0,
-                                                        -1, -1, -1);
-    cv::filter2D(img, prewitt_x, CV_64F, kernel_prewitt_x);
-    cv::filter2D(img, prewitt_y, CV_64F, kernel_prewitt_y);
-    cv::magnitude(prewitt_x, prewitt_y, prewitt_magnitude);
-
-    // ---------------- 综合两者 ----------------
-    cv::Mat combined_magnitude_64F;
-    cv::addWeighted(sobel_magnitude, 0.5, prewitt_magnitude, 0.5, 0, combined_magnitude_64F);
-
-    // 将最终结果转换为 CV_8U 以便显示或保存
-    cv::Mat combined_magnitude_8U;
-    combined_magnitude_64F.convertTo(combined_magnitude_8U, CV_8U);
-
-    return combined_magnitude_8U;
-}
-
-
-cv::Mat Kirsch(cv::Mat img){
-   // 定义 8 个 Kirsch 卷积核
-   std::vector<cv::Mat> kirsch_kernels = {
-       (cv::Mat_<float>(3,3) <<  5,  5,  5,
-                                -3,  0, -3,
-                                -3, -3, -3), // N
-
-       (cv::Mat_<float>(3,3) <<  5,  5, -3,
-                                 5,  0, -3,
-                                -3, -3, -3), // NE
-
-       (cv::Mat_<float>(3,3) <<  5, -3, -3,
-                                 5,  0, -3,
-                                 5, -3, -3), // E
-
-       (cv::Mat_<float>(3,3) << -3, -3, -3,
-                                 5,  0, -3,
-                                 5,  5, -3), // SE
-
-       (cv::Mat_<float>(3,3) << -3, -3, -3,
-                                -3,  0, -3,
-                                 5,  5,  5), // S
-
-       (cv::Mat_<float>(3,3) << -3, -3, -3,
-                                -3,  0,  5,
-                                -3,  5,  5), // SW
-
-       (cv::Mat_<float>(3,3) << -3, -3,  5,
-                                -3,  0,  5,
-                                -3, -3,  5), // W
-
-       (cv::Mat_<float>(3,3) << -3,  5,  5,
-                                -3,  0,  5,
-                                -3, -3, -3)  // NW
-   };
-
-   // 初始化最大响应图
-   cv::Mat max_response = cv::Mat::zeros(img.size(), CV_32F);
-
-   // 对每个方向卷积并保留最大值
-   for (const auto& kernel : kirsch_kernels) {
-       cv::Mat response;
-       cv::filter2D(img, response, CV_32F, kernel);
-       cv::max(max_response, response, max_response);
-   }
-
-   // 转换为 8 位图像以便显示
-   cv::Mat kirsch_edge;
-   max_response.convertTo(kirsch_edge, CV_8U);
-
-   return kirsch_edge;
-}
-
-
-cv::Mat Frei_Chen(cv::Mat img) {
-    // 定义 sqrt(2)
-    float sqrt2 = std::sqrt(2.0f);
-
-    // Frei-Chen X方向卷积核
-    cv::Mat kernel_x = (cv::Mat_<float>(3, 3) <<
-        1,      sqrt2,  1,
-        0,      0,      0,
-       -1,     -sqrt2, -1);
-
-    // Frei-Chen Y方向卷积核
-    cv::Mat kernel_y = (cv::Mat_<float>(3, 3) <<
-         1,     0,    -1,
-         sqrt2, 0, -sqrt2,
-         1,     0,    -1);
-
-    // 进行卷积运算
-    cv::Mat frei_x, frei_y;
-    cv::filter2D(img, frei_x, CV_32F, kernel_x);
-    cv::filter2D(img, frei_y, CV_32F, kernel_y);
-
-    // 计算幅值图
-    cv::Mat magnitude;
-    cv::magnitude(frei_x, frei_y, magnitude);
-
-    // 转换为 8 位图像
-    cv::Mat edge_output;
-    magnitude.convertTo(edge_output, CV_8U);
-
-    return edge_output;
-}
+// 设备路径、分辨率、info 行数、坏点表路径及各调参项见 appconfig.h, 由配置文件覆盖(--config)
 
+// ===================== algorithm ======================
 cv::Mat unsharpMasking(cv::Mat &input,
                       double sigma = 1.5,
                       double strength = 1.0,
-                      int ksize = 5)
+                      int ksize = 5,
+                      bool luma_only = false)
 {
     // 参数校验
     CV_Assert(ksize > 0 && ksize % 2 == 1);
     CV_Assert(strength >= 0);
 
-    cv::Mat blurred, sharpened;
-
-    // Step 1: 高斯模糊（创建非锐化掩模的基础）
-    cv::GaussianBlur(input, blurred,
-                    cv::Size(ksize, ksize), // 核尺寸
-                    sigma,                  // X方向标准差
-                    sigma,                  // Y方向标准差（设为相同值）
-                    cv::BORDER_REPLICATE);  // 边界处理方式
-
-    // Step 2: 计算锐化图像（原图 + (原图 - 模糊图) * 强度）
-    if (input.channels() == 1) { // 灰度图处理
-        cv::subtract(input, blurred, sharpened);
-        cv::addWeighted(input, 1.0,
-                       sharpened, strength,
-                       0.0,       // 偏移量
-                       sharpened);
-    } else { // 彩色图处理（逐通道处理）
-        std::vector<cv::Mat> channels;
-        cv::split(input, channels);
-
-        for (auto &ch : channels) {
-            cv::Mat ch_blurred, ch_sharpened;
-            cv::GaussianBlur(ch, ch_blurred,
-                            cv::Size(ksize, ksize),
-                            sigma, sigma,
-                            cv::BORDER_REPLICATE);
-            cv::subtract(ch, ch_blurred, ch_sharpened);
-            cv::addWeighted(ch, 1.0,
-                           ch_sharpened, strength,
-                           0.0,
-                           ch);
-        }
-        cv::merge(channels, sharpened);
-    }
-
-    // 处理像素溢出（确保值在0-255之间）
-    sharpened.convertTo(sharpened, CV_8U);
+    // 定点融合实现: 可分离高斯模糊与 原图 + (原图 - 模糊图) * 强度 在同一次逐行遍历中完成,
+    // 结果饱和到 0-255; 彩色图可选只锐化亮度
+    cv::Mat sharpened;
+    unsharpMaskFixed(input, sharpened, sigma, strength, ksize, luma_only);
     return sharpened;
 }
 
 
 
 //egde enhancement bsed on sobelprewitt
-cv::Mat edgeSobelPrewitt(const cv::Mat& frame) {
-    cv::Mat gray;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-//    do_CLAHE(gray,gray);
-    do_CLAHE_sobelprewitt(gray,gray);
-    cv::Mat dst = SobelPrewitt(gray);
-    {
-    // 将灰度图转换为 BGR 三通道图
-    cv::Mat edge_bgr;
-    cv::cvtColor(dst, edge_bgr, cv::COLOR_GRAY2BGR);
-
-    // 分离通道
-    std::vector<cv::Mat> channels(3);
-    cv::split(edge_bgr, channels);
-
-    // 红色和蓝色通道清零
-    channels[0] = cv::Mat::zeros(channels[0].size(), channels[0].type());  // 蓝色
-    channels[2] = cv::Mat::zeros(channels[2].size(), channels[2].type());  // 红色
-
-    // 可选：阈值化绿色通道以增强高亮
-    // cv::threshold(channels[1], channels[1], 70, 255, cv::THRESH_BINARY);
-
-    // 或者用掩码增强高亮（例如 >70 的像素提亮为 255）
-    cv::Mat mask = (channels[1] > 70);
-    channels[1].setTo(255, mask);  // 绿色通道
-
-    // 合并回三通道图像
+cv::Mat edgeSobelPrewitt(const cv::Mat& frame, FusedEdgeState& state,
+                         const EdgeOverlayParams& overlay, double clip_limit) {
+    // BGR2GRAY -> CLAHE -> SobelPrewitt -> 绿色高亮 融合为两遍遍历,
+    // 高亮(>threshold 提亮为 color)直接写入显示用的 BGR 缓冲
     cv::Mat dst;
-    cv::merge(channels, dst);
-    }
+    fusedClaheEdge(state, frame, dst, EDGE_SOBEL_PREWITT, clip_limit, &overlay);
     cv::Mat show_mat = dst;
     return show_mat;
 }
 
 //egde enhancement bsed on kirsch
-cv::Mat kirsch(const cv::Mat frame) {
-    cv::Mat gray;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    do_CLAHE_edge(gray,gray);
-
-    cv::Mat dst = Kirsch(gray);
+cv::Mat kirsch(const cv::Mat frame, FusedEdgeState& state, double clip_limit) {
+    // BGR2GRAY -> CLAHE -> Kirsch 融合为两遍遍历
+    cv::Mat dst;
+    fusedClaheEdge(state, frame, dst, EDGE_KIRSCH, clip_limit);
 //    dst = AddnonCircle(dst);
     cv::Mat show_mat = dst;
     return show_mat;
@@ -737,11 +530,11 @@ cv::Mat kirsch(const cv::Mat frame) {
 
 
 //egde enhancement bsed on Frei_Chen
-cv::Mat frei_Chen(const cv::Mat frame) {
-    cv::Mat gray;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    do_CLAHE_edge_Frei_Chen(gray,gray);
-    cv::Mat dst = Frei_Chen(gray);
+cv::Mat frei_Chen(const cv::Mat frame, FusedEdgeState& state, double clip_limit) {
+    // 显示仍用浮点 Frei_Chen: 定点核(融合流水线)在目标板上测得更快之前不替换, 见 --bench 的 Frei-Chen 项
+    cv::cvtColor(frame, state.gray, cv::COLOR_BGR2GRAY);
+    cv::createCLAHE(clip_limit, cv::Size(1, 1))->apply(state.gray, state.gray);
+    cv::Mat dst = Frei_Chen(state.gray);
 //    dst = AddnonCircle(dst);
     cv::Mat show_mat = dst;
     return show_mat;
@@ -749,14 +542,15 @@ cv::Mat frei_Chen(const cv::Mat frame) {
 }
 
 
-cv::Mat defaultmethod(const cv::Mat frame) {
+cv::Mat defaultmethod(const cv::Mat frame, const TuningParams& tuning) {
 //    float temp2 = 55.0;
     cv::Mat gray;
     cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    gray = unsharpMasking(gray, 1.5, 1.0, 5);
+    gray = unsharpMasking(gray, tuning.unsharp_sigma, tuning.unsharp_strength, tuning.unsharp_ksize);
     cv::Mat temp2;
 //    do_CLAHE(gray,temp2);
-    do_CLAHE(gray,gray);
+    // 同 do_CLAHE, 参数取自配置
+    cv::createCLAHE(tuning.clip_default, cv::Size(tuning.tile_size, tuning.tile_size))->apply(gray, gray);
     // do_CLAHE250110(gray,temp2);
     // do_USM(temp2, dst);
 
@@ -788,6 +582,11 @@ struct AppContext {
     cv::Rect algorithm_button_rect;
     bool show_algorithm_highlight;
     int current_algorithm; // 0: 无增强, 1: 边缘增强
+    int palette;           // 伪彩序号, -1 为灰度显示(按 p 键切换)
+    const HotspotState* hotspots; // 非空时叠加显示热点(按 h 键切换)
+    const HudState* hud;          // 非空时叠加显示性能 HUD(按 i 键切换)
+    cv::Size sensor_size;         // 传感器分辨率(放大前)
+    double display_factor;        // 显示放大倍数
     bool exit_button_pressed,exit_requested;
     bool show_exit_highlight;
 //    bool exit_requested;
@@ -803,6 +602,11 @@ struct AppContext {
         show_algorithm_highlight(false),
 //        current_algorithm(1) {} ,// 默认使用边缘增强
         current_algorithm(1),// 默认使用边缘增强
+        palette(-1),
+        hotspots(NULL),
+        hud(NULL),
+        sensor_size(384, 288),
+        display_factor(2),
         exit_button_pressed(false),
         exit_button_rect(10, 60, 20, 20), // 退出按钮位置
         show_exit_highlight(false),
@@ -832,12 +636,43 @@ void mouseCallback(int event, int x, int y, int, void* userdata) {
     }
 }
 
+// 算法名称, 用于界面显示、截图文件名与延迟报告
+std::string algorithmName(int algorithm) {
+    if (algorithm == 1) {
+        return "default";
+    }
+    else if (algorithm == 2) {
+        return "SobelPrewitt";
+    }
+    else if (algorithm == 3) {
+        return "kirsch";
+    }
+    else if (algorithm == 4) {
+        return "frei_Chen";
+    }
+    return "ori";
+}
+
+// 逐级创建截图目录, 已存在时不报错
+static bool makeDirs(const std::string& path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string dir = path.substr(0, pos);
+        if (!dir.empty() && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (pos == std::string::npos) {
+            return true;
+        }
+    }
+}
+
 void showFrameWithUI(cv::Mat& frame, AppContext& ctx) {
-    float factor=2;
+    double factor = ctx.display_factor;
     static bool first_call = true;
 //    if (first_call) {
         cv::namedWindow("Camera", cv::WINDOW_AUTOSIZE);
-        cv::resizeWindow("Camera",384*factor,288*factor);
+        cv::resizeWindow("Camera", cvRound(ctx.sensor_size.width * factor), cvRound(ctx.sensor_size.height * factor));
 //        cv::namedWindow("Camera", );
 //    cv::namedWindow("Camera", cv::WINDOW_NORMAL);
 //    cv::setWindowProperty("Camera", cv::WND_PROP_FULLSCREEN, cv::WINDOW_FULLSCREEN);
@@ -868,23 +703,7 @@ void showFrameWithUI(cv::Mat& frame, AppContext& ctx) {
 
     // 根据当前算法显示不同的文本
     int al_num =5 ;
-    std::string algo_text;
-    if (ctx.current_algorithm == 1){
-        algo_text="default";
-    }
-    else if(ctx.current_algorithm == 2)
-    {
-        algo_text="SobelPrewitt";
-    }
-    else if(ctx.current_algorithm == 3){
-        algo_text="kirsch";
-    }
-    else if(ctx.current_algorithm == 4){
-        algo_text="frei_Chen";
-    }
-    else {
-        algo_text="ori";
-    }
+    std::string algo_text = algorithmName(ctx.current_algorithm);
     cv::putText(display, algo_text,
                cv::Point(ctx.screenshot_button_rect.x+20 , ctx.screenshot_button_rect.y+15),
                cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
@@ -903,8 +722,12 @@ void showFrameWithUI(cv::Mat& frame, AppContext& ctx) {
         auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
         std::string filename = ctx.save_path + "/capture_" +algo_text+
                               std::to_string(timestamp) + ".jpg";
-        cv::imwrite(filename, frame);
-        std::cout << "截图已保存: " << filename << std::endl;
+        if (makeDirs(ctx.save_path) && cv::imwrite(filename, frame)) {
+            std::cout << "截图已保存: " << filename << std::endl;
+        }
+        else {
+            perror(("截图保存失败: " + filename).c_str());
+        }
         ctx.screenshot_button_pressed = false;
         ctx.show_screenshot_highlight = false;
     }
@@ -922,6 +745,15 @@ void showFrameWithUI(cv::Mat& frame, AppContext& ctx) {
         ctx.show_algorithm_highlight = false;
     }
 
+    // 绘制热点(检测在原始分辨率上进行)
+    if (ctx.hotspots != NULL) {
+        hotspotDraw(*ctx.hotspots, display, factor);
+    }
+    if (ctx.hud != NULL) {
+        hudDraw(*ctx.hud, display);
+    }
+
+    TRACE_SCOPE("imshow");
     cv::imshow("Camera", display);
 //    cv::Size upsize=cv::Size(384*3,288*3);
 //    cv::Mat upimg;
@@ -935,32 +767,29 @@ struct buffer {
     size_t length;
 };
 
-void yuyv_to_mat(const void* yuyv_data, cv::Mat& rgb_frame) {
-    cv::Mat yuyv(HEIGHT, WIDTH, CV_8UC2, (void*)yuyv_data);
+void yuyv_to_mat(const void* yuyv_data, cv::Mat& rgb_frame, int width, int height) {
+    cv::Mat yuyv(height, width, CV_8UC2, (void*)yuyv_data);
     cv::cvtColor(yuyv, rgb_frame, cv::COLOR_YUV2BGR_YUYV);
 }
 
 
-// 伪彩增强函数（默认使用 COLORMAP_JET，支持自定义颜色映射）
-cv::Mat pseudoColorEnhance(const cv::Mat& frame, int colormap = cv::COLORMAP_JET) {
+// 伪彩增强函数（使用伪彩引擎当前色表，由 paletteSelect 切换）
+cv::Mat pseudoColorEnhance(const cv::Mat& frame, const PaletteEngine& palette) {
     if (frame.empty()) {
         throw std::runtime_error("Input frame is empty!");
     }
 
     cv::Mat gray;
-    // 若输入为彩色图，转换为灰度图；否则直接使用
+    // 若输入为彩色图，转换为灰度图；否则直接使用(查表不修改输入, 无需拷贝)
     if (frame.channels() == 3) {
         cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
     } else {
-        gray = frame.clone();
+        gray = frame;
     }
 
-    // 可选：直方图均衡化增强对比度（取消注释启用）
-    // cv::equalizeHist(gray, gray);
-
-    // 应用伪彩颜色映射
+    // 查表上色, 直接输出 BGR 显示图
     cv::Mat pseudo_color;
-    cv::applyColorMap(gray, pseudo_color, colormap);
+    applyPalette(palette, gray, pseudo_color, PALETTE_FMT_BGR);
 
     return pseudo_color;
 }
@@ -991,19 +820,200 @@ cv::Mat noEnhancement(const cv::Mat& frame) {
     return frame.clone();
 }
 
-int main() {
+// 对放大后的帧应用当前选择的算法, palette >= 0 时默认算法输出伪彩
+cv::Mat applyAlgorithm(int algorithm, const cv::Mat& frame, PipelineArena& arena, int palette,
+                       const TuningParams& tuning) {
+    cv::Mat processed_frame;
+    if (algorithm == 1) {
+        processed_frame = defaultmethod(frame, tuning);
+//              processed_frame = edgeEnhanceSobel(frame);
+        if (palette >= 0) {
+            processed_frame = pseudoColorEnhance(processed_frame, arena.palette);
+        }
+    }
+    else if((algorithm == 2)){
+//            processed_frame = noEnhancement(frame);
+          // 没有彩色输出端时不做高亮着色, 只输出单通道边缘图
+          arena.overlay.enabled = arena.color_sink;
+          processed_frame = edgeSobelPrewitt(frame, arena.edge, arena.overlay, tuning.clip_sobel_prewitt);
+    }
+    else if((algorithm == 3)){
+        processed_frame = kirsch(frame, arena.edge, tuning.clip_kirsch);
+    }
+    else if((algorithm == 4)){
+        processed_frame = frei_Chen(frame, arena.edge, tuning.clip_frei_chen);
+    }
+    else{
+        processed_frame = noEnhancement(frame);
+//                       processed_frame = kirsch(frame, arena.edge);
+    }
+    return processed_frame;
+}
+
+// 闪烁自测: 模拟相机 -> 格式转换 -> 放大 -> 各算法, 不含跨帧预处理(时域降噪会拖慢图案出现)
+int runLatencyTest(int load_ms) {
+    PipelineArena arena;
+    const TuningParams tuning;
+    std::vector<LatencyAlgorithm> algorithms;
+    for (int algorithm = 0; algorithm <= 4; algorithm++) {
+        LatencyAlgorithm entry;
+        entry.name = algorithmName(algorithm);
+        entry.process = [algorithm, &arena, &tuning](const cv::Mat& yuyv, cv::Mat& out) {
+            cv::Mat frame;
+            yuyv_to_mat(yuyv.data, frame, yuyv.cols, yuyv.rows);
+            upscale2x(frame, frame, arena.upscale_mode);
+            out = applyAlgorithm(algorithm, frame, arena, -1, tuning);
+        };
+        algorithms.push_back(entry);
+    }
+    LatencyTestParams params;
+    params.load_ms = load_ms;
+    LatencyRecorder rec;
+    std::vector<LatencyTestResult> results;
+    bool pass = latencySelfTest(params, algorithms, rec, results);
+    latencyReport(rec, "");
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 无头运行时 Ctrl-C / SIGTERM 结束主循环, 正常停流并输出延迟报告
+static volatile sig_atomic_t g_stop_requested = 0;
+
+static void stopSignalHandler(int)
+{
+    g_stop_requested = 1;
+}
+
+static const int kInfoHeightMax = 16;   // 附加行数超过该值的帧尺寸视为其他输出模式(如图像+温度)
+
+// 识别 info 行行数: 设备以 YUYV 提供 width x (height + n) 帧尺寸(n 较小)时即带 info 行输出
+static int detectInfoHeight(int fd, const DeviceConfig& dev)
+{
+    int info_height = 0;
+    v4l2_frmsizeenum size = {};
+    size.pixel_format = V4L2_PIX_FMT_YUYV;
+    for (size.index = 0; ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0; size.index++) {
+        if (size.type != V4L2_FRMSIZE_TYPE_DISCRETE) {
+            break;
+        }
+        // 图像(和 NUC 帧)之后多出的行为 info 行
+        int extra = (int)size.discrete.height - dev.height * (1 + dev.temp_frame);
+        if ((int)size.discrete.width == dev.width && extra > 0 && extra <= kInfoHeightMax) {
+            info_height = info_height > 0 ? std::min(info_height, extra) : extra;
+        }
+    }
+    return info_height;
+}
+
+// 运行中的按键(q 退出由调用者处理), 正常帧与 FFC 期间重复显示的帧共用
+static void handleKey(int key, AppContext& ctx, PipelineArena& arena)
+{
+    // d 键开始坏点标定(对准均匀场景)
+    if (key == 'd') {
+        dpcStartCalibration(arena.dpc);
+        std::cout << "开始坏点标定..." << std::endl;
+    }
+    // h 键开关热点检测, 关闭时清空跟踪
+    if (key == 'h') {
+        ctx.hotspots = (ctx.hotspots == NULL) ? &arena.hotspot : NULL;
+        arena.hotspot.tracks.clear();
+    }
+    // i 键开关性能 HUD(帧率、丢帧、各阶段 p50/p99、帧间隔曲线)
+    if (key == 'i') {
+        ctx.hud = (ctx.hud == NULL) ? &arena.hud : NULL;
+        arena.hud.next_ns = 0;
+    }
+    // p 键循环切换伪彩: 灰度 -> 各伪彩 -> 灰度
+    if (key == 'p') {
+        ctx.palette = (ctx.palette + 1 < arena.palette.num) ? ctx.palette + 1 : -1;
+        if (ctx.palette >= 0) {
+            paletteSelect(arena.palette, ctx.palette);
+            std::cout << "伪彩: " << arena.palette.names[ctx.palette] << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    // 离线基准/容差检查, 不打开设备
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmarks();
+    }
+    // 黄金图像回归: sample --golden [目录] [--update]
+    if (argc > 1 && std::string(argv[1]) == "--golden") {
+        std::string dir = argc > 2 && std::string(argv[2]) != "--update" ? argv[2] : "./golden";
+        bool update = std::string(argv[argc - 1]) == "--update";
+        return runGolden(dir, update);
+    }
+    // 延迟闪烁自测: sample --latency-test [每帧附加处理 ms], 不打开设备
+    if (argc > 1 && std::string(argv[1]) == "--latency-test") {
+        return runLatencyTest(argc > 2 ? atoi(argv[2]) : 0);
+    }
+    // 阶段跟踪: --trace <文件>, 退出时或收到 SIGUSR1 时导出 Chrome trace JSON
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--trace") {
+            traceSetThreadName("capture");
+            traceDumpOnSignal(SIGUSR1, argv[i + 1]);
+            traceDumpAtExit(argv[i + 1]);
+            traceEnable(true);
+        }
+    }
+    // 延迟测量: --latency <CSV 文件> 按算法记录采集到呈现的延迟, 退出时打印并追加到文件;
+    // --buffers <n> 设置驱动缓冲数, 不同缓冲数分别运行后在同一文件中对比
+    std::string latency_path;
+    int buffer_count = 4;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--latency") {
+            latency_path = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--buffers") {
+            buffer_count = std::max(1, atoi(argv[i + 1]));
+        }
+    }
+    LatencyRecorder latency;
+    // 运行配置: --config <JSON 文件>, 默认 ./config.json; 调参项修改后在下一帧生效, 设备配置需重启
+    std::string config_path = "./config.json";
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--config") {
+            config_path = argv[i + 1];
+        }
+    }
+    // 无头运行: --headless 不创建显示窗口(板端性能/延迟测量), 没有彩色输出端, 着色阶段随之跳过
+    // --verbose 打印热点出现/消失统计(每秒至多一行), 默认实时循环不写 stdout
+    bool headless = false, verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless") {
+            headless = true;
+        }
+        if (std::string(argv[i]) == "--verbose") {
+            verbose = true;
+        }
+    }
+    if (headless) {
+        signal(SIGINT, stopSignalHandler);
+        signal(SIGTERM, stopSignalHandler);
+    }
+    AppConfig config;
+    appConfigLoad(config, config_path);
+    appConfigWatch(config);
+    const DeviceConfig& dev = config.device;
+
     // 打开摄像头设备
-    int fd = open(DEVICE, O_RDWR);
+    int fd = open(dev.device.c_str(), O_RDWR);
     if (fd < 0) {
         perror("打开设备失败");
         return EXIT_FAILURE;
     }
 
+    // info 行: 配置为 -1 时按设备支持的帧尺寸识别, 有 info 行时按帧解析快门/FFC 状态
+    int info_height = dev.info_height >= 0 ? dev.info_height : detectInfoHeight(fd, dev);
+    if (info_height > 0) {
+        std::cout << "info 行: " << info_height << " 行" << std::endl;
+    }
+
     // 设置视频格式
     v4l2_format fmt = {};
     fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    fmt.fmt.pix.width = WIDTH;
-    fmt.fmt.pix.height = HEIGHT;
+    fmt.fmt.pix.width = dev.width;
+    fmt.fmt.pix.height = dev.height * (1 + dev.temp_frame) + info_height;
     fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
     fmt.fmt.pix.field = V4L2_FIELD_NONE;
 
@@ -1015,7 +1025,7 @@ int main() {
 
     // 请求缓冲区
     v4l2_requestbuffers req = {};
-    req.count = 4;
+    req.count = buffer_count;
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     req.memory = V4L2_MEMORY_MMAP;
 
@@ -1075,57 +1085,212 @@ int main() {
     }
 
     // 创建UI上下文
-//    AppContext ctx("./screenshots");
-    AppContext ctx("/home/nnewn/Desktop/AC020_SDK/libir_sample/sample/usb_stream_cmd/fig");
+    AppContext ctx(appConfigTuning(config)->screenshot_path);
+    ctx.sensor_size = cv::Size(dev.width, dev.height);
+    // 跨帧状态(时域降噪历史等)
+    PipelineArena arena;
+    arena.color_sink = !headless;
+    // 加载上次标定的坏点表(按 d 键重新标定)
+    if (dpcLoad(arena.dpc, dev.dpc_map_path)) {
+        std::cout << "坏点表已加载: " << arena.dpc.defects.size() << " 个坏点" << std::endl;
+    }
+    // 测温: 帧内带 NUC 帧且加载了 NUC_T 表时每帧换算温度图
+    if (dev.temp_frame > 0 && !dev.nuc_table_path.empty()) {
+        if (tempMapLoadNucTable(arena.tempmap, dev.nuc_table_path)) {
+            std::cout << "NUC_T 表已加载: " << dev.nuc_table_path << std::endl;
+        }
+        else {
+            std::cerr << "无法加载 NUC_T 表 " << dev.nuc_table_path << ", 不做温度换算" << std::endl;
+        }
+    }
+    // 命令通道: 打开后同步设备伪彩列表, 失败时只使用本地色表
+    ControlChannel control;
+    CmdExecutor exec;
+    TelemetryState telemetry;
+    if (controlOpen(control, dev)) {
+        int device_palettes = paletteSyncDevice(arena.palette, control.cmd, dev.palette_dir);
+        if (device_palettes < 0) {
+            std::cerr << "读取设备伪彩列表失败, 只使用本地色表" << std::endl;
+        }
+        else {
+            std::cout << "已同步设备伪彩: " << device_palettes << " 个" << std::endl;
+        }
+        // 之后句柄交给执行器独占; 遥测线程只轮询快门状态, 驱动 FFC 检测(热路径外)
+        cmdExecStart(exec, control.cmd);
+        for (int m = 0; m < TELEM_NUM; m++) {
+            telemetry.params.period_ms[m] = 0;
+        }
+        telemetry.params.period_ms[TELEM_SHUTTER] = TelemetryParams().period_ms[TELEM_SHUTTER];
+        telemetry.ffc = &arena.ffc;
+        telemetryStart(telemetry, &exec);
+    }
+    else {
+        std::cerr << "命令通道未打开, 设备伪彩不同步, 快门状态只能从 info 行获取" << std::endl;
+    }
+
+    uint32_t tuning_version = 0;
+    // 上次汇总以来的热点出现/消失次数
+    int hotspot_events[2] = {0, 0};
+    int64_t hotspot_log_ns = 0;
 
     // 主循环
-    while (true) {
+    for (int64_t frame_index = 0; ; frame_index++) {
+        tracePoll();
+        traceFrame(frame_index);
+        TRACE_SCOPE("frame");
+        // 帧边界处理配置更新, 本帧持有同一参数块; 跨帧状态不复位, 尺寸不变的缓冲区不重新分配
+        appConfigPoll(config);
+        std::shared_ptr<const TuningParams> tuning = appConfigTuning(config);
+        if (tuning->version != tuning_version) {
+            arena.overlay.threshold = tuning->edge_threshold;
+            ctx.save_path = tuning->screenshot_path;
+            ctx.display_factor = tuning->display_factor;
+            tuning_version = tuning->version;
+        }
         // 获取一帧
         v4l2_buffer buf = {};
         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         buf.memory = V4L2_MEMORY_MMAP;
 
-        if (ioctl(fd, VIDIOC_DQBUF, &buf) < 0) {
+        int dq;
+        {
+            StageScope stage(arena.stats, STAGE_CAPTURE);
+            dq = ioctl(fd, VIDIOC_DQBUF, &buf);
+        }
+        if (dq < 0) {
             perror("获取帧失败");
             break;
         }
+        int64_t dq_ns = traceNowNs();
+        statsFrame(arena.stats, dq_ns, buf.sequence);
+        // 驱动给出的采集时间戳
+        int64_t capture_ns = latencyCaptureNs(buf, dq_ns);
+
+        // FFC 期间(快门闭合/冻结帧)跳过全部处理, 重复显示上一帧正常输出,
+        // 时域降噪、SBNUC、坏点标定等跨帧状态保持不变
+        uchar* raw = (uchar*)buffers[buf.index].start;
+        // 本帧元数据, info 行各字段在首次访问时才解析
+        FrameMeta meta;
+        frameMetaAttach(meta, info_height > 0 ? raw + dev.width * dev.height * 2 * (1 + dev.temp_frame) : NULL);
+        int ffc_phase;
+        {
+            TRACE_SCOPE("ffc_guard");
+            ffc_phase = ffcGuardUpdate(arena.ffc, raw, dev.width * dev.height * 2, meta);
+        }
+        if (ffc_phase != FFC_IDLE && !arena.ffc.last_output.empty()) {
+            if (!headless) {
+                cv::Mat held = arena.ffc.last_output.clone();
+                showFrameWithUI(held, ctx);
+            }
+            if (ioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+                perror("缓冲区重新入队失败");
+                break;
+            }
+            int key = headless ? -1 : cv::waitKey(1);
+            if (ctx.exit_requested || key == 'q' || g_stop_requested) {
+                break;
+            }
+            handleKey(key, ctx, arena);
+            continue;
+        }
+        // 快门 FFC 已消除偏移漂移, 场景校正重新学习
+        if (arena.ffc.finished) {
+            resetSbnuc(arena.nuc);
+        }
+
+        // 温度图: NUC 帧查表换算为 kelvin*16, 查找表不可用时本帧不测温
+        if (dev.temp_frame > 0 && !arena.tempmap.nuc_table.empty()) {
+            TRACE_SCOPE("tempmap");
+            cv::Mat nuc(dev.height, dev.width, CV_16UC1, raw + dev.width * dev.height * 2);
+            if (!tempMapApply(arena.tempmap, nuc, arena.temp, CV_16U)) {
+                arena.temp.release();
+            }
+        }
 
         // 转换格式
         cv::Mat frame;
-        yuyv_to_mat(buffers[buf.index].start, frame);
-
-        // 应用当前选择的算法
-        cv::Mat processed_frame;
-        float factor2=2;
-        cv::Size upsize=cv::Size(384*factor2,288*factor2);
-//        cv::Mat display;
-        cv::resize(frame,frame,upsize,cv::INTER_AREA);
+        {
+            StageScope stage(arena.stats, STAGE_CONVERT);
+            yuyv_to_mat(raw, frame, dev.width, dev.height);
+        }
 
-        if (ctx.current_algorithm == 1) {
-            processed_frame = defaultmethod(frame);
-//              processed_frame = edgeEnhanceSobel(frame);
+        // 算法切换时丢弃跨帧状态
+        if (ctx.current_algorithm != arena.last_algorithm) {
+            resetPipelineState(arena);
+            arena.last_algorithm = ctx.current_algorithm;
         }
-        else if((ctx.current_algorithm == 2)){
-//            processed_frame = noEnhancement(frame);
-              processed_frame = edgeSobelPrewitt(frame);
+        // 坏点标定使用未校正的原始帧
+        if (dpcAccumulate(arena.dpc, frame)) {
+            dpcSave(arena.dpc, dev.dpc_map_path);
+            std::cout << "坏点标定完成: " << arena.dpc.defects.size() << " 个坏点" << std::endl;
+        }
+        // 增强模式先校正坏点、残余非均匀性再做时域降噪(原始分辨率), 避免边缘算子把坏点放大成十字、
+        // 把条纹当成边缘, 以及锐化算法放大传感器时域噪声
+        if (ctx.current_algorithm >= 1 && ctx.current_algorithm <= 4) {
+            StageScope stage(arena.stats, STAGE_PREPROCESS);
+            dpcCorrect(arena.dpc, frame);
+            sceneBasedNuc(arena.nuc, frame, frame);
+            temporalDenoise(arena.tnr, frame, frame);
         }
-        else if((ctx.current_algorithm == 3)){
-            processed_frame = kirsch(frame);
+
+        // 热点检测: 阈值按白热灰度标定, 暂用灰度作为相对温度(不依赖 arena.temp 是否可用)
+        if (ctx.hotspots != NULL) {
+            TRACE_SCOPE("hotspot");
+            cv::Mat gray;
+            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+            hotspotUpdate(arena.hotspot, gray);
+            for (size_t i = 0; i < arena.hotspot.events.size(); i++) {
+                hotspot_events[arena.hotspot.events[i].type == HOTSPOT_APPEAR ? 0 : 1]++;
+            }
+        }
+        // 热点事件只计数, 按秒汇总打印, 避免逐事件同步写 stdout 拖慢循环
+        if (verbose && dq_ns - hotspot_log_ns >= 1000000000LL) {
+            if (hotspot_events[0] > 0 || hotspot_events[1] > 0) {
+                std::cout << "热点: 出现 " << hotspot_events[0] << " 消失 " << hotspot_events[1] << ", 当前 "
+                          << arena.hotspot.tracks.size() << " 个" << std::endl;
+            }
+            hotspot_events[0] = hotspot_events[1] = 0;
+            hotspot_log_ns = dq_ns;
         }
-        else if((ctx.current_algorithm == 4)){
-            processed_frame = frei_Chen(frame);
+
+        // 应用当前选择的算法
+        cv::Mat processed_frame;
+        // 放大到显示尺寸, 2 倍时用边缘导向放大(原 cv::resize 把 INTER_AREA 传成了 fx 参数, 实际为双线性)
+        {
+            StageScope stage(arena.stats, STAGE_UPSCALE);
+            if (tuning->display_factor == 2) {
+                upscale2x(frame, frame, arena.upscale_mode);
+            }
+            else if (tuning->display_factor != 1) {
+                cv::resize(frame, frame, cv::Size(), tuning->display_factor, tuning->display_factor,
+                           cv::INTER_LINEAR);
+            }
         }
-        else{
-            processed_frame = noEnhancement(frame);
-//                       processed_frame = kirsch(frame);
+
+        {
+            StageScope stage(arena.stats, STAGE_ALGORITHM);
+            processed_frame = applyAlgorithm(ctx.current_algorithm, frame, arena, ctx.palette, *tuning);
         }
 
 
+        // 保存不含 UI 的输出, FFC 期间重复显示
+        processed_frame.copyTo(arena.ffc.last_output);
             // 显示带UI的帧
-        showFrameWithUI(processed_frame, ctx);
+        if (ctx.hud != NULL) {
+            hudUpdate(arena.hud, arena.stats, traceNowNs());
+        }
+        if (!headless) {
+            StageScope stage(arena.stats, STAGE_DISPLAY);
+            showFrameWithUI(processed_frame, ctx);
+        }
 
         // 重新入队缓冲区
-        if (ioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+        int q;
+        {
+            TRACE_SCOPE("qbuf");
+            q = ioctl(fd, VIDIOC_QBUF, &buf);
+        }
+        if (q < 0) {
             perror("缓冲区重新入队失败");
             break;
         }
@@ -1136,11 +1301,30 @@ int main() {
         }
 
         // 检查退出键
-        if (cv::waitKey(1) == 'q') {
+        int key = -1;
+        if (!headless) {
+            TRACE_SCOPE("waitKey");
+            key = cv::waitKey(1);
+        }
+        // HighGUI 在 waitKey 中才真正绘制窗口, 以其返回作为呈现时刻
+        if (!latency_path.empty()) {
+            latencyRecord(latency, arena.stats, algorithmName(ctx.current_algorithm), req.count,
+                          capture_ns, traceNowNs());
+        }
+        if (key == 'q' || g_stop_requested) {
             break;
         }
+        handleKey(key, ctx, arena);
     }
 
+    if (!latency_path.empty()) {
+        latencyReport(latency, latency_path);
+    }
+
+    telemetryStop(telemetry);
+    cmdExecStop(exec);
+    controlClose(control);
+
     // 停止视频流
     type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     ioctl(fd, VIDIOC_STREAMOFF, &type);
@@ -0,0 +1,210 @@
+#include "scenegen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+void sceneGenReset(SceneGen& gen)
+{
+    const SceneParams& p = gen.params;
+    const int w = p.size.width, h = p.size.height;
+    CV_Assert(w > 0 && h > 0 && p.agc_high > p.agc_low);
+    cv::RNG rng(p.seed);
+
+    // 固定图案噪声: 逐像素 + 列条纹
+    gen.fpn.create(h, w, CV_16SC1);
+    std::vector<float> column(w);
+    for (int x = 0; x < w; x++) {
+        column[x] = (float)rng.gaussian(p.column_fpn_sigma);
+    }
+    for (int y = 0; y < h; y++) {
+        short* f = gen.fpn.ptr<short>(y);
+        for (int x = 0; x < w; x++) {
+            f[x] = (short)cvRound(column[x] + rng.gaussian(p.fpn_sigma));
+        }
+    }
+
+    // 背景沿 gradient_angle 方向从 background_low 线性升到 background_high
+    double a = p.gradient_angle * CV_PI / 180;
+    double c = cos(a), s = sin(a);
+    double half = std::max(std::abs(c) * (w - 1) + std::abs(s) * (h - 1), 1.0) / 2;
+    double range = p.background_high - p.background_low;
+    gen.base.create(h, w, CV_16SC1);
+    for (int y = 0; y < h; y++) {
+        const short* f = gen.fpn.ptr<short>(y);
+        short* b = gen.base.ptr<short>(y);
+        for (int x = 0; x < w; x++) {
+            double t = ((x - (w - 1) * 0.5) * c + (y - (h - 1) * 0.5) * s) / half;
+            int v = cvRound(p.background_low + (t + 1) * 0.5 * range) + f[x];
+            b[x] = (short)std::max(0, std::min(kSceneMaxValue, v));
+        }
+    }
+
+    // 时域噪声表, 每帧每行从随机位置连续取 w 项
+    gen.noise.resize(kSceneNoiseTable + w);
+    for (size_t i = 0; i < gen.noise.size(); i++) {
+        gen.noise[i] = (int16_t)cvRound(rng.gaussian(p.temporal_sigma));
+    }
+
+    // 坏点位置不重复
+    int num = cvRound(p.dead_ratio * w * h);
+    std::vector<uchar> used(w * h, 0);
+    gen.dead.clear();
+    while ((int)gen.dead.size() < std::min(num, w * h)) {
+        int idx = rng.uniform(0, w * h);
+        if (!used[idx]) {
+            used[idx] = 1;
+            gen.dead.push_back(idx);
+        }
+    }
+
+    gen.agc_lut.resize(kSceneMaxValue + 1);
+    for (int v = 0; v <= kSceneMaxValue; v++) {
+        int y8 = (v - p.agc_low) * 255 / (p.agc_high - p.agc_low);
+        gen.agc_lut[v] = (uchar)std::max(0, std::min(255, y8));
+    }
+    gen.frame = 0;
+    gen.built = true;
+}
+
+bool sceneGenIsShutter(const SceneGen& gen, int64_t index)
+{
+    const SceneParams& p = gen.params;
+    return p.shutter_interval > 0 && index >= p.shutter_interval && index % p.shutter_interval < p.shutter_frames;
+}
+
+// 匀速运动并在 [r, n-1-r] 内反弹
+static float sceneBounce(float p0, float v, float r, int n, int64_t index)
+{
+    float len = n - 1 - 2 * r;
+    if (len <= 0) {
+        return (n - 1) * 0.5f;
+    }
+    double m = fmod(p0 - r + (double)v * index, 2.0 * len);
+    if (m < 0) {
+        m += 2 * len;
+    }
+    if (m > len) {
+        m = 2 * len - m;
+    }
+    return (float)(r + m);
+}
+
+static inline ushort sceneClamp(int v)
+{
+    return (ushort)std::max(0, std::min(kSceneMaxValue, v));
+}
+
+// 生成 Y14 帧; dst 需已分配为 CV_16UC1
+static void sceneRenderY14(SceneGen& gen, int64_t index, cv::Mat& dst)
+{
+    const SceneParams& p = gen.params;
+    const int w = p.size.width, h = p.size.height;
+    // 每帧的噪声位置只由种子和帧序号决定
+    cv::RNG rng(p.seed ^ ((uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL));
+    std::vector<int> offset(h);
+    for (int y = 0; y < h; y++) {
+        offset[y] = (int)(rng.next() % kSceneNoiseTable);
+    }
+
+    gen.shutter = sceneGenIsShutter(gen, index);
+    for (int y = 0; y < h; y++) {
+        const int16_t* n = &gen.noise[offset[y]];
+        ushort* d = dst.ptr<ushort>(y);
+        if (gen.shutter) {
+            const short* f = gen.fpn.ptr<short>(y);
+            for (int x = 0; x < w; x++) {
+                d[x] = sceneClamp(p.shutter_value + f[x] + n[x]);
+            }
+        }
+        else {
+            const short* b = gen.base.ptr<short>(y);
+            for (int x = 0; x < w; x++) {
+                d[x] = sceneClamp(b[x] + n[x]);
+            }
+        }
+    }
+
+    // 目标按行覆盖, 叠加同样的固定图案噪声和时域噪声
+    for (size_t i = 0; !gen.shutter && i < p.objects.size(); i++) {
+        const SceneObject& o = p.objects[i];
+        float cx = sceneBounce(o.pos.x, o.velocity.x, o.radius, w, index);
+        float cy = sceneBounce(o.pos.y, o.velocity.y, o.radius, h, index);
+        int y0 = std::max(0, (int)ceil(cy - o.radius)), y1 = std::min(h - 1, (int)floor(cy + o.radius));
+        for (int y = y0; y <= y1; y++) {
+            float dy = y - cy;
+            float dx = sqrtf(std::max(o.radius * o.radius - dy * dy, 0.f));
+            int x0 = std::max(0, (int)ceil(cx - dx)), x1 = std::min(w - 1, (int)floor(cx + dx));
+            const int16_t* n = &gen.noise[offset[y]];
+            const short* f = gen.fpn.ptr<short>(y);
+            ushort* d = dst.ptr<ushort>(y);
+            for (int x = x0; x <= x1; x++) {
+                d[x] = sceneClamp(o.value + f[x] + n[x]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < gen.dead.size(); i++) {
+        int idx = gen.dead[i];
+        dst.ptr<ushort>(idx / w)[idx % w] = (i & 1) ? kSceneMaxValue : 0;
+    }
+}
+
+void sceneGenRender(SceneGen& gen, int64_t index, int format, cv::Mat& dst)
+{
+    if (!gen.built) {
+        sceneGenReset(gen);
+    }
+    const SceneParams& p = gen.params;
+    const int w = p.size.width, h = p.size.height;
+    if (format == SCENE_Y14) {
+        dst.create(h, w, CV_16UC1);
+        sceneRenderY14(gen, index, dst);
+        return;
+    }
+    gen.y14.create(h, w, CV_16UC1);
+    sceneRenderY14(gen, index, gen.y14);
+    if (format == SCENE_Y16) {
+        dst.create(h, w, CV_16UC1);
+        for (int y = 0; y < h; y++) {
+            const ushort* s = gen.y14.ptr<ushort>(y);
+            ushort* d = dst.ptr<ushort>(y);
+            for (int x = 0; x < w; x++) {
+                d[x] = (ushort)(s[x] << 2);
+            }
+        }
+        return;
+    }
+    CV_Assert(format == SCENE_YUYV);
+    dst.create(h + p.info_lines, w, CV_8UC2);
+    const uchar* lut = &gen.agc_lut[0];
+    for (int y = 0; y < h; y++) {
+        const ushort* s = gen.y14.ptr<ushort>(y);
+        uchar* d = dst.ptr<uchar>(y);
+        for (int x = 0; x < w; x++) {
+            d[x * 2] = lut[s[x]];
+            d[x * 2 + 1] = 128;
+        }
+    }
+    for (int y = h; y < h + p.info_lines; y++) {
+        memset(dst.ptr<uchar>(y), 0, (size_t)w * 2);
+    }
+}
+
+void sceneGenNext(SceneGen& gen, int format, cv::Mat& dst)
+{
+    if (!gen.built) {
+        sceneGenReset(gen);
+    }
+    sceneGenRender(gen, gen.frame++, format, dst);
+}
+
+void sceneGenYuyv(SceneGen& gen, int64_t index, uint8_t* data, int len)
+{
+    const SceneParams& p = gen.params;
+    if (len < p.size.width * (p.size.height + p.info_lines) * 2) {
+        return;
+    }
+    cv::Mat dst(p.size.height + p.info_lines, p.size.width, CV_8UC2, data);
+    sceneGenRender(gen, index, SCENE_YUYV, dst);
+}
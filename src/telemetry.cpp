@@ -0,0 +1,284 @@
+#include "telemetry.h"
+#include "libircmd_temp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+static int64_t telemNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static IrlibError_e telemReadDeviceTemp(IrcmdHandle_t* handle, int, CmdResult& result)
+{
+    return basic_device_temp_get(handle, &result.temperature);
+}
+
+static IrlibError_e telemReadPoweredTime(IrcmdHandle_t* handle, int, CmdResult& result)
+{
+    return adv_powered_time_get(handle, &result.value);
+}
+
+static IrlibError_e telemReadRealtimeStatus(IrcmdHandle_t* handle, int status_type, CmdResult& result)
+{
+    return adv_device_realtime_status_get(handle, status_type, &result.data);
+}
+
+static IrlibError_e telemReadFrameTemp(IrcmdHandle_t* handle, int, CmdResult& result)
+{
+    return basic_frame_temp_info_get(handle, &result.frame_temp);
+}
+
+static IrlibError_e telemReadShutter(IrcmdHandle_t* handle, int, CmdResult& result)
+{
+    return adv_shutter_status_get(handle, &result.value);
+}
+
+const TelemetryReader kTelemetryReaders[TELEM_NUM] = {
+    telemReadDeviceTemp,
+    telemReadPoweredTime,
+    telemReadRealtimeStatus,
+    telemReadFrameTemp,
+    telemReadShutter,
+};
+
+TelemetryState::TelemetryState() :
+    readers(kTelemetryReaders),
+    exec(NULL),
+    ffc(NULL),
+    running(false),
+    in_flight(false),
+    rng(20250601),
+    budget_ns(0),
+    budget_ns_at(0),
+    read_cost_ns(0),
+    ffc_ns(0),
+    start_ns(0),
+    busy_ns(0)
+{
+    memset(history_head, 0, sizeof(history_head));
+    snapshot = TelemetrySnapshot();
+    for (int m = 0; m < TELEM_NUM; m++) {
+        next_due[m] = 0;
+    }
+}
+
+TelemetryState::~TelemetryState()
+{
+    telemetryStop(*this);
+}
+
+static int64_t telemJitterNs(TelemetryState& state)
+{
+    int jitter = state.params.jitter_ms;
+    return jitter > 0 ? (int64_t)state.rng.uniform(-jitter, jitter + 1) * 1000000 : 0;
+}
+
+// 在执行器线程中连续读取本次到期的指标
+static IrlibError_e telemBurst(TelemetryState& state, IrcmdHandle_t* handle, int mask)
+{
+    TelemetrySample samples[TELEM_NUM];
+    IrlibError_e errors[TELEM_NUM];
+    int64_t start = telemNowNs();
+    int reads = 0;
+    for (int m = 0; m < TELEM_NUM; m++) {
+        if (mask & (1 << m)) {
+            reads++;
+            errors[m] = state.readers[m](handle, state.params.realtime_status_type, samples[m].result);
+            samples[m].result.error = errors[m];
+            samples[m].t_ns = telemNowNs();
+        }
+    }
+    int64_t busy = telemNowNs() - start;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.busy_ns += busy;
+    state.budget_ns -= busy;
+    int64_t cost = busy / std::max(reads, 1);
+    state.read_cost_ns = state.read_cost_ns > 0 ? (state.read_cost_ns * 3 + cost) / 4 : cost;
+    for (int m = 0; m < TELEM_NUM; m++) {
+        if (!(mask & (1 << m))) {
+            continue;
+        }
+        if (errors[m] != IRLIB_SUCCESS) {
+            state.snapshot.errors[m]++;
+            continue;
+        }
+        state.history[m][state.history_head[m] % kTelemetryHistory] = samples[m];
+        state.history_head[m]++;
+        state.snapshot.latest[m] = samples[m];
+        state.snapshot.valid[m] = true;
+        state.snapshot.samples[m]++;
+    }
+    // 快门闭合即 FFC 进行中: 同步给 FFC 检测, 并暂停其他指标的轮询
+    if ((mask & (1 << TELEM_SHUTTER)) && errors[TELEM_SHUTTER] == IRLIB_SUCCESS) {
+        int status = samples[TELEM_SHUTTER].result.value;
+        if (state.ffc != NULL) {
+            ffcGuardSetShutter(*state.ffc, status);
+        }
+        if (status == ADV_SHUTTER_CLOSE_STA) {
+            state.ffc_ns = samples[TELEM_SHUTTER].t_ns;
+        }
+    }
+    return IRLIB_SUCCESS;
+}
+
+// 选出本次要读取的指标, 并推进其到期时间; 返回 0 表示需要等待到 wake_ns
+static int telemSchedule(TelemetryState& state, int64_t now, int64_t& wake_ns)
+{
+    const TelemetryParams& p = state.params;
+    const int64_t window = (int64_t)p.burst_window_ms * 1000000;
+    int64_t ffc_ns = state.ffc_ns.load();
+    int64_t holdoff_end = ffc_ns != 0 ? ffc_ns + (int64_t)p.ffc_holdoff_ms * 1000000 : 0;
+
+    // 令牌桶: 按占用上限补充, 最多积累 1 秒的额度
+    state.budget_ns += (int64_t)((now - state.budget_ns_at) * (double)p.max_occupancy);
+    state.budget_ns = std::min(state.budget_ns, (int64_t)(1e9 * p.max_occupancy));
+    state.budget_ns_at = now;
+
+    int mask = 0;
+    wake_ns = now + 1000000000;
+    for (int m = 0; m < TELEM_NUM; m++) {
+        if (p.period_ms[m] <= 0) {
+            continue;
+        }
+        int64_t due = state.next_due[m];
+        // FFC 期间只轮询快门状态
+        if (m != TELEM_SHUTTER && now < holdoff_end && due <= holdoff_end) {
+            state.next_due[m] = holdoff_end + std::abs(telemJitterNs(state));
+            state.snapshot.deferred++;
+            due = state.next_due[m];
+        }
+        if (due <= now + window) {
+            mask |= 1 << m;
+        }
+        else {
+            wake_ns = std::min(wake_ns, due);
+        }
+    }
+    if (mask == 0) {
+        return 0;
+    }
+    // 额度不足以完成本次读取: 全部推迟到额度恢复
+    int reads = 0;
+    for (int m = 0; m < TELEM_NUM; m++) {
+        reads += (mask >> m) & 1;
+    }
+    int64_t need = reads * state.read_cost_ns;
+    if (state.budget_ns < need) {
+        int64_t wait = (int64_t)((need - state.budget_ns) / std::max(p.max_occupancy, 1e-3f));
+        for (int m = 0; m < TELEM_NUM; m++) {
+            if (mask & (1 << m)) {
+                state.next_due[m] = std::max(state.next_due[m], now + wait);
+            }
+        }
+        state.snapshot.deferred++;
+        wake_ns = now + wait;
+        return 0;
+    }
+    for (int m = 0; m < TELEM_NUM; m++) {
+        if (mask & (1 << m)) {
+            int64_t period = (int64_t)p.period_ms[m] * 1000000;
+            // 落后超过一个周期时从当前时间重新计, 不补读
+            int64_t base = state.next_due[m] + period < now ? now : state.next_due[m];
+            state.next_due[m] = base + period + telemJitterNs(state);
+        }
+    }
+    return mask;
+}
+
+static void telemWorker(TelemetryState* state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (state->running) {
+        if (state->in_flight) {
+            state->cond.wait(lock);
+            continue;
+        }
+        int64_t now = telemNowNs();
+        int64_t wake_ns;
+        int mask = telemSchedule(*state, now, wake_ns);
+        if (mask == 0) {
+            state->cond.wait_for(lock, std::chrono::nanoseconds(std::max(wake_ns - now, (int64_t)1000000)));
+            continue;
+        }
+        state->in_flight = true;
+        state->snapshot.bursts++;
+        lock.unlock();
+
+        bool ok = cmdExecSubmit(*state->exec, CMD_PRIORITY_READ, CMD_KEY_NONE, false,
+            [state, mask](IrcmdHandle_t* handle, CmdResult&) { return telemBurst(*state, handle, mask); },
+            [state](const CmdResult&) {
+                std::lock_guard<std::mutex> guard(state->mutex);
+                state->in_flight = false;
+                state->cond.notify_all();
+            });
+
+        lock.lock();
+        if (!ok) {
+            state->in_flight = false;
+            // 执行器队列满或已停止, 稍后重试
+            state->cond.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+}
+
+void telemetryStart(TelemetryState& state, CmdExecutor* exec)
+{
+    CV_Assert(!state.running && exec != NULL);
+    state.exec = exec;
+    state.start_ns = telemNowNs();
+    state.budget_ns_at = state.start_ns;
+    state.budget_ns = 0;
+    // 初次读取错开, 避免所有指标同时到期
+    for (int m = 0; m < TELEM_NUM; m++) {
+        state.next_due[m] = state.start_ns + std::abs(telemJitterNs(state));
+    }
+    state.running = true;
+    state.worker = std::thread(telemWorker, &state);
+}
+
+void telemetryStop(TelemetryState& state)
+{
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.running) {
+            return;
+        }
+        state.running = false;
+    }
+    state.cond.notify_all();
+    state.worker.join();
+    // 等待已提交的读取完成, 之后执行器不再引用 state
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cond.wait(lock, [&state]() { return !state.in_flight; });
+}
+
+void telemetryNotifyFfc(TelemetryState& state)
+{
+    state.ffc_ns = telemNowNs();
+}
+
+void telemetrySnapshot(TelemetryState& state, TelemetrySnapshot& snapshot)
+{
+    double channel = state.exec != NULL ? cmdExecOccupancy(*state.exec) : 0.0;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    snapshot = state.snapshot;
+    int64_t elapsed = telemNowNs() - state.start_ns;
+    snapshot.occupancy = elapsed > 0 ? (double)state.busy_ns / elapsed : 0.0;
+    snapshot.channel_occupancy = channel;
+}
+
+void telemetryHistory(TelemetryState& state, int metric, std::vector<TelemetrySample>& samples)
+{
+    CV_Assert(metric >= 0 && metric < TELEM_NUM);
+    std::lock_guard<std::mutex> lock(state.mutex);
+    int head = state.history_head[metric];
+    int num = std::min(head, kTelemetryHistory);
+    samples.resize(num);
+    for (int i = 0; i < num; i++) {
+        samples[i] = state.history[metric][(head - num + i) % kTelemetryHistory];
+    }
+}
@@ -0,0 +1,165 @@
+#include "tempmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+void tempMapSetNucTable(TempMapState& state, const uint16_t* table, int len)
+{
+    CV_Assert(table != NULL && len > 0);
+    state.nuc_table.assign(table, table + len);
+    state.table_dirty = true;
+}
+
+bool tempMapLoadNucTable(TempMapState& state, const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    uint8_t bytes[NUC_T_SIZE * 2];
+    if (!file.read((char*)bytes, sizeof(bytes)) || file.peek() != EOF) {
+        std::cerr << "NUC_T 表长度错误(应为 " << NUC_T_SIZE << " 个 uint16): " << path << std::endl;
+        return false;
+    }
+    std::vector<uint16_t> table(NUC_T_SIZE);
+    for (int i = 0; i < NUC_T_SIZE; i++) {
+        table[i] = (uint16_t)(bytes[2 * i] | bytes[2 * i + 1] << 8);
+    }
+    tempMapSetNucTable(state, &table[0], NUC_T_SIZE);
+    return true;
+}
+
+static bool sameEnv(const EnvParam_t& a, const EnvParam_t& b)
+{
+    return a.EMS == b.EMS && a.TAU == b.TAU && a.Ta == b.Ta && a.Tu == b.Tu;
+}
+
+static uint16_t celsiusToK16(float celsius)
+{
+    return cv::saturate_cast<uint16_t>(cvRound((celsius + 273.15) * 16));
+}
+
+bool tempMapUpdate(TempMapState& state)
+{
+    if (state.nuc_table.empty()) {
+        return false;
+    }
+    const TempMapParams& p = state.params;
+    const TempMapParams& b = state.built_params;
+    const uint16_t* table = &state.nuc_table[0];
+
+    // K_E/B_E 只依赖 NUC_T 表与 EnvParam_t/增益; 先算, 失败时不修改任何查找表
+    bool rebuild_remap = !state.built || state.table_dirty;
+    bool rebuild_env = rebuild_remap;
+    if (rebuild_remap || !sameEnv(p.env, b.env) || p.gain != b.gain) {
+        EnvFactor_t factor;
+        if (calculate_new_KE_and_BE_with_nuc_t(&p.env, table, p.gain, &factor) != IRLIB_SUCCESS) {
+            return false;
+        }
+        // 参数变化但系数不变(如取整后相同)时无需重建
+        rebuild_env |= factor.K_E != state.env_factor.K_E || factor.B_E != state.env_factor.B_E;
+        state.env_factor = factor;
+    }
+
+    // NUC_T 表范围外的值取相邻有效值
+    if (rebuild_remap) {
+        state.remap.resize(kTempMapSize);
+        for (int n = 0; n < kTempMapSize; n++) {
+            uint16_t t;
+            if (remap_temp(table, (uint16_t)n, &t) != IRLIB_SUCCESS) {
+                t = n > 0 ? state.remap[n - 1] : 0;
+            }
+            state.remap[n] = t;
+        }
+        state.builds[0]++;
+    }
+    if (rebuild_env) {
+        state.lut_env.resize(kTempMapSize);
+        for (int n = 0; n < kTempMapSize; n++) {
+            uint16_t cal;
+            if (recalc_NUC_with_env_correct(&state.env_factor, (uint16_t)n, &cal) != IRLIB_SUCCESS) {
+                cal = (uint16_t)n;
+            }
+            state.lut_env[n] = state.remap[std::min((int)cal, kTempMapSize - 1)];
+        }
+        state.builds[1]++;
+    }
+
+    bool rebuild_correct = rebuild_env || p.correct != b.correct ||
+        (p.correct && (p.ems != b.ems || p.tau != b.tau || p.ta != b.ta));
+    if (rebuild_correct) {
+        state.lut.resize(kTempMapSize);
+        state.lut_celsius.resize(kTempMapSize);
+        // 相邻 NUC 值通常换算为相同温度, 每段相同温度只调用一次 temp_correct
+        int prev = -1;
+        float celsius = 0;
+        uint16_t k16 = 0;
+        for (int n = 0; n < kTempMapSize; n++) {
+            if (state.lut_env[n] != prev) {
+                prev = state.lut_env[n];
+                celsius = prev / 16.0f - 273.15f;
+                k16 = (uint16_t)prev;
+                float corrected;
+                if (p.correct && temp_correct(p.ems, p.tau, p.ta, celsius, &corrected) == IRLIB_SUCCESS) {
+                    celsius = corrected;
+                    k16 = celsiusToK16(corrected);
+                }
+            }
+            state.lut[n] = k16;
+            state.lut_celsius[n] = celsius;
+        }
+        state.builds[2]++;
+    }
+
+    state.built_params = p;
+    state.table_dirty = false;
+    state.built = true;
+    return true;
+}
+
+bool tempMapApply(TempMapState& state, const cv::Mat& nuc, cv::Mat& dst, int depth)
+{
+    CV_Assert(nuc.type() == CV_16UC1 && (depth == CV_16U || depth == CV_32F));
+    // 重建失败时沿用原查找表; 还没有可用的查找表(NUC_T 表为空或首次计算失败)时不输出
+    if (!tempMapUpdate(state) && !state.built) {
+        return false;
+    }
+    cv::Mat in = nuc;
+    dst.create(in.size(), CV_MAKETYPE(depth, 1));
+    const unsigned* lut = &state.lut[0];
+    const float* lutf = &state.lut_celsius[0];
+
+    for (int y = 0; y < in.rows; y++) {
+        const ushort* src = in.ptr<ushort>(y);
+        int x = 0;
+#if CV_SIMD128
+        const cv::v_uint16x8 v_mask = cv::v_setall_u16(kTempMapSize - 1);
+        for (; x <= in.cols - 8; x += 8) {
+            cv::v_uint32x4 i0, i1;
+            cv::v_expand(cv::v_min(cv::v_load(src + x), v_mask), i0, i1);
+            if (depth == CV_16U) {
+                cv::v_uint32x4 t0 = cv::v_lut(lut, cv::v_reinterpret_as_s32(i0));
+                cv::v_uint32x4 t1 = cv::v_lut(lut, cv::v_reinterpret_as_s32(i1));
+                cv::v_store(dst.ptr<ushort>(y) + x, cv::v_pack(t0, t1));
+            }
+            else {
+                cv::v_store(dst.ptr<float>(y) + x, cv::v_lut(lutf, cv::v_reinterpret_as_s32(i0)));
+                cv::v_store(dst.ptr<float>(y) + x + 4, cv::v_lut(lutf, cv::v_reinterpret_as_s32(i1)));
+            }
+        }
+#endif
+        for (; x < in.cols; x++) {
+            int n = std::min((int)src[x], kTempMapSize - 1);
+            if (depth == CV_16U) {
+                dst.ptr<ushort>(y)[x] = (ushort)lut[n];
+            }
+            else {
+                dst.ptr<float>(y)[x] = lutf[n];
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,258 @@
+#include "tempstats.h"
+
+#include <algorithm>
+#include <string.h>
+
+static const int kTempBandRows = 32;    // 并行统计的行带高度
+
+// 单个 ROI 的统计累加器
+struct TempAcc {
+    ushort max_temp;
+    ushort min_temp;
+    int max_x, max_y;
+    int min_x, min_y;
+    uint64_t sum;
+    uint32_t count;
+};
+
+void tempStatsSetSize(TempStatsEngine& engine, int width, int height)
+{
+    CV_Assert(width > 0 && height > 0);
+    engine.width = width;
+    engine.height = height;
+    engine.rois.clear();
+    engine.results.clear();
+    engine.dirty = true;
+}
+
+static bool tempInFrame(const TempStatsEngine& engine, int x, int y)
+{
+    return x >= 0 && x < engine.width && y >= 0 && y < engine.height;
+}
+
+static int tempAddRoi(TempStatsEngine& engine, const TempRoi& roi)
+{
+    engine.rois.push_back(roi);
+    engine.dirty = true;
+    return (int)engine.rois.size() - 1;
+}
+
+int tempStatsAddPoint(TempStatsEngine& engine, Dot_t point)
+{
+    if (!tempInFrame(engine, point.x, point.y)) {
+        return -1;
+    }
+    TempRoi roi = TempRoi();
+    roi.type = TEMP_ROI_POINT;
+    roi.point = point;
+    return tempAddRoi(engine, roi);
+}
+
+int tempStatsAddLine(TempStatsEngine& engine, Line_t line)
+{
+    if (!tempInFrame(engine, line.start_x, line.start_y) || !tempInFrame(engine, line.end_x, line.end_y)) {
+        return -1;
+    }
+    TempRoi roi = TempRoi();
+    roi.type = TEMP_ROI_LINE;
+    roi.line = line;
+    return tempAddRoi(engine, roi);
+}
+
+int tempStatsAddRect(TempStatsEngine& engine, Area_t rect)
+{
+    if (rect.width <= 0 || rect.height <= 0 || !tempInFrame(engine, rect.start_x, rect.start_y) ||
+        !tempInFrame(engine, rect.start_x + rect.width - 1, rect.start_y + rect.height - 1)) {
+        return -1;
+    }
+    TempRoi roi = TempRoi();
+    roi.type = TEMP_ROI_RECT;
+    roi.rect = rect;
+    return tempAddRoi(engine, roi);
+}
+
+static bool tempSpanLess(const TempSpan& a, const TempSpan& b)
+{
+    return a.x0 < b.x0;
+}
+
+// ROI 编译为按行排序的区间表; 线段按 Bresenham 光栅化(含两端点), 每行上的像素是连续的一段
+static void tempCompile(TempStatsEngine& engine)
+{
+    std::vector<std::vector<TempSpan> > rows(engine.height);
+    for (size_t i = 0; i < engine.rois.size(); i++) {
+        const TempRoi& roi = engine.rois[i];
+        TempSpan span;
+        span.roi = (int)i;
+        if (roi.type == TEMP_ROI_POINT) {
+            span.x0 = span.x1 = roi.point.x;
+            rows[roi.point.y].push_back(span);
+        }
+        else if (roi.type == TEMP_ROI_RECT) {
+            span.x0 = roi.rect.start_x;
+            span.x1 = roi.rect.start_x + roi.rect.width - 1;
+            for (int y = roi.rect.start_y; y < roi.rect.start_y + roi.rect.height; y++) {
+                rows[y].push_back(span);
+            }
+        }
+        else {
+            int x = roi.line.start_x, y = roi.line.start_y;
+            const int dx = std::abs(roi.line.end_x - x), sx = x < roi.line.end_x ? 1 : -1;
+            const int dy = -std::abs(roi.line.end_y - y), sy = y < roi.line.end_y ? 1 : -1;
+            int err = dx + dy;
+            span.x0 = span.x1 = x;
+            while (true) {
+                if (x == roi.line.end_x && y == roi.line.end_y) {
+                    break;
+                }
+                int e2 = 2 * err;
+                int ny = y;
+                if (e2 >= dy) {
+                    err += dy;
+                    x += sx;
+                }
+                if (e2 <= dx) {
+                    err += dx;
+                    ny += sy;
+                }
+                if (ny != y) {
+                    rows[y].push_back(span);
+                    y = ny;
+                    span.x0 = span.x1 = x;
+                }
+                else {
+                    span.x0 = std::min(span.x0, x);
+                    span.x1 = std::max(span.x1, x);
+                }
+            }
+            rows[y].push_back(span);
+        }
+    }
+
+    engine.spans.clear();
+    engine.row_start.assign(engine.height + 1, 0);
+    for (int y = 0; y < engine.height; y++) {
+        // 同一行按 x 排序, 访存顺序与行内地址一致
+        std::stable_sort(rows[y].begin(), rows[y].end(), tempSpanLess);
+        engine.row_start[y] = (int)engine.spans.size();
+        engine.spans.insert(engine.spans.end(), rows[y].begin(), rows[y].end());
+    }
+    engine.row_start[engine.height] = (int)engine.spans.size();
+    engine.results.resize(engine.rois.size());
+    engine.dirty = false;
+}
+
+// 一段连续像素的最小/最大/和
+static void tempSpanStats(const ushort* p, int n, ushort& min_temp, ushort& max_temp, uint64_t& sum)
+{
+    int x = 0;
+    unsigned mn = 0xFFFF, mx = 0;
+    uint64_t s = 0;
+#if CV_SIMD128
+    if (n >= 8) {
+        cv::v_uint16x8 v_min = cv::v_setall_u16(0xFFFF), v_max = cv::v_setzero_u16();
+        cv::v_uint32x4 v_sum = cv::v_setzero_u32();
+        for (; x <= n - 8; x += 8) {
+            cv::v_uint16x8 v = cv::v_load(p + x);
+            v_min = cv::v_min(v_min, v);
+            v_max = cv::v_max(v_max, v);
+            cv::v_uint32x4 lo, hi;
+            cv::v_expand(v, lo, hi);
+            v_sum += lo + hi;
+        }
+        mn = cv::v_reduce_min(v_min);
+        mx = cv::v_reduce_max(v_max);
+        s = cv::v_reduce_sum(v_sum);
+    }
+#endif
+    for (; x < n; x++) {
+        mn = std::min(mn, (unsigned)p[x]);
+        mx = std::max(mx, (unsigned)p[x]);
+        s += p[x];
+    }
+    min_temp = (ushort)mn;
+    max_temp = (ushort)mx;
+    sum = s;
+}
+
+// 行带内统计, 最值取行优先顺序下第一次出现的位置
+static void tempStatsRows(const TempStatsEngine& engine, const cv::Mat& temp, int y0, int y1, TempAcc* acc)
+{
+    for (int y = y0; y < y1; y++) {
+        const ushort* row = temp.ptr<ushort>(y);
+        for (int i = engine.row_start[y]; i < engine.row_start[y + 1]; i++) {
+            const TempSpan& span = engine.spans[i];
+            const int n = span.x1 - span.x0 + 1;
+            ushort mn, mx;
+            uint64_t sum;
+            tempSpanStats(row + span.x0, n, mn, mx, sum);
+            TempAcc& a = acc[span.roi];
+            // 只有刷新最值时才在区间内定位坐标
+            if (a.count == 0 || mx > a.max_temp) {
+                a.max_temp = mx;
+                a.max_x = (int)(std::find(row + span.x0, row + span.x1 + 1, mx) - row);
+                a.max_y = y;
+            }
+            if (a.count == 0 || mn < a.min_temp) {
+                a.min_temp = mn;
+                a.min_x = (int)(std::find(row + span.x0, row + span.x1 + 1, mn) - row);
+                a.min_y = y;
+            }
+            a.sum += sum;
+            a.count += n;
+        }
+    }
+}
+
+void tempStatsCompute(TempStatsEngine& engine, const cv::Mat& temp)
+{
+    CV_Assert(temp.type() == CV_16UC1 && temp.cols == engine.width && temp.rows == engine.height);
+    if (engine.dirty) {
+        tempCompile(engine);
+    }
+    const int nroi = (int)engine.rois.size();
+    if (nroi == 0) {
+        return;
+    }
+
+    // 各行带独立累加, 再按行带顺序合并(保持第一次出现的最值坐标)
+    const int nbands = (engine.height + kTempBandRows - 1) / kTempBandRows;
+    std::vector<TempAcc> acc((size_t)nbands * nroi);
+    memset(&acc[0], 0, acc.size() * sizeof(TempAcc));
+    cv::parallel_for_(cv::Range(0, nbands), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; b++) {
+            int y0 = b * kTempBandRows, y1 = std::min(y0 + kTempBandRows, engine.height);
+            tempStatsRows(engine, temp, y0, y1, &acc[(size_t)b * nroi]);
+        }
+    });
+
+    for (int r = 0; r < nroi; r++) {
+        TempAcc total = TempAcc();
+        for (int b = 0; b < nbands; b++) {
+            const TempAcc& a = acc[(size_t)b * nroi + r];
+            if (a.count == 0) {
+                continue;
+            }
+            if (total.count == 0 || a.max_temp > total.max_temp) {
+                total.max_temp = a.max_temp;
+                total.max_x = a.max_x;
+                total.max_y = a.max_y;
+            }
+            if (total.count == 0 || a.min_temp < total.min_temp) {
+                total.min_temp = a.min_temp;
+                total.min_x = a.min_x;
+                total.min_y = a.min_y;
+            }
+            total.sum += a.sum;
+            total.count += a.count;
+        }
+        TempInfo_t& info = engine.results[r];
+        info.max_temp = total.max_temp;
+        info.min_temp = total.min_temp;
+        info.avr_temp = (uint16_t)(total.count ? total.sum / total.count : 0);
+        info.max_cord.x = total.max_x;
+        info.max_cord.y = total.max_y;
+        info.min_cord.x = total.min_x;
+        info.min_cord.y = total.min_y;
+    }
+}
@@ -0,0 +1,238 @@
+#include "trace.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_trace_enabled(false);
+
+static const int kTraceMaxBuffers = 32;     // 超过后复用已退出线程的缓冲
+
+/**
+* @brief 单个线程的事件环形缓冲, 只由所属线程写入
+*
+* 线程退出后缓冲仍保留在登记表中, 退出前记录的事件依然可以导出。
+*/
+struct TraceBuffer {
+    TraceEvent events[kTraceRingSize];
+    std::atomic<uint64_t> head;     ///< 已写入的事件总数
+    int tid;
+    const char* thread_name;
+    bool in_use;                    ///< 所属线程仍在运行
+
+    TraceBuffer() :
+        head(0),
+        tid(0),
+        thread_name(NULL),
+        in_use(true) {}
+};
+
+/**
+* @brief 线程局部状态, 线程退出时释放缓冲供复用
+*/
+struct TraceThread {
+    TraceBuffer* buffer;    ///< 第一次记录时才分配
+    const char* name;
+    int64_t frame;
+
+    TraceThread() :
+        buffer(NULL),
+        name(NULL),
+        frame(-1) {}
+    ~TraceThread();
+};
+
+static std::mutex g_trace_mutex;
+static std::vector<TraceBuffer*> g_trace_buffers;
+static std::atomic<int64_t> g_trace_epoch_ns(0);
+static std::string g_trace_signal_path;
+static std::string g_trace_exit_path;
+static volatile sig_atomic_t g_trace_signaled = 0;
+
+int64_t traceNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static thread_local TraceThread t_trace;
+
+TraceThread::~TraceThread()
+{
+    if (buffer != NULL) {
+        std::lock_guard<std::mutex> lock(g_trace_mutex);
+        buffer->in_use = false;
+    }
+}
+
+// 找一个已退出线程的缓冲; keep_events 时只取没有事件的
+static TraceBuffer* traceReuse(bool keep_events)
+{
+    for (size_t i = 0; i < g_trace_buffers.size(); i++) {
+        TraceBuffer* buffer = g_trace_buffers[i];
+        if (!buffer->in_use && (!keep_events || buffer->head == 0)) {
+            buffer->in_use = true;
+            buffer->head = 0;
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+// 当前线程的缓冲, 首次记录时分配并登记; 已退出线程的事件在缓冲数达到上限前保留
+static TraceBuffer& traceBuffer()
+{
+    TraceThread& t = t_trace;
+    if (t.buffer == NULL) {
+        std::lock_guard<std::mutex> lock(g_trace_mutex);
+        t.buffer = traceReuse(true);
+        if (t.buffer == NULL && (int)g_trace_buffers.size() >= kTraceMaxBuffers) {
+            t.buffer = traceReuse(false);
+        }
+        if (t.buffer == NULL) {
+            t.buffer = new TraceBuffer();
+            g_trace_buffers.push_back(t.buffer);
+            t.buffer->tid = (int)g_trace_buffers.size();
+        }
+        t.buffer->thread_name = t.name;
+    }
+    return *t.buffer;
+}
+
+void traceEnable(bool on)
+{
+    int64_t zero = 0;
+    g_trace_epoch_ns.compare_exchange_strong(zero, traceNowNs());
+    g_trace_enabled = on;
+}
+
+void traceClear()
+{
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    for (size_t i = 0; i < g_trace_buffers.size(); i++) {
+        g_trace_buffers[i]->head = 0;
+    }
+}
+
+void traceSetThreadName(const char* name)
+{
+    t_trace.name = name;
+    if (t_trace.buffer != NULL) {
+        t_trace.buffer->thread_name = name;
+    }
+}
+
+void traceFrame(int64_t frame)
+{
+    t_trace.frame = frame;
+}
+
+void traceRecord(const char* name, int64_t begin_ns, int64_t end_ns)
+{
+    TraceBuffer& buffer = traceBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer.events[head & (kTraceRingSize - 1)];
+    event.name = name;
+    event.begin_ns = begin_ns;
+    event.end_ns = end_ns;
+    event.frame = t_trace.frame;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// 复制一个缓冲中仍有效的事件, 复制期间被覆盖的丢弃
+static void traceSnapshot(const TraceBuffer& buffer, std::vector<TraceEvent>& events)
+{
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+    uint64_t first = head > (uint64_t)kTraceRingSize ? head - kTraceRingSize : 0;
+    events.clear();
+    for (uint64_t i = first; i < head; i++) {
+        events.push_back(buffer.events[i & (kTraceRingSize - 1)]);
+    }
+    uint64_t after = buffer.head.load(std::memory_order_acquire);
+    uint64_t valid = after > (uint64_t)kTraceRingSize ? after - kTraceRingSize : 0;
+    if (valid > first) {
+        events.erase(events.begin(), events.begin() + std::min((size_t)(valid - first), events.size()));
+    }
+}
+
+bool traceDump(const std::string& path)
+{
+    std::vector<TraceBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_trace_mutex);
+        buffers = g_trace_buffers;
+    }
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        std::cerr << "无法写入跟踪文件: " << path << std::endl;
+        return false;
+    }
+    int pid = (int)getpid();
+    int64_t epoch = g_trace_epoch_ns.load();
+    bool first = true;
+    std::vector<TraceEvent> events;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t b = 0; b < buffers.size(); b++) {
+        const TraceBuffer& buffer = *buffers[b];
+        if (buffer.thread_name != NULL) {
+            fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",", pid, buffer.tid, buffer.thread_name);
+            first = false;
+        }
+        traceSnapshot(buffer, events);
+        for (size_t i = 0; i < events.size(); i++) {
+            const TraceEvent& e = events[i];
+            // 时间单位为微秒, 相对首次开启跟踪的时间
+            fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"pipeline\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"pid\":%d,\"tid\":%d,\"args\":{\"frame\":%lld}}",
+                    first ? "" : ",", e.name, (e.begin_ns - epoch) / 1e3, (e.end_ns - e.begin_ns) / 1e3,
+                    pid, buffer.tid, (long long)e.frame);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+static void traceSignalHandler(int)
+{
+    g_trace_signaled = 1;
+}
+
+void traceDumpOnSignal(int sig, const std::string& path)
+{
+    g_trace_signal_path = path;
+    signal(sig, traceSignalHandler);
+}
+
+static void traceExitHandler()
+{
+    traceDump(g_trace_exit_path);
+}
+
+void traceDumpAtExit(const std::string& path)
+{
+    bool registered = !g_trace_exit_path.empty();
+    g_trace_exit_path = path;
+    if (!registered) {
+        atexit(traceExitHandler);
+    }
+}
+
+void tracePoll()
+{
+    if (g_trace_signaled) {
+        g_trace_signaled = 0;
+        if (traceDump(g_trace_signal_path)) {
+            std::cout << "跟踪已导出: " << g_trace_signal_path << std::endl;
+        }
+    }
+}